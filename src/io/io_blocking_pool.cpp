@@ -0,0 +1,74 @@
+#include "io_blocking_pool.h"
+#include "io_operation.h"
+#include "../util/platform.h"
+
+#include <algorithm>
+#include <string>
+
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+	#include <pthread.h>
+#endif
+
+namespace bop::io {
+	BlockingIoPool::BlockingIoPool(uint32_t num_threads) {
+		for (uint32_t i = 0; i < std::max(num_threads, 1u); ++i)
+			m_Threads.emplace_back(&BlockingIoPool::run, this, i);
+	}
+
+	BlockingIoPool::~BlockingIoPool() {
+		{
+			std::scoped_lock guard(m_Lock);
+			m_Stop = true;
+		}
+
+		m_Available.notify_all();
+
+		for (auto& t : m_Threads)
+			t.join();
+	}
+
+	void BlockingIoPool::submit(IoOperation& op) noexcept {
+		op.m_Next = nullptr;
+
+		{
+			std::scoped_lock guard(m_Lock);
+
+			if (m_Tail)
+				m_Tail->m_Next = &op;
+			else
+				m_Head = &op;
+
+			m_Tail = &op;
+		}
+
+		m_Available.notify_one();
+	}
+
+	void BlockingIoPool::run(uint32_t thread_index) noexcept {
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+		std::string name = "bop io " + std::to_string(thread_index);
+		pthread_setname_np(pthread_self(), name.c_str());
+#endif
+
+		while (true) {
+			IoOperation* op = nullptr;
+
+			{
+				std::unique_lock guard(m_Lock);
+
+				m_Available.wait(guard, [this] { return m_Stop || m_Head; });
+
+				if (m_Stop)
+					return;
+
+				op     = m_Head;
+				m_Head = op->m_Next;
+
+				if (!m_Head)
+					m_Tail = nullptr;
+			}
+
+			op->complete(op->execute_blocking());
+		}
+	}
+}
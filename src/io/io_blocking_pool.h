@@ -0,0 +1,36 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bop::io {
+	class IoOperation;
+
+	// the fallback when io_uring is not available: a few threads that perform the operations with
+	// regular blocking calls, and resume the coroutines on the pool themselves
+	class BlockingIoPool {
+	public:
+		explicit BlockingIoPool(uint32_t num_threads);
+		~BlockingIoPool(); // operations that haven't started yet are abandoned
+
+		BlockingIoPool             (const BlockingIoPool&) = delete;
+		BlockingIoPool& operator = (const BlockingIoPool&) = delete;
+		BlockingIoPool             (BlockingIoPool&&)      = delete;
+		BlockingIoPool& operator = (BlockingIoPool&&)      = delete;
+
+		void submit(IoOperation& op) noexcept;
+
+	private:
+		void run(uint32_t thread_index) noexcept;
+
+		std::mutex               m_Lock;
+		std::condition_variable  m_Available;
+		IoOperation*             m_Head = nullptr; // (FIFO, linked via m_Next)
+		IoOperation*             m_Tail = nullptr;
+		bool                     m_Stop = false;
+		std::vector<std::thread> m_Threads;
+	};
+}
@@ -0,0 +1,101 @@
+#include "io_buffer_pool.h"
+
+#include <new>
+#include <utility>
+
+namespace bop::io {
+	/***** RegisteredBuffer *****/
+	RegisteredBuffer::RegisteredBuffer(BufferPool& pool, uint32_t index) noexcept:
+		m_Pool (&pool),
+		m_Index(index)
+	{
+	}
+
+	RegisteredBuffer::~RegisteredBuffer() {
+		if (m_Pool)
+			m_Pool->release(m_Index);
+	}
+
+	RegisteredBuffer::RegisteredBuffer(RegisteredBuffer&& buffer) noexcept:
+		m_Pool (std::exchange(buffer.m_Pool, nullptr)),
+		m_Index(buffer.m_Index)
+	{
+	}
+
+	RegisteredBuffer& RegisteredBuffer::operator = (RegisteredBuffer&& buffer) noexcept {
+		if (this != &buffer) {
+			if (m_Pool)
+				m_Pool->release(m_Index);
+
+			m_Pool  = std::exchange(buffer.m_Pool, nullptr);
+			m_Index = buffer.m_Index;
+		}
+
+		return *this;
+	}
+
+	std::span<std::byte> RegisteredBuffer::data() const noexcept {
+		return m_Pool->get_buffer(m_Index);
+	}
+
+	uint32_t RegisteredBuffer::get_index() const noexcept {
+		return m_Index;
+	}
+
+	/***** BufferPool *****/
+	BufferPool::BufferPool(uint32_t num_buffers, size_t buffer_size):
+		m_NumBuffers(num_buffers),
+		m_BufferSize((buffer_size + k_Alignment - 1) / k_Alignment * k_Alignment),
+		m_Free      (num_buffers)
+	{
+		m_Data = static_cast<std::byte*>(::operator new(m_NumBuffers * m_BufferSize, std::align_val_t(k_Alignment)));
+
+		for (uint32_t i = 0; i < m_NumBuffers; ++i)
+			m_Free.try_push(i);
+	}
+
+	BufferPool::~BufferPool() {
+		::operator delete(m_Data, std::align_val_t(k_Alignment));
+	}
+
+	std::optional<RegisteredBuffer> BufferPool::acquire() noexcept {
+		uint32_t index = 0;
+
+		if (!m_Free.try_pop(index))
+			return std::nullopt;
+
+		return RegisteredBuffer(*this, index);
+	}
+
+	std::optional<uint32_t> BufferPool::find(const void* data, size_t length) const noexcept {
+		auto* first = static_cast<const std::byte*>(data);
+
+		if ((first < m_Data) || (first >= m_Data + m_NumBuffers * m_BufferSize))
+			return std::nullopt;
+
+		size_t offset = static_cast<size_t>(first - m_Data);
+		size_t index  = offset / m_BufferSize;
+
+		// (a range that spans two buffers can't be transferred as a single registered one)
+		if (offset + length > (index + 1) * m_BufferSize)
+			return std::nullopt;
+
+		return static_cast<uint32_t>(index);
+	}
+
+	std::span<std::byte> BufferPool::get_buffer(uint32_t index) const noexcept {
+		return { m_Data + index * m_BufferSize, m_BufferSize };
+	}
+
+	uint32_t BufferPool::get_num_buffers() const noexcept {
+		return m_NumBuffers;
+	}
+
+	size_t BufferPool::get_buffer_size() const noexcept {
+		return m_BufferSize;
+	}
+
+	void BufferPool::release(uint32_t index) noexcept {
+		m_Free.try_push(index); // (there's always room for all of them)
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include "../util/mpmc_ring.h"
+
+namespace bop::io {
+	class BufferPool;
+
+	// exclusive use of one of the buffers of a pool, which goes back to the pool when this is destroyed
+	class RegisteredBuffer {
+	public:
+		RegisteredBuffer(BufferPool& pool, uint32_t index) noexcept;
+		~RegisteredBuffer();
+
+		RegisteredBuffer             (const RegisteredBuffer&) = delete;
+		RegisteredBuffer& operator = (const RegisteredBuffer&) = delete;
+		RegisteredBuffer             (RegisteredBuffer&& buffer) noexcept;
+		RegisteredBuffer& operator = (RegisteredBuffer&& buffer) noexcept;
+
+		std::span<std::byte> data() const noexcept; // any part of this may be used for a transfer
+		uint32_t             get_index() const noexcept;
+
+	private:
+		BufferPool* m_Pool;
+		uint32_t    m_Index;
+	};
+
+	// a fixed set of equally sized, page-aligned buffers in a single allocation
+	//
+	// IoContext registers them with the kernel, which then keeps them mapped; transfers from and into
+	// them skip mapping the user pages for every single operation.
+	class BufferPool {
+	public:
+		static constexpr size_t k_Alignment = 4096; // (a page, which also suits O_DIRECT)
+
+		BufferPool(uint32_t num_buffers, size_t buffer_size); // the size is rounded up to the alignment
+		~BufferPool();
+
+		BufferPool             (const BufferPool&) = delete;
+		BufferPool& operator = (const BufferPool&) = delete;
+		BufferPool             (BufferPool&&)      = delete;
+		BufferPool& operator = (BufferPool&&)      = delete;
+
+		std::optional<RegisteredBuffer> acquire() noexcept; // nullopt while all of them are in use
+
+		// the buffer that holds all of the given range, if any
+		std::optional<uint32_t> find(const void* data, size_t length) const noexcept;
+
+		std::span<std::byte> get_buffer(uint32_t index) const noexcept;
+		uint32_t             get_num_buffers()          const noexcept;
+		size_t               get_buffer_size()          const noexcept;
+
+	private:
+		friend class RegisteredBuffer;
+
+		void release(uint32_t index) noexcept;
+
+		std::byte*               m_Data;
+		uint32_t                 m_NumBuffers;
+		size_t                   m_BufferSize;
+		util::MpmcRing<uint32_t> m_Free;       // indices of the buffers that are available
+	};
+}
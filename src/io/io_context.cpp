@@ -0,0 +1,164 @@
+#include "io_context.h"
+#include "../job/job_system.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace bop::io {
+	IoContext::IoContext(job::JobSystem& pool, e_Backend backend):
+		m_System(pool)
+	{
+		if (backend != e_Backend::blocking)
+			m_Ring = IoRing::create(k_QueueDepth);
+
+		if (!m_Ring) {
+			if (backend == e_Backend::io_uring)
+				throw std::runtime_error("io_uring is not available");
+
+			m_Blocking = std::make_unique<BlockingIoPool>(k_NumBlockingThreads);
+		}
+	}
+
+	IoContext::~IoContext() {
+		// (the blocking threads and the ring go first, the buffers may still be in use until then)
+		m_Blocking.reset();
+		m_Ring.reset();
+	}
+
+	IoContext& IoContext::get(job::JobSystem& pool, e_Backend backend) {
+		return pool.get_poller<IoContext>(backend);
+	}
+
+	IoContext& IoContext::get() {
+		return job::JobSystem::get_current().get_poller<IoContext>();
+	}
+
+	TransferAwaiter IoContext::read(int fd, std::span<std::byte> buffer, uint64_t offset) noexcept {
+		return TransferAwaiter(*this, e_Operation::read, fd, buffer.data(), buffer.size(), offset);
+	}
+
+	TransferAwaiter IoContext::write(int fd, std::span<const std::byte> buffer, uint64_t offset) noexcept {
+		// (the buffer is only ever read from)
+		return TransferAwaiter(*this, e_Operation::write, fd, const_cast<std::byte*>(buffer.data()), buffer.size(), offset);
+	}
+
+	SyncAwaiter IoContext::fsync(int fd, bool data_only) noexcept {
+		return SyncAwaiter(*this, fd, data_only);
+	}
+
+	bool IoContext::register_buffers(uint32_t num_buffers, size_t buffer_size) {
+		std::scoped_lock guard(m_BufferLock);
+
+		if (m_BufferStorage)
+			throw std::logic_error("Buffers were registered already");
+
+		m_BufferStorage = std::make_unique<BufferPool>(num_buffers, buffer_size);
+
+		if (m_Ring) {
+			std::vector<IoRing::Buffer> buffers;
+
+			for (uint32_t i = 0; i < num_buffers; ++i) {
+				auto buffer = m_BufferStorage->get_buffer(i);
+				buffers.push_back({ buffer.data(), buffer.size() });
+			}
+
+			m_Registered = m_Ring->register_buffers(buffers);
+		}
+
+		m_Buffers.store(m_BufferStorage.get(), std::memory_order::release); // (publishes m_Registered as well)
+
+		return m_Registered;
+	}
+
+	std::optional<RegisteredBuffer> IoContext::acquire_buffer() noexcept {
+		if (BufferPool* buffers = m_Buffers.load(std::memory_order::acquire))
+			return buffers->acquire();
+
+		return std::nullopt;
+	}
+
+	e_Backend IoContext::get_backend() const noexcept {
+		return m_Ring ? e_Backend::io_uring : e_Backend::blocking;
+	}
+
+	uint32_t IoContext::get_num_pending() const noexcept {
+		return m_NumPending.load(std::memory_order::relaxed);
+	}
+
+	bool IoContext::poll() noexcept {
+		if (!m_Ring)
+			return false;
+
+		IoOperation* completed = m_Ring->reap();
+
+		if (!completed)
+			return false;
+
+		while (completed) {
+			IoOperation* next = completed->m_Next; // (gone once it completed)
+
+			m_NumPending.fetch_sub(1, std::memory_order::relaxed);
+			completed->complete(completed->m_Result);
+
+			completed = next;
+		}
+
+		return true;
+	}
+
+	bool IoContext::is_pending() const noexcept {
+		return m_Ring && (m_NumPending.load(std::memory_order::relaxed) > 0);
+	}
+
+	void IoContext::wait(std::optional<Timepoint> deadline) noexcept {
+		if (m_Ring)
+			m_Ring->wait(deadline);
+	}
+
+	void IoContext::interrupt() noexcept {
+		if (m_Ring)
+			m_Ring->wake();
+	}
+
+	void IoContext::submit(IoOperation& op) noexcept {
+		op.m_System = &m_System;
+
+		if (!m_Ring) {
+			m_Blocking->submit(op);
+			return;
+		}
+
+		std::optional<uint32_t> buffer_index;
+
+		if (op.m_Buffer) {
+			if (BufferPool* buffers = m_Buffers.load(std::memory_order::acquire); buffers && m_Registered)
+				buffer_index = buffers->find(op.m_Buffer, op.m_Length);
+		}
+
+		uint32_t previous = m_NumPending.fetch_add(1, std::memory_order::relaxed);
+
+		if (int result = m_Ring->submit(op, buffer_index); result < 0) {
+			m_NumPending.fetch_sub(1, std::memory_order::relaxed);
+			op.complete(result);
+			return;
+		}
+
+		// (a parked worker should start waiting for the completions)
+		if (previous == 0)
+			m_System.notify_poller_pending();
+	}
+}
+
+namespace bop::io {
+	TransferAwaiter read(int fd, std::span<std::byte> buffer, uint64_t offset) {
+		return IoContext::get().read(fd, buffer, offset);
+	}
+
+	TransferAwaiter write(int fd, std::span<const std::byte> buffer, uint64_t offset) {
+		return IoContext::get().write(fd, buffer, offset);
+	}
+
+	SyncAwaiter fsync(int fd, bool data_only) {
+		return IoContext::get().fsync(fd, data_only);
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+
+#include "io_blocking_pool.h"
+#include "io_buffer_pool.h"
+#include "io_operation.h"
+#include "io_ring.h"
+#include "../job/job_poller.h"
+
+namespace bop::job {
+	class JobSystem;
+}
+
+namespace bop::io {
+	enum class e_Backend {
+		automatic, // io_uring if the kernel provides it, otherwise the blocking fallback
+		io_uring,
+		blocking
+	};
+
+	// asynchronous file I/O for the coroutines of a pool
+	//
+	// With io_uring, operations are handed to the kernel and the completions are reaped by the workers
+	// of the pool (this is a Poller); while operations are in flight, one parked worker waits for
+	// completions instead of sleeping. Without io_uring, a few extra threads perform blocking calls.
+	// Either way the awaiting coroutine is resumed as a job on the pool. Each pool has a single context
+	// (see get), since only that one is polled by the workers.
+	//
+	// Transfers from and into the registered buffers (see acquire_buffer) skip mapping the memory for
+	// each operation, which matters for large numbers of transfers.
+	class IoContext final:
+		public job::Poller
+	{
+	public:
+		static constexpr uint32_t k_QueueDepth         = 256;
+		static constexpr uint32_t k_NumBlockingThreads = 4;
+
+		~IoContext() override; // operations in flight are abandoned
+
+		IoContext             (const IoContext&) = delete;
+		IoContext& operator = (const IoContext&) = delete;
+		IoContext             (IoContext&&)      = delete;
+		IoContext& operator = (IoContext&&)      = delete;
+
+		// the one owned by the pool, constructed with the backend on first use (see JobSystem::get_poller).
+		// Throws std::runtime_error if io_uring was asked for but is not available
+		static IoContext& get(job::JobSystem& pool, e_Backend backend = e_Backend::automatic);
+		static IoContext& get(); // (of the current pool)
+
+		// co_await the results
+		TransferAwaiter read (int fd, std::span<std::byte>       buffer, uint64_t offset) noexcept;
+		TransferAwaiter write(int fd, std::span<const std::byte> buffer, uint64_t offset) noexcept;
+		SyncAwaiter     fsync(int fd, bool data_only = false) noexcept;
+
+		// a single set of buffers per context; returns false if the kernel refused to register them,
+		// in which case they can still be used but transfers are regular ones.
+		// Throws std::logic_error when called a second time
+		bool register_buffers(uint32_t num_buffers, size_t buffer_size);
+
+		std::optional<RegisteredBuffer> acquire_buffer() noexcept; // nullopt while all of them are in use (or if there are none)
+
+		e_Backend get_backend()     const noexcept; // io_uring or blocking
+		uint32_t  get_num_pending() const noexcept; // operations that were handed to io_uring and weren't reaped yet
+
+		// (Poller)
+		bool poll()       noexcept override;
+		bool is_pending() const noexcept override;
+		void wait(std::optional<Timepoint> deadline) noexcept override;
+		void interrupt()  noexcept override;
+
+	private:
+		friend class IoAwaiter;
+		friend class job::JobSystem;
+
+		IoContext(job::JobSystem& pool, e_Backend backend = e_Backend::automatic);
+
+		void submit(IoOperation& op) noexcept;
+
+		job::JobSystem&                 m_System;
+		std::unique_ptr<BufferPool>     m_BufferStorage;
+		std::atomic<BufferPool*>        m_Buffers    = nullptr; // set once they're registered
+		bool                            m_Registered = false;   // (with the kernel)
+		std::mutex                      m_BufferLock;
+		std::unique_ptr<IoRing>         m_Ring;                 // either this one
+		std::unique_ptr<BlockingIoPool> m_Blocking;             // or this one is used
+		std::atomic<uint32_t>           m_NumPending = 0;
+	};
+}
+
+namespace bop::io {
+	// on the context of the current pool
+	TransferAwaiter read (int fd, std::span<std::byte>       buffer, uint64_t offset);
+	TransferAwaiter write(int fd, std::span<const std::byte> buffer, uint64_t offset);
+	SyncAwaiter     fsync(int fd, bool data_only = false);
+}
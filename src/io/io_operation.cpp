@@ -0,0 +1,97 @@
+#include "io_operation.h"
+#include "io_context.h"
+#include "../job/job_system.h"
+#include "../util/platform.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+	#include <unistd.h>
+#endif
+
+namespace bop::io {
+	/***** IoOperation *****/
+	IoOperation::IoOperation(
+		IoContext&  context,
+		e_Operation operation,
+		int         fd,
+		void*       buffer,
+		size_t      length,
+		uint64_t    offset
+	) noexcept:
+		m_Context  (context),
+		m_Operation(operation),
+		m_Fd       (fd),
+		m_Buffer   (buffer),
+		m_Length   (static_cast<uint32_t>(std::min<size_t>(length, UINT32_MAX))),
+		m_Offset   (offset)
+	{
+	}
+
+	void IoOperation::complete(int64_t result) noexcept {
+		m_Result = result;
+
+		// (the operation is part of the coroutine frame, so it must not be touched after this)
+		m_System->schedule(
+			[coroutine = m_Coroutine] { coroutine.resume(); },
+			nullptr,
+			std::nullopt,
+			m_Priority
+		);
+	}
+
+	int64_t IoOperation::execute_blocking() noexcept {
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+		int64_t result = 0;
+
+		do {
+			switch (m_Operation) {
+			case e_Operation::read:  result = ::pread (m_Fd, m_Buffer, m_Length, static_cast<off_t>(m_Offset)); break;
+			case e_Operation::write: result = ::pwrite(m_Fd, m_Buffer, m_Length, static_cast<off_t>(m_Offset)); break;
+			case e_Operation::fsync: result = m_DataOnly ? ::fdatasync(m_Fd) : ::fsync(m_Fd);                   break;
+			}
+		} while ((result < 0) && (errno == EINTR));
+
+		return (result < 0) ? -errno : result;
+#else
+		return -ENOSYS; // (file descriptors are a posix thing)
+#endif
+	}
+
+	/***** IoAwaiter *****/
+	bool IoAwaiter::await_ready() const noexcept {
+		return false;
+	}
+
+	void IoAwaiter::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		m_Coroutine = awaiter;
+		m_Priority  = job::JobSystem::get_current().current_priority();
+
+		m_Context.submit(*this);
+	}
+
+	void IoAwaiter::check() const {
+		if (m_Result < 0)
+			throw std::system_error(static_cast<int>(-m_Result), std::system_category());
+	}
+
+	/***** TransferAwaiter *****/
+	size_t TransferAwaiter::await_resume() const {
+		check();
+
+		return static_cast<size_t>(m_Result);
+	}
+
+	/***** SyncAwaiter *****/
+	SyncAwaiter::SyncAwaiter(IoContext& context, int fd, bool data_only) noexcept:
+		IoAwaiter(context, e_Operation::fsync, fd, nullptr, 0, 0)
+	{
+		m_DataOnly = data_only;
+	}
+
+	void SyncAwaiter::await_resume() const {
+		check();
+	}
+}
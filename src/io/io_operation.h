@@ -0,0 +1,93 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+#include "../job/job_priority.h"
+
+namespace bop::job {
+	class JobSystem;
+}
+
+namespace bop::io {
+	class IoContext;
+
+	enum class e_Operation {
+		read,
+		write,
+		fsync
+	};
+
+	// a single request to the kernel (or to the blocking fallback)
+	//
+	// The awaiters below are the operations themselves; they live in the coroutine frame, so starting an
+	// operation never allocates. Once it completed the coroutine is resumed as a job on the pool of the
+	// context, at the priority it had when it started waiting.
+	class IoOperation {
+	public:
+		IoOperation(
+			IoContext&  context,
+			e_Operation operation,
+			int         fd,
+			void*       buffer,
+			size_t      length,
+			uint64_t    offset
+		) noexcept;
+
+		IoOperation             (const IoOperation&) = delete;
+		IoOperation& operator = (const IoOperation&) = delete;
+		IoOperation             (IoOperation&&)      = delete;
+		IoOperation& operator = (IoOperation&&)      = delete;
+
+		void    complete(int64_t result) noexcept; // stores the result and resumes the coroutine
+		int64_t execute_blocking()       noexcept; // performs the operation right here, returns the result
+
+		IoContext&              m_Context;
+		e_Operation             m_Operation;
+		int                     m_Fd;
+		void*                   m_Buffer;
+		uint32_t                m_Length;           // (larger transfers are cut short, like a regular read would)
+		uint64_t                m_Offset;
+		bool                    m_DataOnly  = false; // fsync without the metadata
+		int64_t                 m_Result    = 0;     // bytes transferred, or a negated errno
+		IoOperation*            m_Next      = nullptr;
+		std::coroutine_handle<> m_Coroutine = nullptr;
+		job::JobSystem*         m_System    = nullptr;
+		job::e_Priority         m_Priority  = job::e_Priority::normal;
+
+	protected:
+		~IoOperation() = default;
+	};
+
+	class IoAwaiter:
+		public IoOperation
+	{
+	public:
+		using IoOperation::IoOperation;
+
+		bool await_ready() const noexcept;
+		void await_suspend(std::coroutine_handle<> awaiter) noexcept;
+
+	protected:
+		void check() const; // throws std::system_error if the operation failed
+	};
+
+	class [[nodiscard]] TransferAwaiter final:
+		public IoAwaiter
+	{
+	public:
+		using IoAwaiter::IoAwaiter;
+
+		size_t await_resume() const; // the number of bytes transferred (may be less than requested, zero at the end of a file)
+	};
+
+	class [[nodiscard]] SyncAwaiter final:
+		public IoAwaiter
+	{
+	public:
+		SyncAwaiter(IoContext& context, int fd, bool data_only) noexcept;
+
+		void await_resume() const;
+	};
+}
@@ -0,0 +1,269 @@
+#include "io_reactor.h"
+#include "../job/job_system.h"
+#include "../util/platform.h"
+
+#include <cassert>
+#include <cerrno>
+#include <mutex>
+#include <system_error>
+
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <sys/epoll.h>
+	#include <sys/eventfd.h>
+	#include <unistd.h>
+#endif
+
+namespace bop::io {
+	/***** ReadinessAwaiter *****/
+	ReadinessAwaiter::ReadinessAwaiter(Pollable& pollable, e_Readiness readiness) noexcept:
+		m_Pollable (pollable),
+		m_Readiness(readiness)
+	{
+	}
+
+	bool ReadinessAwaiter::await_ready() const noexcept {
+		auto& state = m_Pollable.get_state(m_Readiness);
+
+		// (consumes the edge)
+		if (state.load(std::memory_order::relaxed) != Pollable::k_Notified)
+			return false;
+
+		uintptr_t notified = Pollable::k_Notified;
+
+		return state.compare_exchange_strong(notified, Pollable::k_Idle, std::memory_order::acquire);
+	}
+
+	bool ReadinessAwaiter::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		m_Coroutine = awaiter;
+		m_Priority  = job::JobSystem::get_current().current_priority();
+
+		Reactor& reactor = m_Pollable.m_Reactor;
+		auto&    state   = m_Pollable.get_state(m_Readiness);
+
+		// counted first, so whoever sees the waiter also sees that there's something to poll for
+		reactor.add_waiter();
+
+		uintptr_t idle = Pollable::k_Idle;
+
+		if (state.compare_exchange_strong(idle, reinterpret_cast<uintptr_t>(this), std::memory_order::acq_rel))
+			return true; // (the event may resume us on another worker right away, nothing may touch this after)
+
+		// an edge came in meanwhile, so keep going
+		assert((idle == Pollable::k_Notified) && "only a single coroutine may wait for each kind of readiness");
+
+		state.store(Pollable::k_Idle, std::memory_order::relaxed);
+		reactor.remove_waiter();
+
+		return false;
+	}
+
+	void ReadinessAwaiter::await_resume() const noexcept {
+	}
+
+	/***** Pollable *****/
+	Pollable::Pollable(int fd):
+		Pollable(Reactor::get(), fd)
+	{
+	}
+
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+	Pollable::Pollable(Reactor& reactor, int fd):
+		m_Reactor(reactor),
+		m_Fd     (fd)
+	{
+		int flags = fcntl(fd, F_GETFL);
+
+		if ((flags < 0) || (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0))
+			throw std::system_error(errno, std::system_category(), "fcntl");
+
+		// registered once for both directions, edge triggered; the events only ever move the state along
+		epoll_event ev = {};
+
+		ev.events   = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+		ev.data.ptr = this;
+
+		if (epoll_ctl(reactor.m_Epoll, EPOLL_CTL_ADD, fd, &ev) < 0)
+			throw std::system_error(errno, std::system_category(), "epoll_ctl");
+	}
+
+	Pollable::~Pollable() {
+		epoll_ctl(m_Reactor.m_Epoll, EPOLL_CTL_DEL, m_Fd, nullptr);
+
+		// events for this that were picked up just before are handled under this lock, wait for those
+		std::scoped_lock guard(m_Reactor.m_PollLock);
+	}
+#else
+	Pollable::Pollable(Reactor& reactor, int fd):
+		m_Reactor(reactor),
+		m_Fd     (fd)
+	{
+		throw std::system_error(ENOSYS, std::system_category(), "epoll");
+	}
+
+	Pollable::~Pollable() {
+	}
+#endif
+
+	ReadinessAwaiter Pollable::readable() noexcept {
+		return ReadinessAwaiter(*this, e_Readiness::readable);
+	}
+
+	ReadinessAwaiter Pollable::writable() noexcept {
+		return ReadinessAwaiter(*this, e_Readiness::writable);
+	}
+
+	int Pollable::get_fd() const noexcept {
+		return m_Fd;
+	}
+
+	std::atomic<uintptr_t>& Pollable::get_state(e_Readiness readiness) noexcept {
+		return (readiness == e_Readiness::readable) ? m_Reader : m_Writer;
+	}
+
+	void Pollable::notify(e_Readiness readiness) noexcept {
+		uintptr_t previous = get_state(readiness).exchange(k_Notified, std::memory_order::acq_rel);
+
+		if ((previous == k_Idle) || (previous == k_Notified))
+			return;
+
+		// the waiter takes the edge along
+		get_state(readiness).store(k_Idle, std::memory_order::relaxed);
+
+		auto* awaiter = reinterpret_cast<ReadinessAwaiter*>(previous);
+
+		m_Reactor.remove_waiter();
+
+		// (lands on the queue of the calling worker; the awaiter is gone once the coroutine resumed)
+		m_Reactor.m_System.schedule(
+			[coroutine = awaiter->m_Coroutine] { coroutine.resume(); },
+			nullptr,
+			std::nullopt,
+			awaiter->m_Priority
+		);
+	}
+
+	/***** Reactor *****/
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+	Reactor::Reactor(job::JobSystem& pool):
+		m_System(pool)
+	{
+		m_Epoll = epoll_create1(EPOLL_CLOEXEC);
+
+		if (m_Epoll < 0)
+			throw std::system_error(errno, std::system_category(), "epoll_create1");
+
+		m_EventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+		if (m_EventFd < 0) {
+			int error = errno;
+			close(m_Epoll);
+			throw std::system_error(error, std::system_category(), "eventfd");
+		}
+	}
+
+	Reactor::~Reactor() {
+		close(m_EventFd);
+		close(m_Epoll);
+	}
+
+	bool Reactor::poll() noexcept {
+		// (cheap check first, this is called a lot)
+		if (!is_pending())
+			return false;
+
+		if (!m_PollLock.try_lock())
+			return false;
+
+		std::scoped_lock guard(std::adopt_lock, m_PollLock);
+
+		epoll_event events[k_MaxEvents];
+
+		int count = epoll_wait(m_Epoll, events, k_MaxEvents, 0);
+
+		for (int i = 0; i < count; ++i) {
+			auto*    pollable = static_cast<Pollable*>(events[i].data.ptr);
+			uint32_t flags    = events[i].events;
+
+			// (errors and hangups wake up both sides, the next attempt reports them)
+			if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+				pollable->notify(e_Readiness::readable);
+
+			if (flags & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+				pollable->notify(e_Readiness::writable);
+		}
+
+		return count > 0;
+	}
+
+	void Reactor::wait(std::optional<Timepoint> deadline) noexcept {
+		// the epoll descriptor itself becomes readable when there are events, which are left for poll()
+		pollfd requests[2] = {
+			{ m_Epoll,   POLLIN, 0 },
+			{ m_EventFd, POLLIN, 0 }
+		};
+
+		if (deadline) {
+			auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(*deadline - Clock::now());
+
+			if (remaining.count() > 0) {
+				timespec timeout;
+
+				timeout.tv_sec  = static_cast<time_t>(remaining.count() / 1'000'000'000);
+				timeout.tv_nsec = static_cast<long>  (remaining.count() % 1'000'000'000);
+
+				ppoll(requests, 2, &timeout, nullptr);
+			}
+		}
+		else
+			ppoll(requests, 2, nullptr, nullptr);
+
+		if (requests[1].revents & POLLIN) {
+			uint64_t count = 0;
+			[[maybe_unused]] auto unused = read(m_EventFd, &count, sizeof(count));
+		}
+	}
+
+	void Reactor::interrupt() noexcept {
+		uint64_t one = 1;
+		[[maybe_unused]] auto unused = write(m_EventFd, &one, sizeof(one));
+	}
+#else
+	// (epoll is linux only)
+	Reactor::Reactor(job::JobSystem& pool):
+		m_System(pool)
+	{
+		throw std::system_error(ENOSYS, std::system_category(), "epoll");
+	}
+
+	Reactor::~Reactor() {
+	}
+
+	bool Reactor::poll() noexcept                             { return false; }
+	void Reactor::wait(std::optional<Timepoint>) noexcept    {}
+	void Reactor::interrupt() noexcept                        {}
+#endif
+
+	Reactor& Reactor::get() {
+		return job::JobSystem::get_current().get_poller<Reactor>();
+	}
+
+	uint32_t Reactor::get_num_waiting() const noexcept {
+		return m_NumWaiting.load(std::memory_order::relaxed);
+	}
+
+	bool Reactor::is_pending() const noexcept {
+		return m_NumWaiting.load(std::memory_order::acquire) > 0;
+	}
+
+	void Reactor::add_waiter() noexcept {
+		// (a parked worker should start waiting for events)
+		if (m_NumWaiting.fetch_add(1, std::memory_order::seq_cst) == 0)
+			m_System.notify_poller_pending();
+	}
+
+	void Reactor::remove_waiter() noexcept {
+		m_NumWaiting.fetch_sub(1, std::memory_order::relaxed);
+	}
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <optional>
+
+#include "../job/job_poller.h"
+#include "../job/job_priority.h"
+#include "../util/spinlock.h"
+
+namespace bop::job {
+	class JobSystem;
+}
+
+namespace bop::io {
+	class Pollable;
+	class Reactor;
+
+	enum class e_Readiness {
+		readable,
+		writable
+	};
+
+	// suspends the awaiting coroutine until the descriptor (probably) is ready
+	//
+	// Readiness is edge triggered: the awaiter returns right away if there was an edge since the last
+	// time, even if the descriptor was drained since. Try the operation first, and await when it
+	// fails with EAGAIN. There can be one reader and one writer awaiting a descriptor at a time.
+	class [[nodiscard]] ReadinessAwaiter {
+	public:
+		ReadinessAwaiter(Pollable& pollable, e_Readiness readiness) noexcept;
+
+		ReadinessAwaiter             (const ReadinessAwaiter&) = delete;
+		ReadinessAwaiter& operator = (const ReadinessAwaiter&) = delete;
+		ReadinessAwaiter             (ReadinessAwaiter&&)      = delete;
+		ReadinessAwaiter& operator = (ReadinessAwaiter&&)      = delete;
+
+		bool await_ready() const noexcept;
+		bool await_suspend(std::coroutine_handle<> awaiter) noexcept;
+		void await_resume() const noexcept;
+
+	private:
+		friend class Pollable;
+
+		Pollable&               m_Pollable;
+		e_Readiness             m_Readiness;
+		std::coroutine_handle<> m_Coroutine = nullptr;
+		job::e_Priority         m_Priority  = job::e_Priority::normal;
+	};
+
+	// a descriptor that is registered with the reactor (sockets, pipes, eventfds and the like, but not
+	// regular files; see IoContext for those)
+	//
+	// The descriptor is switched to non-blocking mode and stays registered for as long as this
+	// exists; it's not closed by this. Nothing may be awaiting it when this is destroyed.
+	class Pollable {
+	public:
+		explicit Pollable(int fd);                   // with the reactor of the current pool
+		Pollable(Reactor& reactor, int fd);          // throws std::system_error if the descriptor can't be registered
+		~Pollable();
+
+		Pollable             (const Pollable&) = delete;
+		Pollable& operator = (const Pollable&) = delete;
+		Pollable             (Pollable&&)      = delete;
+		Pollable& operator = (Pollable&&)      = delete;
+
+		ReadinessAwaiter readable() noexcept; // co_await the results
+		ReadinessAwaiter writable() noexcept;
+
+		int get_fd() const noexcept;
+
+	private:
+		friend class ReadinessAwaiter;
+		friend class Reactor;
+
+		static constexpr uintptr_t k_Idle     = 0;
+		static constexpr uintptr_t k_Notified = 1; // otherwise it's the ReadinessAwaiter that waits
+
+		std::atomic<uintptr_t>& get_state(e_Readiness readiness) noexcept;
+		void                    notify   (e_Readiness readiness) noexcept; // resumes the waiting coroutine, if any
+
+		Reactor&               m_Reactor;
+		int                    m_Fd;
+		std::atomic<uintptr_t> m_Reader = k_Idle;
+		std::atomic<uintptr_t> m_Writer = k_Idle;
+	};
+
+	// readiness notifications for the coroutines of a pool, through epoll (linux only)
+	//
+	// Workers poll for events in between jobs while a coroutine is waiting for one, and a parked worker
+	// blocks in epoll rather than sleeping (see job::Poller). Whoever picks up the event schedules the
+	// coroutine on its own queue, so it usually continues on that very worker without waking anyone.
+	class Reactor final:
+		public job::Poller
+	{
+	public:
+		static constexpr uint32_t k_MaxEvents = 64; // handled at a time
+
+		~Reactor() override; // coroutines that are still waiting are abandoned
+
+		Reactor             (const Reactor&) = delete;
+		Reactor& operator = (const Reactor&) = delete;
+		Reactor             (Reactor&&)      = delete;
+		Reactor& operator = (Reactor&&)      = delete;
+
+		// the one owned by the current pool, which is the only one that is polled (see JobSystem::get_poller).
+		// Throws std::system_error if epoll is not available
+		static Reactor& get();
+
+		uint32_t get_num_waiting() const noexcept; // coroutines that are suspended on a descriptor
+
+		// (Poller)
+		bool poll()       noexcept override;
+		bool is_pending() const noexcept override;
+		void wait(std::optional<Timepoint> deadline) noexcept override;
+		void interrupt()  noexcept override;
+
+	private:
+		friend class Pollable;
+		friend class ReadinessAwaiter;
+		friend class job::JobSystem;
+
+		explicit Reactor(job::JobSystem& pool);
+
+		void add_waiter()    noexcept;
+		void remove_waiter() noexcept;
+
+		job::JobSystem&       m_System;
+		int                   m_Epoll      = -1;
+		int                   m_EventFd    = -1; // interrupts a waiter (not part of the epoll set)
+		std::atomic<uint32_t> m_NumWaiting = 0;
+		util::Spinlock        m_PollLock;        // a single thread handles events at a time (see ~Pollable)
+	};
+}
@@ -0,0 +1,284 @@
+#include "io_ring.h"
+#include "io_operation.h"
+#include "../util/platform.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+	#include <linux/io_uring.h>
+	#include <poll.h>
+	#include <sys/eventfd.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <sys/uio.h>
+	#include <unistd.h>
+#endif
+
+namespace bop::io {
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+	namespace {
+		// the rings are shared with the kernel, which only knows them as plain integers
+		std::atomic_ref<uint32_t> shared(uint32_t* value) noexcept {
+			return std::atomic_ref<uint32_t>(*value);
+		}
+
+		timespec to_timespec(std::chrono::nanoseconds duration) noexcept {
+			timespec ts;
+
+			ts.tv_sec  = static_cast<time_t>(duration.count() / 1'000'000'000);
+			ts.tv_nsec = static_cast<long>  (duration.count() % 1'000'000'000);
+
+			return ts;
+		}
+	}
+
+	std::unique_ptr<IoRing> IoRing::create(uint32_t queue_depth) noexcept {
+		io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+
+		int fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth, &params));
+
+		if (fd < 0)
+			return nullptr; // (not supported by the kernel, or not allowed)
+
+		std::unique_ptr<IoRing> ring(new IoRing());
+
+		ring->m_Fd = fd; // (closed by the destructor from here on)
+
+		constexpr uint32_t k_RequiredFeatures = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP;
+
+		if ((params.features & k_RequiredFeatures) != k_RequiredFeatures)
+			return nullptr;
+
+		size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+		size_t cq_size = params.cq_off.cqes  + params.cq_entries * sizeof(io_uring_cqe);
+
+		ring->m_RingSize   = std::max(sq_size, cq_size);
+		ring->m_RingMemory = mmap(nullptr, ring->m_RingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+
+		if (ring->m_RingMemory == MAP_FAILED) {
+			ring->m_RingMemory = nullptr;
+			return nullptr;
+		}
+
+		ring->m_SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+		void* sqes = mmap(nullptr, ring->m_SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+		if (sqes == MAP_FAILED)
+			return nullptr;
+
+		ring->m_Sqes = static_cast<io_uring_sqe*>(sqes);
+
+		auto at = [base = static_cast<char*>(ring->m_RingMemory)](uint32_t offset) {
+			return reinterpret_cast<uint32_t*>(base + offset);
+		};
+
+		ring->m_SqHead    = at(params.sq_off.head);
+		ring->m_SqTail    = at(params.sq_off.tail);
+		ring->m_SqFlags   = at(params.sq_off.flags);
+		ring->m_SqArray   = at(params.sq_off.array);
+		ring->m_SqMask    = *at(params.sq_off.ring_mask);
+		ring->m_SqEntries = params.sq_entries;
+
+		ring->m_CqHead = at(params.cq_off.head);
+		ring->m_CqTail = at(params.cq_off.tail);
+		ring->m_Cqes   = reinterpret_cast<io_uring_cqe*>(at(params.cq_off.cqes));
+		ring->m_CqMask = *at(params.cq_off.ring_mask);
+
+		// completions are signalled through an eventfd, which doubles as the way to interrupt a waiter
+		ring->m_EventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+		if (ring->m_EventFd < 0)
+			return nullptr;
+
+		if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_EVENTFD, &ring->m_EventFd, 1) < 0)
+			return nullptr;
+
+		return ring;
+	}
+
+	IoRing::~IoRing() {
+		if (m_Sqes)
+			munmap(m_Sqes, m_SqesSize);
+
+		if (m_RingMemory)
+			munmap(m_RingMemory, m_RingSize);
+
+		if (m_EventFd >= 0)
+			close(m_EventFd);
+
+		if (m_Fd >= 0)
+			close(m_Fd); // (the kernel cancels whatever is still in flight)
+	}
+
+	int IoRing::submit(IoOperation& op, std::optional<uint32_t> buffer_index) noexcept {
+		std::scoped_lock guard(m_SubmitLock);
+
+		uint32_t tail = shared(m_SqTail).load(std::memory_order::relaxed); // (only written by us)
+		uint32_t head = shared(m_SqHead).load(std::memory_order::acquire);
+
+		// everything is handed over right away, so the queue only fills up when the kernel pushes back
+		while ((tail - head) >= m_SqEntries) {
+			if (int result = enter(tail - head, 0, 0); (result < 0) && (result != -EAGAIN) && (result != -EBUSY))
+				return result;
+
+			std::this_thread::yield();
+			head = shared(m_SqHead).load(std::memory_order::acquire);
+		}
+
+		io_uring_sqe& sqe = m_Sqes[tail & m_SqMask];
+		std::memset(&sqe, 0, sizeof(sqe));
+
+		sqe.fd        = op.m_Fd;
+		sqe.user_data = reinterpret_cast<uint64_t>(&op);
+
+		switch (op.m_Operation) {
+		case e_Operation::read:
+		case e_Operation::write: {
+			bool read = (op.m_Operation == e_Operation::read);
+
+			if (buffer_index) {
+				sqe.opcode    = read ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+				sqe.buf_index = static_cast<uint16_t>(*buffer_index);
+			}
+			else
+				sqe.opcode = read ? IORING_OP_READ : IORING_OP_WRITE;
+
+			sqe.addr = reinterpret_cast<uint64_t>(op.m_Buffer);
+			sqe.len  = op.m_Length;
+			sqe.off  = op.m_Offset;
+			break;
+		}
+
+		case e_Operation::fsync:
+			sqe.opcode      = IORING_OP_FSYNC;
+			sqe.fsync_flags = op.m_DataOnly ? IORING_FSYNC_DATASYNC : 0;
+			break;
+		}
+
+		m_SqArray[tail & m_SqMask] = tail & m_SqMask;
+		shared(m_SqTail).store(tail + 1, std::memory_order::release);
+
+		// (whatever is left over from an earlier attempt goes along)
+		uint32_t to_submit = tail + 1 - head;
+
+		while (true) {
+			int result = enter(to_submit, 0, 0);
+
+			if ((result >= 0) || ((result != -EINTR) && (result != -EAGAIN) && (result != -EBUSY)))
+				break;
+
+			std::this_thread::yield();
+		}
+
+		return 0;
+	}
+
+	IoOperation* IoRing::reap() noexcept {
+		// (cheap check first, this is called a lot)
+		if (
+			(shared(m_CqHead).load(std::memory_order::relaxed) == shared(m_CqTail).load(std::memory_order::acquire)) &&
+			!(shared(m_SqFlags).load(std::memory_order::relaxed) & IORING_SQ_CQ_OVERFLOW)
+		)
+			return nullptr;
+
+		if (!m_ReapLock.try_lock())
+			return nullptr;
+
+		std::scoped_lock guard(std::adopt_lock, m_ReapLock);
+
+		// completions that didn't fit are moved into the queue once there's room
+		if (shared(m_SqFlags).load(std::memory_order::relaxed) & IORING_SQ_CQ_OVERFLOW)
+			enter(0, 0, IORING_ENTER_GETEVENTS);
+
+		uint32_t head = shared(m_CqHead).load(std::memory_order::relaxed);
+		uint32_t tail = shared(m_CqTail).load(std::memory_order::acquire);
+
+		IoOperation*  completed = nullptr;
+		IoOperation** last      = &completed;
+
+		for (; head != tail; ++head) {
+			const io_uring_cqe& cqe = m_Cqes[head & m_CqMask];
+
+			auto* op = reinterpret_cast<IoOperation*>(cqe.user_data);
+
+			op->m_Result = cqe.res;
+			op->m_Next   = nullptr;
+
+			*last = op;
+			last  = &op->m_Next;
+		}
+
+		shared(m_CqHead).store(head, std::memory_order::release);
+
+		return completed;
+	}
+
+	void IoRing::wait(std::optional<Timepoint> deadline) noexcept {
+		pollfd request = { m_EventFd, POLLIN, 0 };
+
+		if (deadline) {
+			auto remaining = *deadline - Clock::now();
+
+			if (remaining > decltype(remaining)::zero()) {
+				timespec timeout = to_timespec(remaining);
+				ppoll(&request, 1, &timeout, nullptr);
+			}
+		}
+		else
+			ppoll(&request, 1, nullptr, nullptr);
+
+		// resets the counter; completions after this signal it again (the caller reaps the ones before)
+		uint64_t count = 0;
+		[[maybe_unused]] auto unused = read(m_EventFd, &count, sizeof(count));
+	}
+
+	void IoRing::wake() noexcept {
+		uint64_t one = 1;
+		[[maybe_unused]] auto unused = write(m_EventFd, &one, sizeof(one));
+	}
+
+	bool IoRing::register_buffers(std::span<const Buffer> buffers) noexcept {
+		std::vector<iovec> vectors;
+
+		for (const Buffer& buffer : buffers)
+			vectors.push_back({ buffer.m_Data, buffer.m_Size });
+
+		return syscall(
+			__NR_io_uring_register,
+			m_Fd,
+			IORING_REGISTER_BUFFERS,
+			vectors.data(),
+			static_cast<unsigned>(vectors.size())
+		) == 0;
+	}
+
+	int IoRing::enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags, const void* arg, size_t arg_size) noexcept {
+		long result = syscall(__NR_io_uring_enter, m_Fd, to_submit, min_complete, flags, arg, arg_size);
+
+		return (result < 0) ? -errno : static_cast<int>(result);
+	}
+#else
+	// (io_uring is linux only, everything goes through the blocking fallback elsewhere)
+	std::unique_ptr<IoRing> IoRing::create(uint32_t) noexcept {
+		return nullptr;
+	}
+
+	IoRing::~IoRing() {
+	}
+
+	int          IoRing::submit(IoOperation&, std::optional<uint32_t>) noexcept { return -ENOSYS; }
+	IoOperation* IoRing::reap() noexcept                                         { return nullptr; }
+	void         IoRing::wait(std::optional<Timepoint>) noexcept                 {}
+	void         IoRing::wake() noexcept                                         {}
+	bool         IoRing::register_buffers(std::span<const Buffer>) noexcept      { return false; }
+	int          IoRing::enter(uint32_t, uint32_t, uint32_t, const void*, size_t) noexcept { return -ENOSYS; }
+#endif
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+
+#include "../util/spinlock.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bop::io {
+	class IoOperation;
+
+	// a bare io_uring instance (linux only), driven through the raw system calls
+	//
+	// Submissions are serialized with a spinlock and handed to the kernel right away. The kernel signals
+	// an eventfd for every completion, which is what wait() blocks on; whoever reaps the completion
+	// queue needs no system call at all. Completions that don't fit in the queue are kept by the kernel
+	// (IORING_FEAT_NODROP) until there's room again.
+	class IoRing {
+	public:
+		using Clock     = std::chrono::steady_clock;
+		using Timepoint = Clock::time_point;
+
+		struct Buffer {
+			void*  m_Data;
+			size_t m_Size;
+		};
+
+		static std::unique_ptr<IoRing> create(uint32_t queue_depth) noexcept; // nullptr if io_uring is not available
+		~IoRing();
+
+		IoRing             (const IoRing&) = delete;
+		IoRing& operator = (const IoRing&) = delete;
+		IoRing             (IoRing&&)      = delete;
+		IoRing& operator = (IoRing&&)      = delete;
+
+		// returns a negated errno if the kernel refused the operation (it's not submitted then)
+		int submit(IoOperation& op, std::optional<uint32_t> buffer_index) noexcept;
+
+		IoOperation* reap() noexcept; // the completed operations with their results (linked via m_Next), nullptr if none or if another thread is reaping
+
+		void wait(std::optional<Timepoint> deadline) noexcept; // until something completed, the deadline passed or wake() was called
+		void wake() noexcept;
+
+		bool register_buffers(std::span<const Buffer> buffers) noexcept; // (once) false if the kernel refused
+
+	private:
+		IoRing() noexcept = default;
+
+		int enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags, const void* arg = nullptr, size_t arg_size = 0) noexcept;
+
+		int           m_Fd      = -1;
+		int           m_EventFd = -1;
+
+		void*         m_RingMemory = nullptr; // submission and completion queue share a single mapping
+		size_t        m_RingSize   = 0;
+		io_uring_sqe* m_Sqes       = nullptr;
+		size_t        m_SqesSize   = 0;
+
+		uint32_t*     m_SqHead    = nullptr;
+		uint32_t*     m_SqTail    = nullptr;
+		uint32_t*     m_SqFlags   = nullptr;
+		uint32_t*     m_SqArray   = nullptr;
+		uint32_t      m_SqMask    = 0;
+		uint32_t      m_SqEntries = 0;
+
+		uint32_t*     m_CqHead = nullptr;
+		uint32_t*     m_CqTail = nullptr;
+		io_uring_cqe* m_Cqes   = nullptr;
+		uint32_t      m_CqMask = 0;
+
+		util::Spinlock m_SubmitLock;
+		util::Spinlock m_ReapLock;
+	};
+}
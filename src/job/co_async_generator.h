@@ -0,0 +1,139 @@
+#pragma once
+
+#include <concepts>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <optional>
+
+#include "co_frame_allocator.h"
+
+namespace bop::job {
+	// generator whose producer runs on the job pool and may co_await (jobs, CoJobs, ...)
+	//
+	// The producer is started by the first begin() and then runs ahead of the consumer on pool workers,
+	// buffering up to a lookahead number of values before it suspends; each value the consumer takes
+	// lets it continue. Consumers are coroutines themselves and iterate like this:
+	//
+	//    for (auto it = co_await gen.begin(); it != gen.end(); co_await ++it)
+	//        use(*it);
+	//
+	// Exceptions thrown by the producer are rethrown to the consumer after the values yielded before
+	// them. If the generator is dropped while the producer is busy, the producer is destroyed as soon as
+	// it reaches its next co_yield (or completes).
+	template <std::movable T>
+	class AsyncGenerator {
+	public:
+		static constexpr uint32_t k_DefaultLookahead = 4;
+
+		enum class e_Producer {
+			idle,    // not started yet
+			running, // (or scheduled, or awaiting something else)
+			waiting, // for the consumer to make room in the buffer
+			done
+		};
+
+		struct promise_type final:
+			PooledFrame
+		{
+			// hands the value over to the consumer, suspends if the buffer is full
+			struct YieldAwaiter {
+				bool                    await_ready() const noexcept;
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept;
+				void                    await_resume() const noexcept;
+
+				T m_Value;
+			};
+
+			// marks the producer as done and wakes up the consumer
+			struct FinalAwaiter {
+				bool                    await_ready() const noexcept;
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept;
+				void                    await_resume() const noexcept;
+			};
+
+			AsyncGenerator get_return_object();
+
+			std::suspend_always initial_suspend() const noexcept;
+			FinalAwaiter        final_suspend()   const noexcept;
+			YieldAwaiter        yield_value(T value) noexcept(std::is_nothrow_move_constructible_v<T>);
+
+			void return_void() noexcept;
+			void unhandled_exception() noexcept;
+
+			// (a Spinlock is cacheline aligned, which coroutine frames don't guarantee)
+			std::mutex              m_Mutex;
+			std::deque<T>           m_Buffer;
+			uint32_t                m_Lookahead = k_DefaultLookahead;
+			e_Producer              m_State     = e_Producer::idle;
+			bool                    m_Abandoned = false;   // the generator was dropped while the producer was busy
+			std::coroutine_handle<> m_Consumer  = nullptr; // waiting for a value (if set)
+			std::exception_ptr      m_Exception;
+		};
+
+		using Handle = std::coroutine_handle<promise_type>;
+
+		class Iter;
+
+		// takes the next value from the buffer, suspending the consumer while there is none
+		class NextAwaiter {
+		public:
+			explicit NextAwaiter(AsyncGenerator* generator) noexcept;
+
+			bool await_ready() const noexcept;
+			bool await_suspend(std::coroutine_handle<> consumer) noexcept;
+			Iter await_resume();
+
+		private:
+			AsyncGenerator* m_Generator;
+		};
+
+		class Iter final {
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using difference_type   = std::ptrdiff_t;
+			using value_type        = T;
+			using reference         =       value_type&;
+			using pointer           =       value_type*;
+
+			explicit Iter(AsyncGenerator* generator) noexcept;
+
+			NextAwaiter operator++() noexcept; // (co_await the result)
+
+			pointer   operator ->() const noexcept;
+			reference operator * () const noexcept;
+
+			bool operator ==(std::default_sentinel_t) const noexcept;
+			bool operator !=(std::default_sentinel_t) const noexcept;
+
+		private:
+			AsyncGenerator* m_Generator; // non-owning
+		};
+
+		explicit AsyncGenerator(promise_type* pm) noexcept;
+
+		AsyncGenerator() noexcept = default;
+		~AsyncGenerator();
+
+		AsyncGenerator             (const AsyncGenerator&) = delete;
+		AsyncGenerator& operator = (const AsyncGenerator&) = delete;
+		AsyncGenerator             (AsyncGenerator&& ag) noexcept;
+		AsyncGenerator& operator = (AsyncGenerator&& ag) noexcept;
+
+		void set_lookahead(uint32_t num_values) noexcept; // (before iterating, at least 1)
+
+		NextAwaiter             begin() noexcept; // (co_await the result)
+		std::default_sentinel_t end()   const noexcept;
+
+	private:
+		void release() noexcept;
+
+		Handle           m_Coroutine = nullptr; // owning handle (unless abandoned)
+		std::optional<T> m_Current;             // the value the consumer is looking at
+	};
+}
+
+#include "co_async_generator.inl"
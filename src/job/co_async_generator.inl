@@ -0,0 +1,297 @@
+#pragma once
+
+#include "co_async_generator.h"
+#include "co_job.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace bop::job {
+	/***** promise_type::YieldAwaiter *****/
+	template <std::movable T>
+	bool AsyncGenerator<T>::promise_type::YieldAwaiter::await_ready() const noexcept {
+		return false;
+	}
+
+	template <std::movable T>
+	std::coroutine_handle<> AsyncGenerator<T>::promise_type::YieldAwaiter::await_suspend(
+		std::coroutine_handle<promise_type> self
+	) noexcept {
+		promise_type& pm = self.promise();
+
+		std::unique_lock guard(pm.m_Mutex);
+
+		if (pm.m_Abandoned) {
+			guard.unlock();
+			self.destroy(); // (this awaiter is part of the frame, so don't touch it afterwards)
+
+			return std::noop_coroutine();
+		}
+
+		pm.m_Buffer.push_back(std::move(m_Value));
+
+		// once unlocked, the consumer may resume (or destroy) the producer if it is waiting
+		std::coroutine_handle<> consumer = std::exchange(pm.m_Consumer, nullptr);
+		bool                    is_full  = (pm.m_Buffer.size() >= pm.m_Lookahead);
+
+		if (is_full)
+			pm.m_State = e_Producer::waiting;
+
+		guard.unlock();
+
+		if (is_full)
+			return consumer ? consumer : std::noop_coroutine();
+
+		// keep on producing, the consumer continues elsewhere
+		if (consumer)
+			schedule_coroutine(consumer);
+
+		return self;
+	}
+
+	template <std::movable T>
+	void AsyncGenerator<T>::promise_type::YieldAwaiter::await_resume() const noexcept {
+	}
+
+	/***** promise_type::FinalAwaiter *****/
+	template <std::movable T>
+	bool AsyncGenerator<T>::promise_type::FinalAwaiter::await_ready() const noexcept {
+		return false;
+	}
+
+	template <std::movable T>
+	std::coroutine_handle<> AsyncGenerator<T>::promise_type::FinalAwaiter::await_suspend(
+		std::coroutine_handle<promise_type> self
+	) noexcept {
+		promise_type& pm = self.promise();
+
+		std::unique_lock guard(pm.m_Mutex);
+
+		if (pm.m_Abandoned) {
+			guard.unlock();
+			self.destroy();
+
+			return std::noop_coroutine();
+		}
+
+		pm.m_State = e_Producer::done;
+
+		std::coroutine_handle<> consumer = std::exchange(pm.m_Consumer, nullptr);
+
+		guard.unlock();
+
+		return consumer ? consumer : std::noop_coroutine();
+	}
+
+	template <std::movable T>
+	void AsyncGenerator<T>::promise_type::FinalAwaiter::await_resume() const noexcept {
+	}
+
+	/***** promise_type *****/
+	template <std::movable T>
+	AsyncGenerator<T> AsyncGenerator<T>::promise_type::get_return_object() {
+		return AsyncGenerator(this);
+	}
+
+	template <std::movable T>
+	std::suspend_always AsyncGenerator<T>::promise_type::initial_suspend() const noexcept {
+		return {};
+	}
+
+	template <std::movable T>
+	typename AsyncGenerator<T>::promise_type::FinalAwaiter AsyncGenerator<T>::promise_type::final_suspend() const noexcept {
+		return {};
+	}
+
+	template <std::movable T>
+	typename AsyncGenerator<T>::promise_type::YieldAwaiter AsyncGenerator<T>::promise_type::yield_value(
+		T value
+	) noexcept(std::is_nothrow_move_constructible_v<T>) {
+		return { std::move(value) };
+	}
+
+	template <std::movable T>
+	void AsyncGenerator<T>::promise_type::return_void() noexcept {
+	}
+
+	template <std::movable T>
+	void AsyncGenerator<T>::promise_type::unhandled_exception() noexcept {
+		// (only read by the consumer after the producer is done)
+		m_Exception = std::current_exception();
+	}
+
+	/***** NextAwaiter *****/
+	template <std::movable T>
+	AsyncGenerator<T>::NextAwaiter::NextAwaiter(AsyncGenerator* generator) noexcept:
+		m_Generator(generator)
+	{
+	}
+
+	template <std::movable T>
+	bool AsyncGenerator<T>::NextAwaiter::await_ready() const noexcept {
+		return false;
+	}
+
+	template <std::movable T>
+	bool AsyncGenerator<T>::NextAwaiter::await_suspend(std::coroutine_handle<> consumer) noexcept {
+		Handle        producer = m_Generator->m_Coroutine;
+		promise_type& pm       = producer.promise();
+
+		std::unique_lock guard(pm.m_Mutex);
+
+		bool start = (pm.m_State == e_Producer::idle);
+
+		if (start)
+			pm.m_State = e_Producer::running;
+
+		bool is_ready =
+			!pm.m_Buffer.empty() ||
+			(pm.m_State == e_Producer::done);
+
+		if (!is_ready)
+			pm.m_Consumer = consumer;
+
+		guard.unlock();
+
+		if (start)
+			schedule_coroutine(producer);
+
+		return !is_ready;
+	}
+
+	template <std::movable T>
+	typename AsyncGenerator<T>::Iter AsyncGenerator<T>::NextAwaiter::await_resume() {
+		Handle        producer = m_Generator->m_Coroutine;
+		promise_type& pm       = producer.promise();
+
+		std::unique_lock guard(pm.m_Mutex);
+
+		// (there is either a value now, or the producer is done)
+		if (pm.m_Buffer.empty()) {
+			std::exception_ptr ex = std::exchange(pm.m_Exception, nullptr);
+
+			guard.unlock();
+
+			m_Generator->m_Current.reset();
+
+			if (ex)
+				std::rethrow_exception(ex);
+
+			return Iter(m_Generator);
+		}
+
+		m_Generator->m_Current.emplace(std::move(pm.m_Buffer.front()));
+		pm.m_Buffer.pop_front();
+
+		// made room for the producer
+		bool resume = (pm.m_State == e_Producer::waiting);
+
+		if (resume)
+			pm.m_State = e_Producer::running;
+
+		guard.unlock();
+
+		if (resume)
+			schedule_coroutine(producer);
+
+		return Iter(m_Generator);
+	}
+
+	/***** Iter *****/
+	template <std::movable T>
+	AsyncGenerator<T>::Iter::Iter(AsyncGenerator* generator) noexcept:
+		m_Generator(generator)
+	{
+	}
+
+	template <std::movable T>
+	typename AsyncGenerator<T>::NextAwaiter AsyncGenerator<T>::Iter::operator ++() noexcept {
+		return NextAwaiter(m_Generator);
+	}
+
+	template <std::movable T>
+	typename AsyncGenerator<T>::Iter::pointer AsyncGenerator<T>::Iter::operator ->() const noexcept {
+		return &*m_Generator->m_Current;
+	}
+
+	template <std::movable T>
+	typename AsyncGenerator<T>::Iter::reference AsyncGenerator<T>::Iter::operator *() const noexcept {
+		return *m_Generator->m_Current;
+	}
+
+	template <std::movable T>
+	bool AsyncGenerator<T>::Iter::operator ==(std::default_sentinel_t) const noexcept {
+		return !m_Generator->m_Current.has_value();
+	}
+
+	template <std::movable T>
+	bool AsyncGenerator<T>::Iter::operator !=(std::default_sentinel_t s) const noexcept {
+		return !(*this == s);
+	}
+
+	/***** AsyncGenerator *****/
+	template <std::movable T>
+	AsyncGenerator<T>::AsyncGenerator(promise_type* pm) noexcept:
+		m_Coroutine(Handle::from_promise(*pm))
+	{
+	}
+
+	template <std::movable T>
+	AsyncGenerator<T>::~AsyncGenerator() {
+		release();
+	}
+
+	template <std::movable T>
+	AsyncGenerator<T>::AsyncGenerator(AsyncGenerator&& ag) noexcept:
+		m_Coroutine(std::exchange(ag.m_Coroutine, nullptr)),
+		m_Current  (std::move(ag.m_Current))
+	{
+	}
+
+	template <std::movable T>
+	AsyncGenerator<T>& AsyncGenerator<T>::operator = (AsyncGenerator&& ag) noexcept {
+		if (this != &ag) {
+			release();
+
+			m_Coroutine = std::exchange(ag.m_Coroutine, nullptr);
+			m_Current   = std::move(ag.m_Current);
+		}
+
+		return *this;
+	}
+
+	template <std::movable T>
+	void AsyncGenerator<T>::set_lookahead(uint32_t num_values) noexcept {
+		m_Coroutine.promise().m_Lookahead = std::max(num_values, 1u);
+	}
+
+	template <std::movable T>
+	typename AsyncGenerator<T>::NextAwaiter AsyncGenerator<T>::begin() noexcept {
+		return NextAwaiter(this);
+	}
+
+	template <std::movable T>
+	std::default_sentinel_t AsyncGenerator<T>::end() const noexcept {
+		return {};
+	}
+
+	template <std::movable T>
+	void AsyncGenerator<T>::release() noexcept {
+		if (!m_Coroutine)
+			return;
+
+		Handle        producer = std::exchange(m_Coroutine, nullptr);
+		promise_type& pm       = producer.promise();
+
+		std::unique_lock guard(pm.m_Mutex);
+
+		// a running producer cleans up after itself
+		if (pm.m_State == e_Producer::running) {
+			pm.m_Abandoned = true;
+			return;
+		}
+
+		guard.unlock();
+		producer.destroy();
+	}
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstdint>
+#include <optional>
+
+#include "job_priority.h"
+#include "../util/mpmc_ring.h"
+#include "../util/spinlock.h"
+
+namespace bop::job {
+	class JobSystem;
+
+	// bounded multi-producer/multi-consumer queue for passing values between coroutines
+	//
+	// Values go through a lock-free ring; only when it is full (or empty) a sending (or receiving)
+	// coroutine is parked in a wait list, which is protected by a spinlock. Whoever makes room (or
+	// provides a value) next schedules a job on the pool that retries the operation for one parked
+	// coroutine, and resumes it once that succeeds. Workers are never blocked.
+	//
+	// close() ends the stream: sending fails from then on, receivers get the remaining values
+	// and then nullopt. Sends that race with close() may or may not be delivered.
+	// [NOTE] the channel must outlive the coroutines that are waiting on it
+	template <std::movable T>
+	class Channel {
+	private:
+		class Waiter {
+		public:
+			virtual void retry() noexcept = 0; // (runs as a job)
+
+			Waiter*                 m_Next      = nullptr;
+			std::coroutine_handle<> m_Coroutine = nullptr;
+			e_Priority              m_Priority  = e_Priority::normal;
+
+		protected:
+			~Waiter() = default;
+		};
+
+		// intrusive FIFO
+		struct WaitList {
+			void    push(Waiter* w) noexcept;
+			Waiter* pop()           noexcept; // nullptr if empty
+
+			Waiter* m_Head = nullptr;
+			Waiter* m_Tail = nullptr;
+		};
+
+	public:
+		class [[nodiscard]] SendAwaiter final:
+			public Waiter
+		{
+		public:
+			SendAwaiter(Channel* channel, T&& value);
+
+			SendAwaiter             (const SendAwaiter&) = delete;
+			SendAwaiter& operator = (const SendAwaiter&) = delete;
+			SendAwaiter             (SendAwaiter&&)      = delete;
+			SendAwaiter& operator = (SendAwaiter&&)      = delete;
+
+			bool await_ready() noexcept;
+			bool await_suspend(std::coroutine_handle<> awaiter) noexcept;
+			bool await_resume() const noexcept; // false if the channel was closed
+
+		private:
+			friend class Channel;
+
+			void retry() noexcept override;
+
+			Channel* m_Channel;
+			T        m_Value;
+			bool     m_Sent = false;
+		};
+
+		class [[nodiscard]] ReceiveAwaiter final:
+			public Waiter
+		{
+		public:
+			explicit ReceiveAwaiter(Channel* channel) noexcept;
+
+			ReceiveAwaiter             (const ReceiveAwaiter&) = delete;
+			ReceiveAwaiter& operator = (const ReceiveAwaiter&) = delete;
+			ReceiveAwaiter             (ReceiveAwaiter&&)      = delete;
+			ReceiveAwaiter& operator = (ReceiveAwaiter&&)      = delete;
+
+			bool             await_ready() noexcept;
+			bool             await_suspend(std::coroutine_handle<> awaiter) noexcept;
+			std::optional<T> await_resume(); // nullopt once the channel is closed and drained
+
+		private:
+			friend class Channel;
+
+			void retry() noexcept override;
+
+			Channel*         m_Channel;
+			std::optional<T> m_Result;
+		};
+
+		explicit Channel(uint32_t capacity); // (rounded up to a power of two) waiters are resumed on the current pool
+		Channel(uint32_t capacity, JobSystem& pool);
+
+		Channel             (const Channel&) = delete;
+		Channel& operator = (const Channel&) = delete;
+		Channel             (Channel&&)      = delete;
+		Channel& operator = (Channel&&)      = delete;
+
+		// for regular functions; these never wait
+		template <typename U>
+		bool             try_send(U&& value); // false if full or closed (value is left untouched)
+		std::optional<T> try_receive();       // nullopt if empty
+
+		// for coroutines; co_await the result
+		SendAwaiter    send(T value);
+		ReceiveAwaiter receive() noexcept;
+
+		void close() noexcept; // resumes all waiters
+		bool is_closed() const noexcept;
+
+	private:
+		// each returns true if the operation is done (successfully or because the channel was closed)
+		bool attempt(SendAwaiter& sender)      noexcept;
+		bool attempt(ReceiveAwaiter& receiver) noexcept;
+
+		// parks the waiter, unless the operation can be completed after all; returns false in that case
+		bool park(SendAwaiter& sender)      noexcept;
+		bool park(ReceiveAwaiter& receiver) noexcept;
+
+		void wake_one(WaitList& list, std::atomic<uint32_t>& num_waiting) noexcept;
+		void schedule_retry(Waiter* w) noexcept;
+
+		util::MpmcRing<T>     m_Ring;
+		JobSystem*            m_System;
+		util::Spinlock        m_Lock;         // protects the wait lists
+		WaitList              m_Senders;      // waiting for room
+		WaitList              m_Receivers;    // waiting for values
+		std::atomic<uint32_t> m_NumSenders   = 0; // (mirrors the list, but can be checked without locking)
+		std::atomic<uint32_t> m_NumReceivers = 0;
+		std::atomic<bool>     m_Closed       = false;
+	};
+}
+
+#include "co_channel.inl"
@@ -0,0 +1,297 @@
+#pragma once
+
+#include "co_channel.h"
+#include "job_system.h"
+
+#include <mutex>
+#include <utility>
+
+namespace bop::job {
+	/***** WaitList *****/
+	template <std::movable T>
+	void Channel<T>::WaitList::push(Waiter* w) noexcept {
+		w->m_Next = nullptr;
+
+		if (m_Tail)
+			m_Tail->m_Next = w;
+		else
+			m_Head = w;
+
+		m_Tail = w;
+	}
+
+	template <std::movable T>
+	typename Channel<T>::Waiter* Channel<T>::WaitList::pop() noexcept {
+		Waiter* w = m_Head;
+
+		if (w) {
+			m_Head = w->m_Next;
+
+			if (!m_Head)
+				m_Tail = nullptr;
+		}
+
+		return w;
+	}
+
+	/***** SendAwaiter *****/
+	template <std::movable T>
+	Channel<T>::SendAwaiter::SendAwaiter(Channel* channel, T&& value):
+		m_Channel(channel),
+		m_Value  (std::move(value))
+	{
+	}
+
+	template <std::movable T>
+	bool Channel<T>::SendAwaiter::await_ready() noexcept {
+		return m_Channel->attempt(*this);
+	}
+
+	template <std::movable T>
+	bool Channel<T>::SendAwaiter::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		this->m_Coroutine = awaiter;
+		this->m_Priority  = JobSystem::get_current().current_priority();
+
+		return m_Channel->park(*this);
+	}
+
+	template <std::movable T>
+	bool Channel<T>::SendAwaiter::await_resume() const noexcept {
+		return m_Sent;
+	}
+
+	template <std::movable T>
+	void Channel<T>::SendAwaiter::retry() noexcept {
+		// (another coroutine may have taken the room that was made, then just wait some more)
+		if (m_Channel->attempt(*this) || !m_Channel->park(*this))
+			this->m_Coroutine.resume();
+	}
+
+	/***** ReceiveAwaiter *****/
+	template <std::movable T>
+	Channel<T>::ReceiveAwaiter::ReceiveAwaiter(Channel* channel) noexcept:
+		m_Channel(channel)
+	{
+	}
+
+	template <std::movable T>
+	bool Channel<T>::ReceiveAwaiter::await_ready() noexcept {
+		return m_Channel->attempt(*this);
+	}
+
+	template <std::movable T>
+	bool Channel<T>::ReceiveAwaiter::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		this->m_Coroutine = awaiter;
+		this->m_Priority  = JobSystem::get_current().current_priority();
+
+		return m_Channel->park(*this);
+	}
+
+	template <std::movable T>
+	std::optional<T> Channel<T>::ReceiveAwaiter::await_resume() {
+		return std::move(m_Result);
+	}
+
+	template <std::movable T>
+	void Channel<T>::ReceiveAwaiter::retry() noexcept {
+		if (m_Channel->attempt(*this) || !m_Channel->park(*this))
+			this->m_Coroutine.resume();
+	}
+
+	/***** Channel *****/
+	template <std::movable T>
+	Channel<T>::Channel(uint32_t capacity):
+		Channel(capacity, JobSystem::get_current())
+	{
+	}
+
+	template <std::movable T>
+	Channel<T>::Channel(uint32_t capacity, JobSystem& pool):
+		m_Ring  (capacity),
+		m_System(&pool)
+	{
+	}
+
+	template <std::movable T>
+	template <typename U>
+	bool Channel<T>::try_send(U&& value) {
+		if (m_Closed.load(std::memory_order::acquire))
+			return false;
+
+		if (!m_Ring.try_push(std::forward<U>(value)))
+			return false;
+
+		wake_one(m_Receivers, m_NumReceivers);
+
+		return true;
+	}
+
+	template <std::movable T>
+	std::optional<T> Channel<T>::try_receive() {
+		std::optional<T> result;
+
+		if (m_Ring.try_pop_into(result))
+			wake_one(m_Senders, m_NumSenders);
+
+		return result;
+	}
+
+	template <std::movable T>
+	typename Channel<T>::SendAwaiter Channel<T>::send(T value) {
+		return SendAwaiter(this, std::move(value));
+	}
+
+	template <std::movable T>
+	typename Channel<T>::ReceiveAwaiter Channel<T>::receive() noexcept {
+		return ReceiveAwaiter(this);
+	}
+
+	template <std::movable T>
+	void Channel<T>::close() noexcept {
+		m_Closed.store(true, std::memory_order::seq_cst);
+
+		// anyone that parks after this sees the flag (it's checked under the same lock)
+		WaitList senders;
+		WaitList receivers;
+
+		{
+			std::scoped_lock guard(m_Lock);
+
+			senders   = std::exchange(m_Senders,   {});
+			receivers = std::exchange(m_Receivers, {});
+
+			m_NumSenders  .store(0, std::memory_order::relaxed);
+			m_NumReceivers.store(0, std::memory_order::relaxed);
+		}
+
+		while (Waiter* w = senders.pop())
+			schedule_retry(w);
+
+		while (Waiter* w = receivers.pop())
+			schedule_retry(w);
+	}
+
+	template <std::movable T>
+	bool Channel<T>::is_closed() const noexcept {
+		return m_Closed.load(std::memory_order::acquire);
+	}
+
+	template <std::movable T>
+	bool Channel<T>::attempt(SendAwaiter& sender) noexcept {
+		if (m_Closed.load(std::memory_order::acquire)) {
+			sender.m_Sent = false;
+			return true;
+		}
+
+		if (!m_Ring.try_push(std::move(sender.m_Value)))
+			return false;
+
+		sender.m_Sent = true;
+		wake_one(m_Receivers, m_NumReceivers);
+
+		return true;
+	}
+
+	template <std::movable T>
+	bool Channel<T>::attempt(ReceiveAwaiter& receiver) noexcept {
+		if (m_Ring.try_pop_into(receiver.m_Result)) {
+			wake_one(m_Senders, m_NumSenders);
+			return true;
+		}
+
+		if (!m_Closed.load(std::memory_order::acquire))
+			return false;
+
+		// (values sent before closing are still delivered)
+		m_Ring.try_pop_into(receiver.m_Result);
+
+		return true;
+	}
+
+	template <std::movable T>
+	bool Channel<T>::park(SendAwaiter& sender) noexcept {
+		{
+			std::scoped_lock guard(m_Lock);
+
+			if (m_Closed.load(std::memory_order::relaxed)) {
+				sender.m_Sent = false;
+				return false;
+			}
+
+			// announce first, then check once more; either this succeeds or a receiver will see the announcement
+			m_NumSenders.fetch_add(1, std::memory_order::seq_cst);
+			std::atomic_thread_fence(std::memory_order::seq_cst);
+
+			if (!m_Ring.try_push(std::move(sender.m_Value))) {
+				m_Senders.push(&sender);
+				return true;
+			}
+
+			m_NumSenders.fetch_sub(1, std::memory_order::relaxed);
+		}
+
+		sender.m_Sent = true;
+		wake_one(m_Receivers, m_NumReceivers);
+
+		return false;
+	}
+
+	template <std::movable T>
+	bool Channel<T>::park(ReceiveAwaiter& receiver) noexcept {
+		{
+			std::scoped_lock guard(m_Lock);
+
+			m_NumReceivers.fetch_add(1, std::memory_order::seq_cst);
+			std::atomic_thread_fence(std::memory_order::seq_cst);
+
+			if (!m_Ring.try_pop_into(receiver.m_Result)) {
+				if (m_Closed.load(std::memory_order::relaxed)) {
+					m_NumReceivers.fetch_sub(1, std::memory_order::relaxed);
+					return false;
+				}
+
+				m_Receivers.push(&receiver);
+				return true;
+			}
+
+			m_NumReceivers.fetch_sub(1, std::memory_order::relaxed);
+		}
+
+		wake_one(m_Senders, m_NumSenders);
+
+		return false;
+	}
+
+	template <std::movable T>
+	void Channel<T>::wake_one(WaitList& list, std::atomic<uint32_t>& num_waiting) noexcept {
+		// (pairs with the fence in park)
+		std::atomic_thread_fence(std::memory_order::seq_cst);
+
+		if (num_waiting.load(std::memory_order::relaxed) == 0)
+			return;
+
+		Waiter* w = nullptr;
+
+		{
+			std::scoped_lock guard(m_Lock);
+
+			w = list.pop();
+
+			if (w)
+				num_waiting.fetch_sub(1, std::memory_order::relaxed);
+		}
+
+		if (w)
+			schedule_retry(w);
+	}
+
+	template <std::movable T>
+	void Channel<T>::schedule_retry(Waiter* w) noexcept {
+		m_System->schedule(
+			[w] { w->retry(); },
+			nullptr,
+			std::nullopt,
+			w->m_Priority
+		);
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <concepts>
+#include <coroutine>
+#include <iterator>
+#include <span>
+#include <type_traits>
+
+#include "co_generator.h"
+
+namespace bop::job {
+	// generator that produces its values in batches, to amortize the cost of resuming per element
+	//
+	// The coroutine fills a buffer (typically provided by the caller) and yields a std::span over the
+	// part it filled; iterating the generator walks over the elements of each span in turn, only
+	// resuming the coroutine when a batch is exhausted. chunks() iterates the spans themselves.
+	// [NOTE] a span is only valid until the coroutine is resumed again, it usually reuses the buffer
+	//
+	// (see the iota/range overloads below for samples)
+	template <typename T>
+	class ChunkedGenerator {
+	public:
+		using Chunks       = Generator<std::span<T>>;
+		using promise_type = typename Chunks::promise_type;
+
+		ChunkedGenerator(Chunks&& chunks) noexcept; // (implicit, so it can be used as a coroutine return type)
+
+		ChunkedGenerator() noexcept = default;
+
+		class Iter final {
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using difference_type   = std::ptrdiff_t;
+			using value_type        = T;
+			using reference         = value_type&;
+			using pointer           = value_type*;
+
+			explicit Iter(typename Chunks::Iter chunk);
+
+			// only allow pre-increment
+			Iter& operator++(int) = delete;
+			Iter& operator++();
+
+			pointer   operator ->() const noexcept;
+			reference operator * () const noexcept;
+
+			bool operator ==(std::default_sentinel_t) const noexcept;
+
+		private:
+			void skip_empty(); // moves on to the next chunk that has any elements
+
+			typename Chunks::Iter m_Chunk;
+			T*                    m_Current = nullptr;
+			T*                    m_End     = nullptr;
+		};
+
+		Iter                    begin();
+		std::default_sentinel_t end() const noexcept;
+
+		Chunks& chunks() noexcept;
+
+	private:
+		Chunks m_Chunks;
+	};
+
+	// fill the buffer with increasing values; up_to is exclusive, the buffer should not be empty
+	template <std::integral I>
+	ChunkedGenerator<I> iota(I up_to, std::span<std::type_identity_t<I>> buffer);
+
+	template <std::integral I>
+	ChunkedGenerator<I> range(I first, I last, I step, std::span<std::type_identity_t<I>> buffer);
+}
+
+#include "co_chunked_generator.inl"
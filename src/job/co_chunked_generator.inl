@@ -0,0 +1,115 @@
+#pragma once
+
+#include "co_chunked_generator.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace bop::job {
+	/***** ChunkedGenerator *****/
+	template <typename T>
+	ChunkedGenerator<T>::ChunkedGenerator(Chunks&& chunks) noexcept:
+		m_Chunks(std::move(chunks))
+	{
+	}
+
+	template <typename T>
+	typename ChunkedGenerator<T>::Iter ChunkedGenerator<T>::begin() {
+		return Iter(m_Chunks.begin());
+	}
+
+	template <typename T>
+	std::default_sentinel_t ChunkedGenerator<T>::end() const noexcept {
+		return {};
+	}
+
+	template <typename T>
+	typename ChunkedGenerator<T>::Chunks& ChunkedGenerator<T>::chunks() noexcept {
+		return m_Chunks;
+	}
+
+	/***** Iter *****/
+	template <typename T>
+	ChunkedGenerator<T>::Iter::Iter(typename Chunks::Iter chunk):
+		m_Chunk(chunk)
+	{
+		skip_empty();
+	}
+
+	template <typename T>
+	typename ChunkedGenerator<T>::Iter& ChunkedGenerator<T>::Iter::operator ++() {
+		if (++m_Current == m_End) {
+			++m_Chunk;
+			skip_empty();
+		}
+
+		return *this;
+	}
+
+	template <typename T>
+	typename ChunkedGenerator<T>::Iter::pointer ChunkedGenerator<T>::Iter::operator ->() const noexcept {
+		return m_Current;
+	}
+
+	template <typename T>
+	typename ChunkedGenerator<T>::Iter::reference ChunkedGenerator<T>::Iter::operator *() const noexcept {
+		return *m_Current;
+	}
+
+	template <typename T>
+	bool ChunkedGenerator<T>::Iter::operator ==(std::default_sentinel_t) const noexcept {
+		// (cheaper than asking the coroutine every time)
+		return m_Current == nullptr;
+	}
+
+	template <typename T>
+	void ChunkedGenerator<T>::Iter::skip_empty() {
+		while (m_Chunk != std::default_sentinel) {
+			const std::span<T>& chunk = *m_Chunk;
+
+			if (!chunk.empty()) {
+				m_Current = chunk.data();
+				m_End     = chunk.data() + chunk.size();
+				return;
+			}
+
+			++m_Chunk;
+		}
+
+		m_Current = nullptr;
+		m_End     = nullptr;
+	}
+
+	/***** generator functions *****/
+	namespace detail {
+		// (outside of the coroutine, so the loop state stays in registers instead of the frame)
+		template <std::integral I>
+		size_t fill_range(I& first, I last, I step, std::span<I> buffer) noexcept {
+			I      value = first;
+			size_t count = 0;
+
+			while ((count < buffer.size()) && (value < last)) {
+				buffer[count++] = value;
+				value = value + step;
+			}
+
+			first = value;
+
+			return count;
+		}
+	}
+
+	template <std::integral I>
+	ChunkedGenerator<I> iota(I up_to, std::span<std::type_identity_t<I>> buffer) {
+		return range<I>(0, up_to, 1, buffer);
+	}
+
+	template <std::integral I>
+	ChunkedGenerator<I> range(I first, I last, I step, std::span<std::type_identity_t<I>> buffer) {
+		if (buffer.empty())
+			throw std::invalid_argument("range requires a non-empty buffer"); // (thrown from begin())
+
+		while (first < last)
+			co_yield buffer.first(detail::fill_range(first, last, step, buffer));
+	}
+}
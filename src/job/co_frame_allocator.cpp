@@ -0,0 +1,232 @@
+#include "co_frame_allocator.h"
+#include "job_system.h"
+
+#include <bit>
+#include <mutex>
+#include <new>
+
+namespace bop::job {
+	/***** FreeList *****/
+	void CoFrameAllocator::FreeList::push(void* block) noexcept {
+		m_Head = new (block) FreeBlock{ m_Head };
+		++m_Size;
+	}
+
+	CoFrameAllocator::FreeBlock* CoFrameAllocator::FreeList::pop() noexcept {
+		FreeBlock* result = m_Head;
+
+		if (result) {
+			m_Head = result->m_Next;
+			--m_Size;
+		}
+
+		return result;
+	}
+
+	/***** CoFrameAllocator *****/
+	CoFrameAllocator::CoFrameAllocator(
+		JobSystem&                 system,
+		std::pmr::memory_resource* resource,
+		uint32_t                   num_workers
+	):
+		m_System    (system),
+		m_Resource  (resource),
+		m_NumWorkers(num_workers),
+		m_Caches    (std::make_unique<WorkerCache[]>(num_workers))
+	{
+	}
+
+	CoFrameAllocator::~CoFrameAllocator() {
+		for (uint32_t i = 0; i < k_NumSizeClasses; ++i) {
+			for (uint32_t worker = 0; worker < m_NumWorkers; ++worker)
+				release(m_Caches[worker].m_Lists[i], i);
+
+			release(m_Shared[i].m_List, i);
+		}
+	}
+
+	void* CoFrameAllocator::allocate(size_t frame_size) {
+		size_t   size  = frame_size + k_HeaderSize;
+		uint32_t cls   = size_class(size);
+		void*    block = (cls < k_NumSizeClasses) ?
+			allocate_block(cls) :
+			m_Resource->allocate(size, k_HeaderSize); // (too large to pool)
+
+		count_live(1);
+
+		// the header tells deallocate where the block came from
+		new (block) CoFrameAllocator*(this);
+
+		return static_cast<std::byte*>(block) + k_HeaderSize;
+	}
+
+	void* CoFrameAllocator::allocate_global(size_t frame_size) {
+		void* block = ::operator new(frame_size + k_HeaderSize);
+
+		new (block) CoFrameAllocator*(nullptr);
+
+		return static_cast<std::byte*>(block) + k_HeaderSize;
+	}
+
+	void CoFrameAllocator::deallocate(
+		void*  frame,
+		size_t frame_size
+	) noexcept {
+		void*             block = static_cast<std::byte*>(frame) - k_HeaderSize;
+		CoFrameAllocator* self  = *static_cast<CoFrameAllocator**>(block);
+
+		size_t   size = frame_size + k_HeaderSize;
+		uint32_t cls  = size_class(size);
+
+		if (!self) {
+			::operator delete(block, size);
+			return;
+		}
+
+		if (self->m_Retired.load(std::memory_order::acquire)) [[unlikely]] {
+			// the pool is gone; the last frame takes the allocator with it
+			self->m_Resource->deallocate(block, (cls < k_NumSizeClasses) ? block_size(cls) : size, k_HeaderSize);
+
+			if (self->m_NumExternalLive.fetch_sub(1, std::memory_order::acq_rel) == 1)
+				delete self;
+
+			return;
+		}
+
+		self->count_live(-1);
+
+		if (cls < k_NumSizeClasses)
+			self->free_block(block, cls);
+		else
+			self->m_Resource->deallocate(block, size, k_HeaderSize);
+	}
+
+	void CoFrameAllocator::retire(std::unique_ptr<CoFrameAllocator> allocator) noexcept {
+		// (the workers have stopped, so their counts are stable)
+		int64_t num_live = allocator->m_NumExternalLive.load();
+
+		for (uint32_t worker = 0; worker < allocator->m_NumWorkers; ++worker)
+			num_live += allocator->m_Caches[worker].m_NumLive;
+
+		if (num_live == 0)
+			return;
+
+		// nothing is cached anymore, what is still live is counted down from here
+		for (uint32_t i = 0; i < k_NumSizeClasses; ++i) {
+			for (uint32_t worker = 0; worker < allocator->m_NumWorkers; ++worker)
+				allocator->release(allocator->m_Caches[worker].m_Lists[i], i);
+
+			std::scoped_lock guard(allocator->m_Shared[i].m_Lock);
+			allocator->release(allocator->m_Shared[i].m_List, i);
+		}
+
+		allocator->m_NumExternalLive.store(num_live);
+		allocator->m_Retired.store(true, std::memory_order::release);
+		allocator.release();
+	}
+
+	uint32_t CoFrameAllocator::size_class(size_t block_size) noexcept {
+		if (block_size > k_MaxBlockSize)
+			return k_NumSizeClasses;
+
+		if (block_size <= k_MinBlockSize)
+			return 0;
+
+		return static_cast<uint32_t>(std::bit_width(block_size - 1) - std::bit_width(k_MinBlockSize - 1));
+	}
+
+	size_t CoFrameAllocator::block_size(uint32_t size_class) noexcept {
+		return k_MinBlockSize << size_class;
+	}
+
+	void* CoFrameAllocator::allocate_block(uint32_t cls) {
+		// workers have a private cache, which is refilled in batches from the shared list
+		if (m_System.is_worker()) {
+			FreeList& cache = m_Caches[m_System.get_thread_index()].m_Lists[cls];
+
+			if (!cache.m_Head) {
+				std::scoped_lock guard(m_Shared[cls].m_Lock);
+
+				while (
+					(cache.m_Size < k_CacheCapacity / 2) &&
+					m_Shared[cls].m_List.m_Head
+				)
+					cache.push(m_Shared[cls].m_List.pop());
+			}
+
+			if (FreeBlock* block = cache.pop())
+				return block;
+		}
+		else {
+			std::scoped_lock guard(m_Shared[cls].m_Lock);
+
+			if (FreeBlock* block = m_Shared[cls].m_List.pop())
+				return block;
+		}
+
+		return m_Resource->allocate(block_size(cls), k_HeaderSize);
+	}
+
+	void CoFrameAllocator::free_block(
+		void*    block,
+		uint32_t cls
+	) noexcept {
+		if (m_System.is_worker()) {
+			FreeList& cache = m_Caches[m_System.get_thread_index()].m_Lists[cls];
+
+			cache.push(block);
+
+			if (cache.m_Size < k_CacheCapacity)
+				return;
+
+			// overflowing; move half of it to the shared list
+			std::scoped_lock guard(m_Shared[cls].m_Lock);
+
+			while (cache.m_Size > k_CacheCapacity / 2)
+				m_Shared[cls].m_List.push(cache.pop());
+
+			return;
+		}
+
+		{
+			std::scoped_lock guard(m_Shared[cls].m_Lock);
+
+			if (m_Shared[cls].m_List.m_Size < k_SharedCapacity) {
+				m_Shared[cls].m_List.push(block);
+				return;
+			}
+		}
+
+		m_Resource->deallocate(block, block_size(cls), k_HeaderSize);
+	}
+
+	void CoFrameAllocator::release(
+		FreeList& list,
+		uint32_t  cls
+	) noexcept {
+		while (FreeBlock* block = list.pop())
+			m_Resource->deallocate(block, block_size(cls), k_HeaderSize);
+	}
+
+	void CoFrameAllocator::count_live(int64_t delta) noexcept {
+		if (m_System.is_worker())
+			m_Caches[m_System.get_thread_index()].m_NumLive += delta;
+		else
+			m_NumExternalLive.fetch_add(delta, std::memory_order::relaxed);
+	}
+
+	/***** free functions *****/
+	void* allocate_coroutine_frame(size_t frame_size) {
+		if (JobSystem* pool = JobSystem::find_current())
+			return pool->get_frame_allocator().allocate(frame_size);
+
+		return CoFrameAllocator::allocate_global(frame_size);
+	}
+
+	void deallocate_coroutine_frame(
+		void*  frame,
+		size_t frame_size
+	) noexcept {
+		CoFrameAllocator::deallocate(frame, frame_size);
+	}
+}
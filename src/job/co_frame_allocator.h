@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+#include "../util/cacheline.h"
+#include "../util/spinlock.h"
+
+namespace bop::job {
+	class JobSystem;
+
+	// allocates coroutine frames from size-class free lists, backed by the memory resource of a pool
+	//
+	// Workers of the pool keep a small cache per size class that needs no synchronization; other threads
+	// (and workers with an empty cache) go through a shared list per size class. Every frame is prefixed
+	// with a pointer to its allocator, so it can be released from any thread. Frames that are allocated
+	// outside of the workers come from the global heap instead (their header is null).
+	//
+	// Frames may outlive the pool (a generator that was handed out, for example); the pool then retires
+	// its allocator, which stays around until the last of them is released. The memory resource has to
+	// outlive those frames as well.
+	class CoFrameAllocator {
+	public:
+		static constexpr uint32_t k_NumSizeClasses = 7;                               // 64, 128 ... 4096 bytes
+		static constexpr size_t   k_MinBlockSize   = 64;
+		static constexpr size_t   k_MaxBlockSize   = k_MinBlockSize << (k_NumSizeClasses - 1);
+		static constexpr size_t   k_HeaderSize     = alignof(std::max_align_t);       // keeps the frame itself aligned
+		static constexpr uint32_t k_CacheCapacity  = 1 << 6;                          // blocks per size class, per worker
+		static constexpr uint32_t k_SharedCapacity = 1 << 10;                         // blocks per size class, beyond this they go back to the resource
+
+		CoFrameAllocator(
+			JobSystem&                 system,
+			std::pmr::memory_resource* resource,
+			uint32_t                   num_workers
+		);
+		~CoFrameAllocator(); // returns all cached blocks to the memory resource
+
+		CoFrameAllocator             (const CoFrameAllocator&) = delete;
+		CoFrameAllocator& operator = (const CoFrameAllocator&) = delete;
+		CoFrameAllocator             (CoFrameAllocator&&)      = delete;
+		CoFrameAllocator& operator = (CoFrameAllocator&&)      = delete;
+
+		void*        allocate(size_t frame_size);
+		static void* allocate_global(size_t frame_size);                      // from the global heap, with a null header
+		static void  deallocate(void* frame, size_t frame_size) noexcept;     // (finds the allocator that was used, if any)
+
+		// called by the pool once its workers stopped; deletes the allocator, or leaves that to the last frame that is still live
+		static void retire(std::unique_ptr<CoFrameAllocator> allocator) noexcept;
+
+	private:
+		struct FreeBlock {
+			FreeBlock* m_Next;
+		};
+
+		struct FreeList {
+			void       push(void* block) noexcept;
+			FreeBlock* pop() noexcept;
+
+			FreeBlock* m_Head = nullptr;
+			uint32_t   m_Size = 0;
+		};
+
+		struct alignas(util::hardware_destructive_interference_size) WorkerCache {
+			FreeList m_Lists[k_NumSizeClasses];
+			int64_t  m_NumLive = 0; // allocated minus released by this worker (may go negative)
+		};
+
+		struct SharedList {
+			util::Spinlock m_Lock;
+			FreeList       m_List;
+		};
+
+		static uint32_t size_class(size_t block_size) noexcept; // k_NumSizeClasses if it is too large for any class
+		static size_t   block_size(uint32_t size_class) noexcept;
+
+		void* allocate_block(uint32_t size_class);
+		void  free_block(void* block, uint32_t size_class) noexcept;
+
+		void release(FreeList& list, uint32_t size_class) noexcept; // back to the memory resource
+		void count_live(int64_t delta) noexcept;
+
+		JobSystem&                     m_System;
+		std::pmr::memory_resource*     m_Resource;
+		uint32_t                       m_NumWorkers;
+		std::unique_ptr<WorkerCache[]> m_Caches;
+		SharedList                     m_Shared[k_NumSizeClasses];
+		std::atomic<int64_t>           m_NumExternalLive = 0;     // the same for other threads; once retired, all frames that are still live
+		std::atomic<bool>              m_Retired         = false; // the pool is gone, frames go straight back to the resource
+	};
+
+	// frames come from the pool the calling thread is a worker of, otherwise from the global heap
+	// (so creating a coroutine never starts the default pool)
+	void* allocate_coroutine_frame(size_t frame_size);
+	void  deallocate_coroutine_frame(void* frame, size_t frame_size) noexcept;
+
+	// base for coroutine promise types, so their frames are pooled
+	struct PooledFrame {
+		static void* operator new(size_t frame_size) {
+			return allocate_coroutine_frame(frame_size);
+		}
+
+		static void operator delete(void* frame, size_t frame_size) noexcept {
+			deallocate_coroutine_frame(frame, frame_size);
+		}
+	};
+}
@@ -3,6 +3,8 @@
 #include <coroutine>
 #include <optional>
 
+#include "co_frame_allocator.h"
+
 namespace bop::job {
 	// single-threaded wrapper around an algorithm that co_yields a T 
 	// [NOTE] a coroutine handle is a pointer
@@ -12,7 +14,9 @@ namespace bop::job {
 	template <std::movable T>
 	class Generator {
 	public:
-		struct promise_type final {
+		struct promise_type final:
+			PooledFrame
+		{
 			Generator<T> get_return_object();
 			
 			std::suspend_always yield_value(const T& new_value) noexcept;
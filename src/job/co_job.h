@@ -1,9 +1,18 @@
 #pragma once
 
 #include <coroutine>
+#include <cstdint>
+#include <optional>
+
 #include "co_job_promise.h"
 
 namespace bop::job {
+	// lazily started coroutine that runs on the pool
+	//
+	// Awaiting a CoJob schedules it on the current pool (see JobSystem::get_current); when it completes,
+	// the awaiting coroutine is resumed right away by symmetric transfer, so long chains of coroutines
+	// awaiting each other don't grow the stack. Values and exceptions are passed on to the awaiter.
+	// get() does the same for regular functions, blocking until the coroutine completes.
 	template <typename T = void>
 	class CoJob {
 	public:
@@ -13,11 +22,18 @@ namespace bop::job {
 		explicit CoJob(promise_type* pm) noexcept;
 		~CoJob();
 
-		bool await_ready() noexcept;
-		void await_suspend(Handle parent) noexcept;
+		CoJob             (const CoJob&) = delete;
+		CoJob& operator = (const CoJob&) = delete;
+		CoJob             (CoJob&& cj) noexcept;
+		CoJob& operator = (CoJob&& cj) noexcept;
+
+		bool await_ready() const noexcept;
+		void await_suspend(std::coroutine_handle<> awaiter) noexcept;
 		T    await_resume();
 
-		T    get();
+		T    get(); // (blocking)
+
+		Handle get_handle() const noexcept;
 
 	private:
 		Handle m_Handle;
@@ -33,15 +49,32 @@ namespace bop::job {
 		explicit CoJob(promise_type* pm) noexcept;
 		~CoJob();
 
-		bool await_ready() noexcept;
-		void await_suspend(Handle) noexcept;
+		CoJob             (const CoJob&) = delete;
+		CoJob& operator = (const CoJob&) = delete;
+		CoJob             (CoJob&& cj) noexcept;
+		CoJob& operator = (CoJob&& cj) noexcept;
+
+		bool await_ready() const noexcept;
+		void await_suspend(std::coroutine_handle<> awaiter) noexcept;
 		void await_resume();
 
-		void get();
-		
+		void get(); // (blocking)
+
+		Handle get_handle() const noexcept;
+
 	private:
 		Handle m_Handle;
 	};
+
+	// resumes the coroutine on a worker of the current pool, at the priority of the calling job
+	void schedule_coroutine(
+		std::coroutine_handle<> handle,
+		std::optional<uint32_t> thread_index = std::nullopt // a specific worker, if set
+	);
+
+	// starts the coroutine on the current pool and blocks until it completes
+	template <typename P>
+	void run_to_completion(std::coroutine_handle<P> handle);
 }
 
 #include "co_job.inl"
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "co_job.h"
+#include "job_system.h"
+
+#include <stdexcept>
+#include <utility>
 
 namespace bop::job {
 	// CoJob<T>
@@ -17,36 +21,61 @@ namespace bop::job {
 	}
 
 	template <typename T>
-	bool CoJob<T>::await_ready() noexcept {
+	CoJob<T>::CoJob(CoJob&& cj) noexcept:
+		m_Handle(std::exchange(cj.m_Handle, nullptr))
+	{
+	}
+
+	template <typename T>
+	CoJob<T>& CoJob<T>::operator = (CoJob&& cj) noexcept {
+		if (this != &cj) {
+			if (m_Handle)
+				m_Handle.destroy();
+
+			m_Handle = std::exchange(cj.m_Handle, nullptr);
+		}
+
+		return *this;
+	}
+
+	template <typename T>
+	bool CoJob<T>::await_ready() const noexcept {
 		return false;
 	}
 
 	template <typename T>
-	void CoJob<T>::await_suspend(Handle) noexcept {
+	void CoJob<T>::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		m_Handle.promise().m_Continuation = awaiter;
+
+		// (the awaiter may be resumed on another thread before this returns)
+		schedule_coroutine(m_Handle);
 	}
 
 	template <typename T>
 	T CoJob<T>::await_resume() {
-		// this will work for 'returning' coroutines, but not for 'yielding' coroutines
-		while (m_Handle && !m_Handle.done())
-			m_Handle.resume();
-
 		auto& pm = m_Handle.promise();
 
 		if (auto* exp = std::get_if<std::exception_ptr>(&pm.m_Payload))
 			std::rethrow_exception(*exp);
-		
+
 		if (pm.m_Payload.index() == 0) [[unlikely]]
 			throw std::runtime_error("Job promise is in empty state");
-		
-		return std::get<T>(pm.m_Payload);
+
+		return std::get<T>(std::move(pm.m_Payload));
 	}
 
 	template <typename T>
 	T CoJob<T>::get() {
+		run_to_completion(m_Handle);
+
 		return await_resume();
 	}
 
+	template <typename T>
+	typename CoJob<T>::Handle CoJob<T>::get_handle() const noexcept {
+		return m_Handle;
+	}
+
 	// CoJob<void>
 	inline CoJob<void>::CoJob(promise_type* pm) noexcept:
 		m_Handle(Handle::from_promise(*pm))
@@ -58,17 +87,34 @@ namespace bop::job {
 			m_Handle.destroy();
 	}
 
-	inline bool CoJob<void>::await_ready() noexcept {
+	inline CoJob<void>::CoJob(CoJob&& cj) noexcept:
+		m_Handle(std::exchange(cj.m_Handle, nullptr))
+	{
+	}
+
+	inline CoJob<void>& CoJob<void>::operator = (CoJob&& cj) noexcept {
+		if (this != &cj) {
+			if (m_Handle)
+				m_Handle.destroy();
+
+			m_Handle = std::exchange(cj.m_Handle, nullptr);
+		}
+
+		return *this;
+	}
+
+	inline bool CoJob<void>::await_ready() const noexcept {
 		return false;
 	}
 
-	inline void CoJob<void>::await_suspend(Handle) noexcept {
+	inline void CoJob<void>::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		m_Handle.promise().m_Continuation = awaiter;
+
+		// (the awaiter may be resumed on another thread before this returns)
+		schedule_coroutine(m_Handle);
 	}
 
 	inline void CoJob<void>::await_resume() {
-		while (m_Handle && !m_Handle.done())
-			m_Handle.resume();
-
 		auto& pm = m_Handle.promise();
 
 		if (pm.m_Payload)
@@ -76,9 +122,15 @@ namespace bop::job {
 	}
 
 	inline void CoJob<void>::get() {
+		run_to_completion(m_Handle);
+
 		await_resume();
 	}
 
+	inline CoJob<void>::Handle CoJob<void>::get_handle() const noexcept {
+		return m_Handle;
+	}
+
 	// CoJobPromise<void>
 	inline CoJob<void> CoJobPromise<void>::get_return_object() {
 		return CoJob<void>(this);
@@ -91,11 +143,31 @@ namespace bop::job {
 		m_Payload = std::current_exception();
 	}
 
-	inline auto CoJobPromise<void>::initial_suspend() {
-		return std::suspend_always();
+	// free functions
+	inline void schedule_coroutine(
+		std::coroutine_handle<> handle,
+		std::optional<uint32_t> thread_index
+	) {
+		auto& pool = JobSystem::get_current();
+
+		pool.schedule(
+			[handle] { handle.resume(); },
+			nullptr,
+			thread_index,
+			pool.current_priority()
+		);
 	}
 
-	inline auto CoJobPromise<void>::final_suspend() noexcept {
-		return std::suspend_always();
+	template <typename P>
+	void run_to_completion(std::coroutine_handle<P> handle) {
+		auto& pool = JobSystem::get_current();
+
+		std::atomic<uint32_t> pending = 1;
+
+		handle.promise().m_Completion = &pending;
+		handle.promise().m_System     = &pool;
+
+		schedule_coroutine(handle);
+		pool.wait(pending);
 	}
 }
\ No newline at end of file
@@ -1,38 +1,73 @@
 #pragma once
 
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
 #include <variant>
 #include <optional>
 
+#include "co_frame_allocator.h"
+
 namespace bop::job {
 	template <typename T> class CoJob;
 	template <>           class CoJob<void>;
 
+	class JobSystem;
+
+	// completion counter for a group of coroutines (see when_all and when_any)
+	class CoJobLatch {
+	public:
+		// called as each coroutine of the group completes, returns what to resume next (if anything)
+		virtual std::coroutine_handle<> complete(std::coroutine_handle<> coroutine) noexcept = 0;
+
+	protected:
+		~CoJobLatch() = default;
+	};
+
+	// shared by all CoJob promises; keeps track of what should happen once the coroutine completes
+	struct CoJobPromiseBase:
+		PooledFrame
+	{
+		// resumes the awaiting coroutine via symmetric transfer, or informs the group it belongs to, or
+		// releases a thread blocked in CoJob::get
+		struct FinalAwaiter {
+			bool await_ready() const noexcept;
+			void await_resume() const noexcept;
+
+			template <typename P>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<P> self) noexcept;
+		};
+
+		std::suspend_always initial_suspend() const noexcept; // lazily started
+		FinalAwaiter        final_suspend()   const noexcept;
+
+		std::coroutine_handle<> m_Continuation = nullptr; // the awaiting coroutine (if any)
+		CoJobLatch*             m_Latch        = nullptr; // the group this is part of (if any)
+		std::atomic<uint32_t>*  m_Completion   = nullptr; // set to zero on completion (if set)
+		JobSystem*              m_System       = nullptr; // the pool that is notified alongside m_Completion
+	};
+
 	template <typename T = void>
-	struct CoJobPromise {
+	struct CoJobPromise:
+		CoJobPromiseBase
+	{
 		CoJob<T> get_return_object();
 
-		void return_value(T new_value);		
-		
+		void return_value(T new_value);
 		void unhandled_exception();
-		auto initial_suspend();
-		auto final_suspend() noexcept;
-
-		void await_transform() = delete;
 
 		std::variant<std::monostate, T, std::exception_ptr> m_Payload;
 	};
 
 	// void specialization
 	template <>
-	struct CoJobPromise<void> {
+	struct CoJobPromise<void>:
+		CoJobPromiseBase
+	{
 		CoJob<void> get_return_object();
 
 		void return_void();
 		void unhandled_exception();
-		auto initial_suspend();
-		auto final_suspend() noexcept;
-
-		void await_transform() = delete;
 
 		std::optional<std::exception_ptr> m_Payload;
 	};
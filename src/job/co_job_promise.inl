@@ -1,9 +1,48 @@
 #pragma once
 
 #include "co_job_promise.h"
+#include "job_system.h"
 #include <exception>
 
 namespace bop::job {
+	// CoJobPromiseBase
+	inline bool CoJobPromiseBase::FinalAwaiter::await_ready() const noexcept {
+		return false;
+	}
+
+	inline void CoJobPromiseBase::FinalAwaiter::await_resume() const noexcept {
+	}
+
+	template <typename P>
+	std::coroutine_handle<> CoJobPromiseBase::FinalAwaiter::await_suspend(std::coroutine_handle<P> self) noexcept {
+		CoJobPromiseBase& pm = self.promise();
+
+		if (pm.m_Continuation)
+			return pm.m_Continuation;
+
+		if (pm.m_Latch)
+			return pm.m_Latch->complete(self);
+
+		if (pm.m_Completion) {
+			// once the counter is zero the frame may be gone, so take what we need first
+			JobSystem*             system     = pm.m_System;
+			std::atomic<uint32_t>* completion = pm.m_Completion;
+
+			completion->store(0, std::memory_order::seq_cst);
+			system->notify_completion();
+		}
+
+		return std::noop_coroutine();
+	}
+
+	inline std::suspend_always CoJobPromiseBase::initial_suspend() const noexcept {
+		return {};
+	}
+
+	inline CoJobPromiseBase::FinalAwaiter CoJobPromiseBase::final_suspend() const noexcept {
+		return {};
+	}
+
 	// CoJobPromise<T>
 	template <typename T>
 	CoJob<T> CoJobPromise<T>::get_return_object() {
@@ -19,14 +58,4 @@ namespace bop::job {
 	void CoJobPromise<T>::unhandled_exception() {
 		m_Payload = std::current_exception();
 	}
-
-	template <typename T>
-	auto CoJobPromise<T>::initial_suspend() {
-		return std::suspend_always();
-	}
-
-	template <typename T>
-	auto CoJobPromise<T>::final_suspend() noexcept {
-		return std::suspend_always();
-	}
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory_resource>
+#include <optional>
+
+#include "co_generator.h"
+#include "../util/spsc_ring.h"
+
+namespace bop::job {
+	class JobSystem;
+
+	// runs a Generator ahead of its consumer on a pool worker
+	//
+	// The generator is resumed by a job that fills a ring of up to 'depth' values; the consumer only
+	// takes values that are ready, so producing and consuming overlap. When the ring is full the job
+	// ends, and it is scheduled again once the consumer made room. When the ring is empty, the consumer
+	// waits like JobSystem::wait does (on a worker it keeps executing other jobs).
+	//
+	// Exceptions thrown by the generator are rethrown to the consumer after the values before them.
+	// Dropping the adapter early stops the producer at the next value; the generator itself is destroyed
+	// by whichever side lets go of it last.
+	template <std::movable T>
+	class Prefetch {
+	public:
+		Prefetch(
+			Generator<T> gen,
+			uint32_t     depth,
+			JobSystem&   pool
+		);
+		~Prefetch();
+
+		Prefetch             (const Prefetch&) = delete;
+		Prefetch& operator = (const Prefetch&) = delete;
+		Prefetch             (Prefetch&&)      = delete;
+		Prefetch& operator = (Prefetch&&)      = delete;
+
+		class Iter final {
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using difference_type   = std::ptrdiff_t;
+			using value_type        = T;
+			using reference         =       value_type&;
+			using pointer           =       value_type*;
+
+			explicit Iter(Prefetch* owner) noexcept;
+
+			// only allow pre-increment
+			Iter& operator++(int) = delete;
+			Iter& operator++();
+
+			pointer   operator ->() const noexcept;
+			reference operator * () const noexcept;
+
+			bool operator ==(std::default_sentinel_t) const noexcept;
+
+		private:
+			Prefetch* m_Owner; // non-owning
+		};
+
+		Iter                    begin(); // (blocks until the first value is available)
+		std::default_sentinel_t end() const noexcept;
+
+		bool next(); // moves the next value into the current one, blocks until it's there; false at the end
+
+	private:
+		// shared between the consumer and the producer job; released by both
+		struct State {
+			State(
+				Generator<T>               gen,
+				uint32_t                   depth,
+				JobSystem*                 pool,
+				std::pmr::memory_resource* resource
+			);
+
+			void produce() noexcept; // (the job body)
+			void wake_consumer() noexcept;
+			void restart_producer() noexcept;
+			void release() noexcept;
+
+			Generator<T>                                 m_Generator;
+			std::optional<typename Generator<T>::Iter>   m_Position;  // of the next value to push
+			util::SpscRing<T>                            m_Ring;
+			JobSystem*                                   m_System;
+			std::pmr::memory_resource*                   m_Resource;
+			std::exception_ptr                           m_Exception; // (published by m_Finished)
+
+			std::atomic<uint32_t> m_References = 2;     // consumer + producer
+			std::atomic<uint32_t> m_Busy       = 1;     // a producer job is scheduled or running
+			std::atomic<uint32_t> m_Signal     = 0;     // the consumer waits for this to become zero
+			std::atomic<bool>     m_Finished   = false; // the producer is done (generator exhausted, failed or stopped)
+			std::atomic<bool>     m_Stop       = false; // the consumer is gone
+		};
+
+		State*           m_State;
+		std::optional<T> m_Current;
+	};
+
+	// moves the generator to a worker of the pool, which stays up to 'depth' values ahead
+	template <std::movable T>
+	Prefetch<T> prefetch(Generator<T> gen, uint32_t depth);
+
+	template <std::movable T>
+	Prefetch<T> prefetch(Generator<T> gen, uint32_t depth, JobSystem& pool);
+}
+
+#include "co_prefetch.inl"
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "co_prefetch.h"
+#include "job_system.h"
+
+#include <new>
+#include <utility>
+
+namespace bop::job {
+	/***** Prefetch::State *****/
+	template <std::movable T>
+	Prefetch<T>::State::State(
+		Generator<T>               gen,
+		uint32_t                   depth,
+		JobSystem*                 pool,
+		std::pmr::memory_resource* resource
+	):
+		m_Generator(std::move(gen)),
+		m_Ring     (depth),
+		m_System   (pool),
+		m_Resource (resource)
+	{
+	}
+
+	template <std::movable T>
+	void Prefetch<T>::State::produce() noexcept {
+		try {
+			while (!m_Stop.load(std::memory_order::acquire)) {
+				if (!m_Position)
+					m_Position.emplace(m_Generator.begin());
+
+				if (*m_Position == std::default_sentinel)
+					break;
+
+				// (a failed push leaves the value in the generator, so it is retried when restarted)
+				if (!m_Ring.try_push(std::move(*m_Position->operator->()))) {
+					// go idle until the consumer makes room...
+					m_Busy.store(0, std::memory_order::seq_cst);
+					std::atomic_thread_fence(std::memory_order::seq_cst);
+
+					if (m_Ring.full() && !m_Stop.load(std::memory_order::seq_cst))
+						return;
+
+					// ...unless it already did (or left) before it could see that; one of us restarts
+					uint32_t expected = 0;
+
+					if (!m_Busy.compare_exchange_strong(expected, 1, std::memory_order::seq_cst))
+						return;
+
+					continue;
+				}
+
+				wake_consumer();
+
+				++*m_Position;
+			}
+		}
+		catch (...) {
+			m_Exception = std::current_exception();
+		}
+
+		m_Finished.store(true, std::memory_order::seq_cst);
+		wake_consumer();
+		release();
+	}
+
+	template <std::movable T>
+	void Prefetch<T>::State::wake_consumer() noexcept {
+		// (pairs with the fence in Prefetch::next)
+		std::atomic_thread_fence(std::memory_order::seq_cst);
+
+		if (m_Signal.load(std::memory_order::relaxed) != 0) {
+			m_Signal.store(0, std::memory_order::seq_cst);
+			m_System->notify_completion();
+		}
+	}
+
+	template <std::movable T>
+	void Prefetch<T>::State::restart_producer() noexcept {
+		// (pairs with the fence in produce)
+		std::atomic_thread_fence(std::memory_order::seq_cst);
+
+		if (m_Busy.load(std::memory_order::relaxed) != 0)
+			return;
+
+		uint32_t expected = 0;
+
+		if (m_Busy.compare_exchange_strong(expected, 1, std::memory_order::seq_cst))
+			m_System->schedule([this] { produce(); });
+	}
+
+	template <std::movable T>
+	void Prefetch<T>::State::release() noexcept {
+		if (m_References.fetch_sub(1, std::memory_order::acq_rel) != 1)
+			return;
+
+		std::pmr::memory_resource* resource = m_Resource;
+
+		this->~State();
+		resource->deallocate(this, sizeof(State), alignof(State));
+	}
+
+	/***** Prefetch *****/
+	template <std::movable T>
+	Prefetch<T>::Prefetch(
+		Generator<T> gen,
+		uint32_t     depth,
+		JobSystem&   pool
+	) {
+		std::pmr::memory_resource* resource = pool.get_memory_resource();
+
+		m_State = new (resource->allocate(sizeof(State), alignof(State))) State(std::move(gen), depth, &pool, resource);
+
+		State* state = m_State;
+
+		pool.schedule([state] { state->produce(); });
+	}
+
+	template <std::movable T>
+	Prefetch<T>::~Prefetch() {
+		m_State->m_Stop.store(true, std::memory_order::seq_cst);
+
+		// if the producer is idle, nobody is going to restart it; let go on its behalf
+		uint32_t expected = 0;
+
+		if (m_State->m_Busy.compare_exchange_strong(expected, 1, std::memory_order::seq_cst))
+			m_State->release();
+
+		m_State->release();
+	}
+
+	template <std::movable T>
+	bool Prefetch<T>::next() {
+		State* state = m_State;
+
+		while (true) {
+			if (T* value = state->m_Ring.front()) {
+				m_Current.emplace(std::move(*value));
+				state->m_Ring.pop();
+				state->restart_producer();
+
+				return true;
+			}
+
+			if (state->m_Finished.load(std::memory_order::acquire)) {
+				// (everything that was pushed before finishing is visible now)
+				if (state->m_Ring.front())
+					continue;
+
+				m_Current.reset();
+
+				if (state->m_Exception)
+					std::rethrow_exception(std::exchange(state->m_Exception, nullptr));
+
+				return false;
+			}
+
+			// announce that we're waiting, then check once more before actually waiting
+			state->m_Signal.store(1, std::memory_order::seq_cst);
+			std::atomic_thread_fence(std::memory_order::seq_cst);
+
+			if (
+				!state->m_Ring.empty() ||
+				state->m_Finished.load(std::memory_order::seq_cst)
+			)
+				continue;
+
+			state->m_System->wait(state->m_Signal);
+		}
+	}
+
+	template <std::movable T>
+	typename Prefetch<T>::Iter Prefetch<T>::begin() {
+		next();
+
+		return Iter(this);
+	}
+
+	template <std::movable T>
+	std::default_sentinel_t Prefetch<T>::end() const noexcept {
+		return {};
+	}
+
+	/***** Iter *****/
+	template <std::movable T>
+	Prefetch<T>::Iter::Iter(Prefetch* owner) noexcept:
+		m_Owner(owner)
+	{
+	}
+
+	template <std::movable T>
+	typename Prefetch<T>::Iter& Prefetch<T>::Iter::operator ++() {
+		m_Owner->next();
+
+		return *this;
+	}
+
+	template <std::movable T>
+	typename Prefetch<T>::Iter::pointer Prefetch<T>::Iter::operator ->() const noexcept {
+		return &*m_Owner->m_Current;
+	}
+
+	template <std::movable T>
+	typename Prefetch<T>::Iter::reference Prefetch<T>::Iter::operator *() const noexcept {
+		return *m_Owner->m_Current;
+	}
+
+	template <std::movable T>
+	bool Prefetch<T>::Iter::operator ==(std::default_sentinel_t) const noexcept {
+		return !m_Owner->m_Current.has_value();
+	}
+
+	/***** free functions *****/
+	template <std::movable T>
+	Prefetch<T> prefetch(Generator<T> gen, uint32_t depth) {
+		return Prefetch<T>(std::move(gen), depth, JobSystem::get_current());
+	}
+
+	template <std::movable T>
+	Prefetch<T> prefetch(Generator<T> gen, uint32_t depth, JobSystem& pool) {
+		return Prefetch<T>(std::move(gen), depth, pool);
+	}
+}
@@ -0,0 +1,59 @@
+#include "co_resume.h"
+#include "co_job.h"
+#include "job_system.h"
+
+namespace bop::job {
+	/***** ResumeOn *****/
+	ResumeOn::ResumeOn(uint32_t thread_index) noexcept:
+		m_ThreadIndex(thread_index)
+	{
+	}
+
+	bool ResumeOn::await_ready() const noexcept {
+		const auto& pool = JobSystem::get_current();
+
+		return
+			pool.is_worker() &&
+			(pool.get_thread_index() == m_ThreadIndex);
+	}
+
+	void ResumeOn::await_suspend(std::coroutine_handle<> awaiter) const {
+		schedule_coroutine(awaiter, m_ThreadIndex);
+	}
+
+	void ResumeOn::await_resume() const noexcept {
+	}
+
+	/***** ResumeOnAny *****/
+	ResumeOnAny::ResumeOnAny(bool always) noexcept:
+		m_Always(always)
+	{
+	}
+
+	bool ResumeOnAny::await_ready() const noexcept {
+		if (m_Always)
+			return false;
+
+		return JobSystem::get_current().is_worker();
+	}
+
+	void ResumeOnAny::await_suspend(std::coroutine_handle<> awaiter) const {
+		schedule_coroutine(awaiter);
+	}
+
+	void ResumeOnAny::await_resume() const noexcept {
+	}
+
+	/***** free functions *****/
+	ResumeOn resume_on(uint32_t thread_index) noexcept {
+		return ResumeOn(thread_index);
+	}
+
+	ResumeOnAny resume_on_any() noexcept {
+		return ResumeOnAny();
+	}
+
+	ResumeOnAny yield_to_pool() noexcept {
+		return ResumeOnAny(true);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <coroutine>
+#include <cstdint>
+
+namespace bop::job {
+	// moves the awaiting coroutine onto a specific worker of the current pool
+	//
+	// The coroutine handle itself is scheduled as a (pinned) job, so there is no intermediate frame;
+	// if the coroutine already runs on that worker it just continues without suspending.
+	class ResumeOn {
+	public:
+		explicit ResumeOn(uint32_t thread_index) noexcept;
+
+		bool await_ready() const noexcept;
+		void await_suspend(std::coroutine_handle<> awaiter) const;
+		void await_resume() const noexcept;
+
+	private:
+		uint32_t m_ThreadIndex;
+	};
+
+	// moves the awaiting coroutine onto any worker of the current pool (or stays put if it already is on one)
+	//
+	// With m_Always set, the coroutine is rescheduled even when it is on a worker already,
+	// which gives other jobs a chance to run in between.
+	class ResumeOnAny {
+	public:
+		explicit ResumeOnAny(bool always = false) noexcept;
+
+		bool await_ready() const noexcept;
+		void await_suspend(std::coroutine_handle<> awaiter) const;
+		void await_resume() const noexcept;
+
+	private:
+		bool m_Always;
+	};
+
+	ResumeOn    resume_on(uint32_t thread_index) noexcept; // thread_index should be smaller than the number of workers
+	ResumeOnAny resume_on_any() noexcept;
+	ResumeOnAny yield_to_pool() noexcept;                 // always suspends
+}
@@ -0,0 +1,47 @@
+#include "co_sleep.h"
+#include "job_system.h"
+
+namespace bop::job {
+	SleepAwaiter::SleepAwaiter(JobSystem& pool, TimerWheel::Timepoint deadline) noexcept:
+		m_System  (pool),
+		m_Deadline(deadline)
+	{
+	}
+
+	bool SleepAwaiter::await_ready() const noexcept {
+		return m_Deadline <= TimerWheel::Clock::now();
+	}
+
+	void SleepAwaiter::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		m_Coroutine = awaiter;
+		m_Priority  = m_System.current_priority();
+
+		// (the timer may expire on another worker right away, this must be the last thing to touch the awaiter)
+		m_System.add_timer(*this, m_Deadline);
+	}
+
+	void SleepAwaiter::await_resume() const noexcept {
+	}
+
+	void SleepAwaiter::expire() noexcept {
+		m_System.schedule(
+			[coroutine = m_Coroutine] { coroutine.resume(); },
+			nullptr,
+			std::nullopt,
+			m_Priority
+		);
+	}
+
+	void SleepAwaiter::discard() noexcept {
+	}
+}
+
+namespace bop {
+	job::SleepAwaiter sleep_for(job::TimerWheel::Duration delay) noexcept {
+		return sleep_until(job::TimerWheel::Clock::now() + delay);
+	}
+
+	job::SleepAwaiter sleep_until(job::TimerWheel::Timepoint deadline) noexcept {
+		return job::SleepAwaiter(job::JobSystem::get_current(), deadline);
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <coroutine>
+
+#include "job_priority.h"
+#include "job_timer.h"
+
+namespace bop::job {
+	class JobSystem;
+
+	// suspends the awaiting coroutine until the deadline passed, without occupying a worker
+	//
+	// The awaiter itself is the timer node (it lives in the coroutine frame), so sleeping doesn't
+	// allocate. Once the timer expires the coroutine is resumed as a job on the pool it was suspended
+	// on, at the priority it had. A coroutine that is still sleeping when the pool is destroyed is
+	// never resumed.
+	class [[nodiscard]] SleepAwaiter final:
+		public TimerNode
+	{
+	public:
+		SleepAwaiter(JobSystem& pool, TimerWheel::Timepoint deadline) noexcept;
+
+		SleepAwaiter             (const SleepAwaiter&) = delete;
+		SleepAwaiter& operator = (const SleepAwaiter&) = delete;
+		SleepAwaiter             (SleepAwaiter&&)      = delete;
+		SleepAwaiter& operator = (SleepAwaiter&&)      = delete;
+
+		bool await_ready() const noexcept; // true if the deadline passed already
+		void await_suspend(std::coroutine_handle<> awaiter) noexcept;
+		void await_resume() const noexcept;
+
+	private:
+		void expire()  noexcept override;
+		void discard() noexcept override;
+
+		JobSystem&              m_System;
+		TimerWheel::Timepoint   m_Deadline;
+		std::coroutine_handle<> m_Coroutine = nullptr;
+		e_Priority              m_Priority  = e_Priority::normal;
+	};
+}
+
+namespace bop {
+	job::SleepAwaiter sleep_for  (job::TimerWheel::Duration  delay)    noexcept; // co_await the result
+	job::SleepAwaiter sleep_until(job::TimerWheel::Timepoint deadline) noexcept; // co_await the result
+}
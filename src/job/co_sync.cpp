@@ -0,0 +1,381 @@
+#include "co_sync.h"
+#include "job_system.h"
+
+#include <utility>
+
+namespace bop::job {
+	namespace {
+		// the lists are pushed to at the front; this restores the order in which the waiters arrived
+		AsyncWaiter* reverse(AsyncWaiter* list) noexcept {
+			AsyncWaiter* result = nullptr;
+
+			while (list) {
+				AsyncWaiter* next = list->m_Next;
+
+				list->m_Next = result;
+				result       = list;
+				list         = next;
+			}
+
+			return result;
+		}
+	}
+
+	/***** AsyncWaiter *****/
+	void AsyncWaiter::prepare(std::coroutine_handle<> coroutine) noexcept {
+		auto& pool = JobSystem::get_current();
+
+		m_Coroutine = coroutine;
+		m_System    = &pool;
+		m_Priority  = pool.current_priority();
+	}
+
+	void AsyncWaiter::schedule() const noexcept {
+		// (the waiter is part of the coroutine frame, so it may be gone as soon as this is scheduled)
+		std::coroutine_handle<> coroutine = m_Coroutine;
+
+		m_System->schedule(
+			[coroutine] { coroutine.resume(); },
+			nullptr,
+			std::nullopt,
+			m_Priority
+		);
+	}
+
+	/***** AsyncLockGuard *****/
+	AsyncLockGuard::AsyncLockGuard(AsyncMutex& mutex) noexcept:
+		m_Mutex(&mutex)
+	{
+	}
+
+	AsyncLockGuard::~AsyncLockGuard() {
+		if (m_Mutex)
+			m_Mutex->unlock();
+	}
+
+	AsyncLockGuard::AsyncLockGuard(AsyncLockGuard&& guard) noexcept:
+		m_Mutex(std::exchange(guard.m_Mutex, nullptr))
+	{
+	}
+
+	AsyncLockGuard& AsyncLockGuard::operator = (AsyncLockGuard&& guard) noexcept {
+		if (this != &guard) {
+			if (m_Mutex)
+				m_Mutex->unlock();
+
+			m_Mutex = std::exchange(guard.m_Mutex, nullptr);
+		}
+
+		return *this;
+	}
+
+	/***** AsyncMutex::LockAwaiter *****/
+	AsyncMutex::LockAwaiter::LockAwaiter(AsyncMutex& mutex) noexcept:
+		m_Mutex(mutex)
+	{
+	}
+
+	bool AsyncMutex::LockAwaiter::await_ready() noexcept {
+		return m_Mutex.try_lock();
+	}
+
+	bool AsyncMutex::LockAwaiter::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		prepare(awaiter);
+
+		uintptr_t state = m_Mutex.m_State.load(std::memory_order::acquire);
+
+		while (true) {
+			if (state == k_NotLocked) {
+				if (m_Mutex.m_State.compare_exchange_weak(
+					state,
+					k_LockedWithoutWait,
+					std::memory_order::acquire,
+					std::memory_order::relaxed
+				))
+					return false; // got it after all
+			}
+			else {
+				m_Next = (state == k_LockedWithoutWait) ?
+					nullptr :
+					reinterpret_cast<AsyncWaiter*>(state);
+
+				if (m_Mutex.m_State.compare_exchange_weak(
+					state,
+					reinterpret_cast<uintptr_t>(static_cast<AsyncWaiter*>(this)),
+					std::memory_order::release,
+					std::memory_order::acquire
+				))
+					return true;
+			}
+		}
+	}
+
+	void AsyncMutex::LockAwaiter::await_resume() const noexcept {
+	}
+
+	AsyncLockGuard AsyncMutex::ScopedLockAwaiter::await_resume() const noexcept {
+		return AsyncLockGuard(m_Mutex);
+	}
+
+	/***** AsyncMutex *****/
+	bool AsyncMutex::try_lock() noexcept {
+		uintptr_t expected = k_NotLocked;
+
+		return m_State.compare_exchange_strong(
+			expected,
+			k_LockedWithoutWait,
+			std::memory_order::acquire,
+			std::memory_order::relaxed
+		);
+	}
+
+	AsyncMutex::LockAwaiter AsyncMutex::lock() noexcept {
+		return LockAwaiter(*this);
+	}
+
+	AsyncMutex::ScopedLockAwaiter AsyncMutex::scoped_lock() noexcept {
+		return ScopedLockAwaiter(*this);
+	}
+
+	void AsyncMutex::unlock() noexcept {
+		if (!m_Waiters) {
+			uintptr_t expected = k_LockedWithoutWait;
+
+			if (m_State.compare_exchange_strong(
+				expected,
+				k_NotLocked,
+				std::memory_order::release,
+				std::memory_order::relaxed
+			))
+				return;
+
+			// new waiters arrived; take all of them at once
+			uintptr_t waiters = m_State.exchange(k_LockedWithoutWait, std::memory_order::acquire);
+
+			m_Waiters = reverse(reinterpret_cast<AsyncWaiter*>(waiters));
+		}
+
+		// the mutex stays locked, ownership moves on to the oldest waiter
+		AsyncWaiter* next = m_Waiters;
+		m_Waiters = next->m_Next;
+
+		next->schedule();
+	}
+
+	/***** AsyncSemaphore::AcquireAwaiter *****/
+	AsyncSemaphore::AcquireAwaiter::AcquireAwaiter(AsyncSemaphore& semaphore) noexcept:
+		m_Semaphore(semaphore)
+	{
+	}
+
+	bool AsyncSemaphore::AcquireAwaiter::await_ready() noexcept {
+		return m_Semaphore.try_acquire();
+	}
+
+	bool AsyncSemaphore::AcquireAwaiter::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		prepare(awaiter);
+
+		return m_Semaphore.enqueue(this);
+	}
+
+	void AsyncSemaphore::AcquireAwaiter::await_resume() const noexcept {
+	}
+
+	/***** AsyncSemaphore *****/
+	AsyncSemaphore::AsyncSemaphore(uint32_t num_permits) noexcept:
+		m_State((uintptr_t(num_permits) << 1) | 1)
+	{
+	}
+
+	bool AsyncSemaphore::try_acquire() noexcept {
+		uintptr_t state = m_State.load(std::memory_order::relaxed);
+
+		// (a count of zero is just the tag bit)
+		while ((state & 1) && (state > 1))
+			if (m_State.compare_exchange_weak(
+				state,
+				state - 2,
+				std::memory_order::acquire,
+				std::memory_order::relaxed
+			))
+				return true;
+
+		return false;
+	}
+
+	AsyncSemaphore::AcquireAwaiter AsyncSemaphore::acquire() noexcept {
+		return AcquireAwaiter(*this);
+	}
+
+	void AsyncSemaphore::release(uint32_t num_permits) noexcept {
+		for (uint32_t i = 0; i < num_permits; ++i) {
+			uintptr_t state = m_State.load(std::memory_order::relaxed);
+
+			while (true) {
+				if (state & 1) {
+					// nobody is waiting, just add the permit
+					if (m_State.compare_exchange_weak(
+						state,
+						state + 2,
+						std::memory_order::release,
+						std::memory_order::relaxed
+					))
+						break;
+				}
+				else if (m_State.compare_exchange_weak(
+					state,
+					1, // (no permits, no waiters)
+					std::memory_order::acq_rel,
+					std::memory_order::relaxed
+				)) {
+					// the oldest waiter gets this permit, the others line up again (and may get one on the way)
+					AsyncWaiter* waiters = reverse(reinterpret_cast<AsyncWaiter*>(state));
+					AsyncWaiter* first   = waiters;
+
+					waiters = waiters->m_Next;
+					first->schedule();
+
+					while (waiters) {
+						AsyncWaiter* next = waiters->m_Next;
+
+						if (!enqueue(waiters))
+							waiters->schedule();
+
+						waiters = next;
+					}
+
+					break;
+				}
+			}
+		}
+	}
+
+	uint32_t AsyncSemaphore::get_num_permits() const noexcept {
+		uintptr_t state = m_State.load(std::memory_order::relaxed);
+
+		return (state & 1) ?
+			static_cast<uint32_t>(state >> 1) :
+			0;
+	}
+
+	bool AsyncSemaphore::enqueue(AsyncWaiter* waiter) noexcept {
+		uintptr_t state = m_State.load(std::memory_order::acquire);
+
+		while (true) {
+			if ((state & 1) && (state > 1)) {
+				if (m_State.compare_exchange_weak(
+					state,
+					state - 2,
+					std::memory_order::acquire,
+					std::memory_order::relaxed
+				))
+					return false;
+			}
+			else {
+				waiter->m_Next = (state & 1) ?
+					nullptr :
+					reinterpret_cast<AsyncWaiter*>(state);
+
+				if (m_State.compare_exchange_weak(
+					state,
+					reinterpret_cast<uintptr_t>(waiter),
+					std::memory_order::release,
+					std::memory_order::acquire
+				))
+					return true;
+			}
+		}
+	}
+
+	/***** AsyncEvent::WaitAwaiter *****/
+	AsyncEvent::WaitAwaiter::WaitAwaiter(const AsyncEvent& event) noexcept:
+		m_Event(event)
+	{
+	}
+
+	bool AsyncEvent::WaitAwaiter::await_ready() const noexcept {
+		return m_Event.is_set();
+	}
+
+	bool AsyncEvent::WaitAwaiter::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		prepare(awaiter);
+
+		const void* set_state = &m_Event;
+		const void* state     = m_Event.m_State.load(std::memory_order::acquire);
+
+		do {
+			if (state == set_state)
+				return false;
+
+			m_Next = static_cast<AsyncWaiter*>(const_cast<void*>(state));
+		} while (!m_Event.m_State.compare_exchange_weak(
+			state,
+			static_cast<AsyncWaiter*>(this),
+			std::memory_order::release,
+			std::memory_order::acquire
+		));
+
+		return true;
+	}
+
+	void AsyncEvent::WaitAwaiter::await_resume() const noexcept {
+	}
+
+	/***** AsyncEvent *****/
+	AsyncEvent::AsyncEvent(bool initially_set) noexcept:
+		m_State(initially_set ? this : nullptr)
+	{
+	}
+
+	AsyncEvent::WaitAwaiter AsyncEvent::wait() const noexcept {
+		return WaitAwaiter(*this);
+	}
+
+	void AsyncEvent::set() noexcept {
+		const void* state = m_State.exchange(this, std::memory_order::acq_rel);
+
+		if (state == this)
+			return;
+
+		auto* waiters = reverse(static_cast<AsyncWaiter*>(const_cast<void*>(state)));
+
+		while (waiters) {
+			AsyncWaiter* next = waiters->m_Next; // (before the waiter is gone)
+
+			waiters->schedule();
+			waiters = next;
+		}
+	}
+
+	void AsyncEvent::reset() noexcept {
+		const void* expected = this;
+
+		m_State.compare_exchange_strong(expected, nullptr, std::memory_order::relaxed);
+	}
+
+	bool AsyncEvent::is_set() const noexcept {
+		return m_State.load(std::memory_order::acquire) == this;
+	}
+
+	/***** AsyncLatch *****/
+	AsyncLatch::AsyncLatch(uint32_t count) noexcept:
+		m_Count(count),
+		m_Event(count == 0)
+	{
+	}
+
+	void AsyncLatch::count_down(uint32_t n) noexcept {
+		uint32_t previous = m_Count.fetch_sub(n, std::memory_order::acq_rel);
+
+		if ((previous > 0) && (previous <= n))
+			m_Event.set();
+	}
+
+	bool AsyncLatch::is_ready() const noexcept {
+		return m_Event.is_set();
+	}
+
+	AsyncEvent::WaitAwaiter AsyncLatch::wait() const noexcept {
+		return m_Event.wait();
+	}
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+
+#include "job_priority.h"
+
+namespace bop::job {
+	class JobSystem;
+
+	// synchronization primitives that suspend the awaiting coroutine instead of blocking the worker
+	//
+	// Waiting coroutines are kept in lock-free intrusive lists (the nodes are the awaiters themselves,
+	// which live in the coroutine frames), so waiting never allocates. Uncontended acquisition is a single
+	// compare-exchange. Waiters are resumed by scheduling them on the pool they were running on, at the
+	// priority they had when they started waiting.
+
+	// (the node that is linked into the wait lists)
+	class AsyncWaiter {
+	public:
+		void prepare(std::coroutine_handle<> coroutine) noexcept; // records where to resume
+		void schedule() const noexcept;                          // resumes the coroutine as a job
+
+		AsyncWaiter*            m_Next      = nullptr;
+		std::coroutine_handle<> m_Coroutine = nullptr;
+		JobSystem*              m_System    = nullptr;
+		e_Priority              m_Priority  = e_Priority::normal;
+	};
+
+	class AsyncMutex;
+
+	// unlocks the mutex when it goes out of scope
+	class [[nodiscard]] AsyncLockGuard {
+	public:
+		explicit AsyncLockGuard(AsyncMutex& mutex) noexcept; // (adopts the lock)
+		~AsyncLockGuard();
+
+		AsyncLockGuard             (const AsyncLockGuard&) = delete;
+		AsyncLockGuard& operator = (const AsyncLockGuard&) = delete;
+		AsyncLockGuard             (AsyncLockGuard&& guard) noexcept;
+		AsyncLockGuard& operator = (AsyncLockGuard&& guard) noexcept;
+
+	private:
+		AsyncMutex* m_Mutex;
+	};
+
+	// ownership is handed directly to the next waiter on unlock (in FIFO order)
+	class AsyncMutex {
+	public:
+		class LockAwaiter:
+			public AsyncWaiter
+		{
+		public:
+			explicit LockAwaiter(AsyncMutex& mutex) noexcept;
+
+			bool await_ready() noexcept;
+			bool await_suspend(std::coroutine_handle<> awaiter) noexcept;
+			void await_resume() const noexcept;
+
+		protected:
+			AsyncMutex& m_Mutex;
+		};
+
+		class ScopedLockAwaiter:
+			public LockAwaiter
+		{
+		public:
+			using LockAwaiter::LockAwaiter;
+
+			AsyncLockGuard await_resume() const noexcept;
+		};
+
+		AsyncMutex() noexcept = default;
+
+		AsyncMutex             (const AsyncMutex&) = delete;
+		AsyncMutex& operator = (const AsyncMutex&) = delete;
+		AsyncMutex             (AsyncMutex&&)      = delete;
+		AsyncMutex& operator = (AsyncMutex&&)      = delete;
+
+		bool              try_lock() noexcept;
+		LockAwaiter       lock()     noexcept; // co_await the result
+		ScopedLockAwaiter scoped_lock() noexcept; // same, producing an AsyncLockGuard
+		void              unlock()   noexcept;
+
+	private:
+		static constexpr uintptr_t k_NotLocked         = 1;
+		static constexpr uintptr_t k_LockedWithoutWait = 0;
+
+		std::atomic<uintptr_t> m_State   = k_NotLocked; // or a pointer to the most recent waiter
+		AsyncWaiter*           m_Waiters = nullptr;     // (oldest first, only touched by the owner)
+	};
+
+	// counting semaphore; release hands permits directly to waiting coroutines
+	// [NOTE] waiters are not necessarily resumed in FIFO order
+	class AsyncSemaphore {
+	public:
+		class AcquireAwaiter:
+			public AsyncWaiter
+		{
+		public:
+			explicit AcquireAwaiter(AsyncSemaphore& semaphore) noexcept;
+
+			bool await_ready() noexcept;
+			bool await_suspend(std::coroutine_handle<> awaiter) noexcept;
+			void await_resume() const noexcept;
+
+		private:
+			AsyncSemaphore& m_Semaphore;
+		};
+
+		explicit AsyncSemaphore(uint32_t num_permits) noexcept;
+
+		AsyncSemaphore             (const AsyncSemaphore&) = delete;
+		AsyncSemaphore& operator = (const AsyncSemaphore&) = delete;
+		AsyncSemaphore             (AsyncSemaphore&&)      = delete;
+		AsyncSemaphore& operator = (AsyncSemaphore&&)      = delete;
+
+		bool           try_acquire() noexcept;
+		AcquireAwaiter acquire()     noexcept; // co_await the result
+		void           release(uint32_t num_permits = 1) noexcept;
+
+		uint32_t get_num_permits() const noexcept; // only a snapshot; zero while there are waiters
+
+	private:
+		bool enqueue(AsyncWaiter* waiter) noexcept; // takes a permit or adds the waiter, returns false if it got a permit
+
+		// either a permit count (shifted left, with the lowest bit set) or a pointer to the most recent waiter
+		std::atomic<uintptr_t> m_State;
+	};
+
+	// manual-reset event; once set, all waiters are resumed and later waiters pass right through until reset
+	class AsyncEvent {
+	public:
+		class WaitAwaiter:
+			public AsyncWaiter
+		{
+		public:
+			explicit WaitAwaiter(const AsyncEvent& event) noexcept;
+
+			bool await_ready() const noexcept;
+			bool await_suspend(std::coroutine_handle<> awaiter) noexcept;
+			void await_resume() const noexcept;
+
+		private:
+			const AsyncEvent& m_Event;
+		};
+
+		explicit AsyncEvent(bool initially_set = false) noexcept;
+
+		AsyncEvent             (const AsyncEvent&) = delete;
+		AsyncEvent& operator = (const AsyncEvent&) = delete;
+		AsyncEvent             (AsyncEvent&&)      = delete;
+		AsyncEvent& operator = (AsyncEvent&&)      = delete;
+
+		WaitAwaiter wait() const noexcept; // co_await the result
+
+		void set()    noexcept;
+		void reset()  noexcept; // (no effect unless set)
+		bool is_set() const noexcept;
+
+	private:
+		// 'this' when set, otherwise a pointer to the most recent waiter (if any)
+		mutable std::atomic<const void*> m_State;
+	};
+
+	// single-use countdown; waiters are resumed once it reaches zero
+	class AsyncLatch {
+	public:
+		explicit AsyncLatch(uint32_t count) noexcept;
+
+		AsyncLatch             (const AsyncLatch&) = delete;
+		AsyncLatch& operator = (const AsyncLatch&) = delete;
+		AsyncLatch             (AsyncLatch&&)      = delete;
+		AsyncLatch& operator = (AsyncLatch&&)      = delete;
+
+		void count_down(uint32_t n = 1) noexcept;
+		bool is_ready() const noexcept;
+
+		AsyncEvent::WaitAwaiter wait() const noexcept; // co_await the result
+
+	private:
+		std::atomic<uint32_t> m_Count;
+		AsyncEvent            m_Event;
+	};
+}
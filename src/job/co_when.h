@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "co_job.h"
+
+namespace bop::job {
+	// (void results are represented by std::monostate)
+	template <typename T>
+	using CoResult = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+	// awaits a fixed set of CoJobs with possibly different result types, producing a tuple of results
+	//
+	// All jobs but the last are scheduled on the pool, the last one starts right away on the awaiting
+	// thread. The awaiting coroutine is resumed (via symmetric transfer) by whichever job completes last.
+	// The results are moved out of the completed jobs when resuming; if any of them failed, the first
+	// exception (in argument order) is rethrown instead.
+	template <typename... Ts>
+	class WhenAll final:
+		public CoJobLatch
+	{
+	public:
+		explicit WhenAll(CoJob<Ts>&&... jobs) noexcept;
+
+		WhenAll             (const WhenAll&) = delete;
+		WhenAll& operator = (const WhenAll&) = delete;
+		WhenAll             (WhenAll&&)      = delete;
+		WhenAll& operator = (WhenAll&&)      = delete;
+
+		bool                        await_ready() const noexcept;
+		std::coroutine_handle<>     await_suspend(std::coroutine_handle<> awaiter) noexcept;
+		std::tuple<CoResult<Ts>...> await_resume();
+
+	private:
+		std::coroutine_handle<> complete(std::coroutine_handle<> coroutine) noexcept override;
+
+		std::tuple<CoJob<Ts>...> m_Jobs;
+		std::atomic<uint32_t>    m_Remaining = 0;
+		std::coroutine_handle<>  m_Awaiter   = nullptr;
+	};
+
+	// same, for any number of CoJobs with the same result type, producing a vector (or nothing, for void)
+	template <typename T>
+	class WhenAllRange final:
+		public CoJobLatch
+	{
+	public:
+		using Result = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+
+		explicit WhenAllRange(std::vector<CoJob<T>> jobs) noexcept;
+
+		WhenAllRange             (const WhenAllRange&) = delete;
+		WhenAllRange& operator = (const WhenAllRange&) = delete;
+		WhenAllRange             (WhenAllRange&&)      = delete;
+		WhenAllRange& operator = (WhenAllRange&&)      = delete;
+
+		bool                    await_ready() const noexcept;
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept;
+		Result                  await_resume();
+
+	private:
+		std::coroutine_handle<> complete(std::coroutine_handle<> coroutine) noexcept override;
+
+		std::vector<CoJob<T>>   m_Jobs;
+		std::atomic<uint32_t>   m_Remaining = 0;
+		std::coroutine_handle<> m_Awaiter   = nullptr;
+	};
+
+	template <typename T>
+	struct WhenAnyResult {
+		size_t       m_Index; // of the job that completed first
+		CoResult<T>  m_Value;
+	};
+
+	// awaits the first of a set of CoJobs to complete, producing its index and result (or rethrowing its exception)
+	//
+	// The jobs are started like with when_all, the awaiting coroutine is resumed by the first one to
+	// complete. The others keep running to completion in the background; they share a small block
+	// (allocated from the memory resource of the current pool) that is released by whoever is done last.
+	template <typename T>
+	class WhenAny {
+	public:
+		explicit WhenAny(std::vector<CoJob<T>> jobs); // throws std::invalid_argument if there are no jobs
+		~WhenAny();
+
+		WhenAny             (const WhenAny&) = delete;
+		WhenAny& operator = (const WhenAny&) = delete;
+		WhenAny             (WhenAny&&)      = delete;
+		WhenAny& operator = (WhenAny&&)      = delete;
+
+		bool                    await_ready() const noexcept;
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept;
+		WhenAnyResult<T>        await_resume();
+
+	private:
+		class State final:
+			public CoJobLatch
+		{
+		public:
+			State(
+				std::vector<CoJob<T>>      jobs,
+				std::pmr::memory_resource* resource
+			) noexcept;
+
+			std::coroutine_handle<> complete(std::coroutine_handle<> coroutine) noexcept override;
+			void                    release() noexcept; // destroys the state (and all jobs) when it was the last reference
+
+			std::vector<CoJob<T>>      m_Jobs;
+			std::pmr::memory_resource* m_Resource;
+			std::atomic<uint32_t>      m_References = 0; // one per running job, plus one for the awaiter
+			std::atomic<void*>         m_First      = nullptr; // address of the job that completed first
+			std::coroutine_handle<>    m_Awaiter    = nullptr;
+		};
+
+		State* m_State = nullptr; // owned until awaited
+	};
+
+	template <typename... Ts>
+	WhenAll<Ts...> when_all(CoJob<Ts>&&... jobs) noexcept;
+
+	template <typename T>
+	WhenAllRange<T> when_all(std::vector<CoJob<T>> jobs) noexcept;
+
+	template <typename T>
+	WhenAny<T> when_any(std::vector<CoJob<T>> jobs);
+}
+
+#include "co_when.inl"
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "co_when.h"
+#include "job_system.h"
+#include "../util/scope_guard.h"
+
+#include <array>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace bop::job {
+	// moves the result out of a completed job (or rethrows its exception)
+	template <typename T>
+	CoResult<T> take_result(CoJob<T>& job) {
+		if constexpr (std::is_void_v<T>) {
+			job.await_resume();
+			return {};
+		}
+		else
+			return job.await_resume();
+	}
+
+	/***** WhenAll *****/
+	template <typename... Ts>
+	WhenAll<Ts...>::WhenAll(CoJob<Ts>&&... jobs) noexcept:
+		m_Jobs(std::move(jobs)...)
+	{
+	}
+
+	template <typename... Ts>
+	bool WhenAll<Ts...>::await_ready() const noexcept {
+		return sizeof...(Ts) == 0;
+	}
+
+	template <typename... Ts>
+	std::coroutine_handle<> WhenAll<Ts...>::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		if constexpr (sizeof...(Ts) == 0)
+			return awaiter;
+		else {
+			m_Remaining.store(sizeof...(Ts), std::memory_order::relaxed);
+			m_Awaiter = awaiter;
+
+			// gather everything first; once the last job was started this object may be gone
+			auto handles = std::apply(
+				[this](auto&... job) {
+					return std::array<std::coroutine_handle<>, sizeof...(Ts)>{
+						(job.get_handle().promise().m_Latch = this, job.get_handle())...
+					};
+				},
+				m_Jobs
+			);
+
+			for (size_t i = 0; i + 1 < handles.size(); ++i)
+				schedule_coroutine(handles[i]);
+
+			return handles.back();
+		}
+	}
+
+	template <typename... Ts>
+	std::tuple<CoResult<Ts>...> WhenAll<Ts...>::await_resume() {
+		// (braced initialization is evaluated in order, so the first exception wins)
+		return std::apply(
+			[](auto&... job) {
+				return std::tuple<CoResult<Ts>...>{ take_result(job)... };
+			},
+			m_Jobs
+		);
+	}
+
+	template <typename... Ts>
+	std::coroutine_handle<> WhenAll<Ts...>::complete(std::coroutine_handle<>) noexcept {
+		// (read before the decrement, the awaiter may clean up as soon as it's resumed)
+		std::coroutine_handle<> awaiter = m_Awaiter;
+
+		if (m_Remaining.fetch_sub(1, std::memory_order::acq_rel) == 1)
+			return awaiter;
+
+		return std::noop_coroutine();
+	}
+
+	/***** WhenAllRange *****/
+	template <typename T>
+	WhenAllRange<T>::WhenAllRange(std::vector<CoJob<T>> jobs) noexcept:
+		m_Jobs(std::move(jobs))
+	{
+	}
+
+	template <typename T>
+	bool WhenAllRange<T>::await_ready() const noexcept {
+		return m_Jobs.empty();
+	}
+
+	template <typename T>
+	std::coroutine_handle<> WhenAllRange<T>::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		m_Remaining.store(static_cast<uint32_t>(m_Jobs.size()), std::memory_order::relaxed);
+		m_Awaiter = awaiter;
+
+		for (auto& job : m_Jobs)
+			job.get_handle().promise().m_Latch = this;
+
+		// none of these can complete the group before the last one is started
+		std::coroutine_handle<> last = m_Jobs.back().get_handle();
+
+		for (size_t i = 0; i + 1 < m_Jobs.size(); ++i)
+			schedule_coroutine(m_Jobs[i].get_handle());
+
+		return last;
+	}
+
+	template <typename T>
+	typename WhenAllRange<T>::Result WhenAllRange<T>::await_resume() {
+		if constexpr (std::is_void_v<T>) {
+			for (auto& job : m_Jobs)
+				job.await_resume();
+		}
+		else {
+			std::vector<T> result;
+			result.reserve(m_Jobs.size());
+
+			for (auto& job : m_Jobs)
+				result.push_back(job.await_resume());
+
+			return result;
+		}
+	}
+
+	template <typename T>
+	std::coroutine_handle<> WhenAllRange<T>::complete(std::coroutine_handle<>) noexcept {
+		std::coroutine_handle<> awaiter = m_Awaiter;
+
+		if (m_Remaining.fetch_sub(1, std::memory_order::acq_rel) == 1)
+			return awaiter;
+
+		return std::noop_coroutine();
+	}
+
+	/***** WhenAny::State *****/
+	template <typename T>
+	WhenAny<T>::State::State(
+		std::vector<CoJob<T>>      jobs,
+		std::pmr::memory_resource* resource
+	) noexcept:
+		m_Jobs    (std::move(jobs)),
+		m_Resource(resource)
+	{
+	}
+
+	template <typename T>
+	std::coroutine_handle<> WhenAny<T>::State::complete(std::coroutine_handle<> coroutine) noexcept {
+		void* expected = nullptr;
+
+		bool is_first = m_First.compare_exchange_strong(
+			expected,
+			coroutine.address(),
+			std::memory_order::acq_rel
+		);
+
+		// (the awaiter holds a reference, so the state is still around if this was the first)
+		std::coroutine_handle<> awaiter = m_Awaiter;
+
+		release();
+
+		if (is_first)
+			return awaiter;
+
+		return std::noop_coroutine();
+	}
+
+	template <typename T>
+	void WhenAny<T>::State::release() noexcept {
+		if (m_References.fetch_sub(1, std::memory_order::acq_rel) != 1)
+			return;
+
+		// the last one out destroys all job frames (possibly including the one that is calling this)
+		std::pmr::memory_resource* resource = m_Resource;
+
+		this->~State();
+		resource->deallocate(this, sizeof(State), alignof(State));
+	}
+
+	/***** WhenAny *****/
+	template <typename T>
+	WhenAny<T>::WhenAny(std::vector<CoJob<T>> jobs) {
+		if (jobs.empty())
+			throw std::invalid_argument("when_any requires at least one job");
+
+		std::pmr::memory_resource* resource = JobSystem::get_current().get_memory_resource();
+
+		m_State = new (resource->allocate(sizeof(State), alignof(State))) State(std::move(jobs), resource);
+	}
+
+	template <typename T>
+	WhenAny<T>::~WhenAny() {
+		// never awaited, so none of the jobs were started
+		if (m_State) {
+			m_State->m_References.store(1, std::memory_order::relaxed);
+			m_State->release();
+		}
+	}
+
+	template <typename T>
+	bool WhenAny<T>::await_ready() const noexcept {
+		return false;
+	}
+
+	template <typename T>
+	std::coroutine_handle<> WhenAny<T>::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		// the awaiter may be resumed (and this object gone) as soon as the first job was started
+		State* state = m_State;
+
+		state->m_References.store(static_cast<uint32_t>(state->m_Jobs.size()) + 1, std::memory_order::relaxed);
+		state->m_Awaiter = awaiter;
+
+		for (auto& job : state->m_Jobs)
+			job.get_handle().promise().m_Latch = state;
+
+		// (jobs that haven't been started yet hold a reference, so the state stays put)
+		std::coroutine_handle<> last = state->m_Jobs.back().get_handle();
+
+		for (size_t i = 0; i + 1 < state->m_Jobs.size(); ++i)
+			schedule_coroutine(state->m_Jobs[i].get_handle());
+
+		return last;
+	}
+
+	template <typename T>
+	WhenAnyResult<T> WhenAny<T>::await_resume() {
+		State* state = std::exchange(m_State, nullptr);
+
+		auto guard = util::ScopeGuard([state] { state->release(); });
+
+		void* first = state->m_First.load(std::memory_order::acquire);
+
+		for (size_t i = 0; i < state->m_Jobs.size(); ++i)
+			if (state->m_Jobs[i].get_handle().address() == first)
+				return { i, take_result(state->m_Jobs[i]) };
+
+		throw std::logic_error("when_any was resumed without a completed job"); // (unreachable)
+	}
+
+	/***** free functions *****/
+	template <typename... Ts>
+	WhenAll<Ts...> when_all(CoJob<Ts>&&... jobs) noexcept {
+		return WhenAll<Ts...>(std::move(jobs)...);
+	}
+
+	template <typename T>
+	WhenAllRange<T> when_all(std::vector<CoJob<T>> jobs) noexcept {
+		return WhenAllRange<T>(std::move(jobs));
+	}
+
+	template <typename T>
+	WhenAny<T> when_any(std::vector<CoJob<T>> jobs) {
+		return WhenAny<T>(std::move(jobs));
+	}
+}
@@ -1,4 +1,5 @@
 #include "job.h"
+#include "job_system.h"
 
 #include <iostream>
 #include <format>
@@ -22,11 +23,28 @@ namespace bop::job {
 		m_NumChildren  = 1;
 		m_Next         = nullptr;
 		m_Parent       = nullptr;
-		m_Continuation = nullptr;
+		m_ThreadIndex  = k_AnyThread;
+		m_Continuation.store(nullptr, std::memory_order::relaxed);
+		m_HasWaiters.store(false, std::memory_order::relaxed);
+		m_NumRefs.store(0, std::memory_order::relaxed);
+		m_Awaiter      = nullptr;
 	}
 
 	void Job::wait() noexcept {
-		while (m_NumChildren != 0)
-			std::this_thread::yield();
+		m_System->wait(*this);
+	}
+
+	Job* Job::continue_with(Job* continuation) noexcept {
+		// if this job has already been executed, nobody else is going to pick up the continuation
+		Job* expected = nullptr;
+
+		if (!m_Continuation.compare_exchange_strong(
+			expected, 
+			continuation, 
+			std::memory_order::acq_rel
+		))
+			m_System->submit(continuation);
+
+		return continuation;
 	}
 }
\ No newline at end of file
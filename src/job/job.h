@@ -1,17 +1,28 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <chrono>
+#include <coroutine>
 #include <functional>
 #include <memory_resource>
 #include <optional>
 
+#include "job_priority.h"
+#include "../util/inline_function.h"
+
 namespace bop::job {
-	class Job {
+	class JobSystem;
+	class AwaitableJob;
+
+	// a job is exactly two cachelines; the first holds everything the scheduler touches, 
+	// the second the (inline) callable
+	class alignas(64) Job {
 	public:
 		friend class JobSystem;
+		friend class AwaitableJob;
 		friend class JobQueue;
-		friend class JobQueueNonThreadsafe;
+		friend class JobDeque;
 
 		// (pmr allocation/deallocation is done in JobSystem)
 		Job() = default;
@@ -19,23 +30,43 @@ namespace bop::job {
 		void operator()() noexcept;
 
 		void reset() noexcept;
-		void wait() noexcept; // block until the job was executed. Please only use this for unit tests
+		void wait() noexcept; // blocks until this job and its children completed (see JobSystem::wait)
 
-		// monoidal continuation
+		// monoidal continuation (defined in job_system.inl, it needs the complete pool)
 		inline Job& then(
-			std::invocable auto&&   work,
-			std::optional<uint32_t> thread_index = std::nullopt
+			std::invocable auto&&     work,
+			std::optional<uint32_t>   thread_index = std::nullopt,
+			std::optional<e_Priority> priority     = std::nullopt // by default the same as this job
 		) noexcept;
 
+		// captures up to this size are stored in the job itself, larger ones are allocated from the pool's memory resource
+		using Work = util::InlineFunction<void(), 64>;
+
 	protected:
+		// marks the continuation slot of a job that already ran, a late then() schedules right away
+		static inline Job* const k_Executed = reinterpret_cast<Job*>(uintptr_t(1));
+
+		static constexpr uint32_t k_AnyThread = ~0u;
+
+		// publishes a continuation that was constructed but not scheduled yet (so it can be held or retained
+		// first, see AwaitableJob and JobSystem::retain). If this job ran already, it's scheduled right away
+		Job* continue_with(Job* continuation) noexcept;
+
+		Job*                    m_Next           = nullptr; // intrusive singly linked
 		std::atomic<uint32_t>   m_NumChildren    = 1;
+		uint32_t                m_ThreadIndex    = k_AnyThread;
 		Job*                    m_Parent         = nullptr;
-		Job*                    m_Continuation   = nullptr;
-		Job*                    m_Next           = nullptr; // intrusive singly linked
-		std::optional<uint32_t> m_ThreadIndex    = std::nullopt;
+		std::atomic<Job*>       m_Continuation   = nullptr; // k_Executed once the job ran
+		JobSystem*              m_System         = nullptr; // the pool that owns this job
+		e_Priority              m_Priority       = e_Priority::normal;
+		std::atomic<bool>       m_HasWaiters     = false;   // set by threads that are parked in JobSystem::wait
+		std::atomic<uint16_t>   m_NumRefs        = 0;       // 0 unless it was handed out by schedule or then (see JobSystem::retain)
+		std::coroutine_handle<> m_Awaiter        = nullptr; // resumed once the job and its children completed (see AwaitableJob)
+
+		std::chrono::high_resolution_clock::time_point m_QueuedAt; // (only tracked when profiling)
 
-		std::function<void()>   m_Work;
+		alignas(64) Work        m_Work;
 	};
-}
 
-#include "job.inl"
\ No newline at end of file
+	static_assert(sizeof(Job) == 128);
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "job_awaitable.h"
+#include "job.h"
+#include "job_system.h"
+
+#include <cassert>
+
+namespace bop::job {
+	AwaitableJob::AwaitableJob(Job* held) noexcept:
+		m_Job(held)
+	{
+	}
+
+	AwaitableJob::~AwaitableJob() {
+		release();
+	}
+
+	AwaitableJob::AwaitableJob(AwaitableJob&& aj) noexcept:
+		m_Job(std::exchange(aj.m_Job, nullptr))
+	{
+	}
+
+	AwaitableJob& AwaitableJob::operator = (AwaitableJob&& aj) noexcept {
+		if (this != &aj) {
+			release();
+			m_Job = std::exchange(aj.m_Job, nullptr);
+		}
+
+		return *this;
+	}
+
+	Job& AwaitableJob::get_job() const noexcept {
+		assert(m_Job);
+		return *m_Job;
+	}
+
+	void AwaitableJob::wait() noexcept {
+		assert(m_Job);
+
+		// the job never completes while held, so its counter only gets down to the hold itself
+		// (which keeps it from being recycled while we look at it)
+		m_Job->m_System->wait_until(m_Job->m_NumChildren, 1, m_Job);
+
+		release();
+	}
+
+	bool AwaitableJob::await_ready() const noexcept {
+		return false; // (await_suspend figures it out, the hold has to be released either way)
+	}
+
+	bool AwaitableJob::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		Job* job = std::exchange(m_Job, nullptr); // the hold is released here
+
+		// published by releasing the hold; whoever completes the job afterwards schedules the awaiter
+		job->m_Awaiter = awaiter;
+
+		if (job->m_NumChildren.fetch_sub(1, std::memory_order::acq_rel) > 1)
+			return true;
+
+		// the job had completed already, so finish it here and carry on without suspending
+		job->m_Awaiter = nullptr;
+		job->m_System->finish(job);
+
+		return false;
+	}
+
+	void AwaitableJob::await_resume() const noexcept {
+	}
+
+	void AwaitableJob::release() noexcept {
+		if (m_Job)
+			m_Job->m_System->job_completed(std::exchange(m_Job, nullptr));
+	}
+}
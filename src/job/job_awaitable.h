@@ -0,0 +1,53 @@
+#pragma once
+
+#include <concepts>
+#include <coroutine>
+#include <cstdint>
+#include <optional>
+
+#include "job_priority.h"
+
+namespace bop::job {
+	class Job;
+
+	// a scheduled job that a coroutine can co_await
+	//
+	// The job is held (it counts as one of its own children) until it is awaited or the AwaitableJob is
+	// dropped, so it cannot be recycled in the meantime -- awaiting a job that already completed simply
+	// doesn't suspend. While held, it is also safe to use as the parent of other jobs, which makes it
+	// the natural way for a coroutine to fan out work. The awaiting coroutine is resumed on the pool
+	// once the job and all of its children completed, without blocking a worker in the meantime.
+	class [[nodiscard]] AwaitableJob {
+	public:
+		AwaitableJob() noexcept = default;
+		explicit AwaitableJob(Job* held) noexcept;
+		~AwaitableJob(); // releases the hold if the job wasn't awaited
+
+		AwaitableJob             (const AwaitableJob&) = delete;
+		AwaitableJob& operator = (const AwaitableJob&) = delete;
+		AwaitableJob             (AwaitableJob&& aj) noexcept;
+		AwaitableJob& operator = (AwaitableJob&& aj) noexcept;
+
+		// monoidal continuation, which can be awaited in turn (defined in job_system.inl, it needs the complete pool)
+		inline AwaitableJob then(
+			std::invocable auto&&     work,
+			std::optional<uint32_t>   thread_index = std::nullopt,
+			std::optional<e_Priority> priority     = std::nullopt // by default the same as this job
+		);
+
+		Job& get_job() const noexcept;
+
+		// blocks until the job and all of its children completed, then drops the hold. Workers keep
+		// executing queued jobs in the meantime, other threads park
+		void wait() noexcept;
+
+		bool await_ready() const noexcept;
+		bool await_suspend(std::coroutine_handle<> awaiter) noexcept; // false if the job completed already
+		void await_resume() const noexcept;
+
+	private:
+		void release() noexcept;
+
+		Job* m_Job = nullptr;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "job_deque.h"
+#include "job.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace bop::job {
+	/***** Buffer *****/
+	JobDeque::Buffer::Buffer(int64_t capacity):
+		m_Capacity(capacity),
+		m_Mask    (capacity - 1),
+		m_Slots   (std::make_unique<std::atomic<Job*>[]>(static_cast<size_t>(capacity)))
+	{
+	}
+
+	Job* JobDeque::Buffer::get(int64_t index) const noexcept {
+		return m_Slots[index & m_Mask].load(std::memory_order::relaxed);
+	}
+
+	void JobDeque::Buffer::put(int64_t index, Job* work) noexcept {
+		m_Slots[index & m_Mask].store(work, std::memory_order::relaxed);
+	}
+
+	/***** JobDeque *****/
+	JobDeque::JobDeque(uint32_t initial_capacity) {
+		if (initial_capacity < 2)
+			initial_capacity = 2;
+
+		m_Buffers.push_back(std::make_unique<Buffer>(std::bit_ceil(initial_capacity)));
+		m_Buffer.store(m_Buffers.back().get(), std::memory_order::relaxed);
+	}
+
+	void JobDeque::push(Job* work) {
+		int64_t bottom = m_Bottom.load(std::memory_order::relaxed);
+		int64_t top    = m_Top.load(std::memory_order::acquire);
+		Buffer* buffer = m_Buffer.load(std::memory_order::relaxed);
+
+		if (bottom - top > buffer->m_Capacity - 1) [[unlikely]]
+			buffer = grow(buffer, top, bottom);
+
+		buffer->put(bottom, work);
+
+		// publish the slot before the new bottom becomes visible to thieves
+		std::atomic_thread_fence(std::memory_order::release);
+		m_Bottom.store(bottom + 1, std::memory_order::relaxed);
+	}
+
+	void JobDeque::push_chain(Job* head, uint32_t count) {
+		int64_t bottom = m_Bottom.load(std::memory_order::relaxed);
+		int64_t top    = m_Top.load(std::memory_order::acquire);
+		Buffer* buffer = m_Buffer.load(std::memory_order::relaxed);
+
+		while (bottom - top + count > buffer->m_Capacity) [[unlikely]]
+			buffer = grow(buffer, top, bottom);
+
+		for (Job* work = head; work && (count > 0); work = work->m_Next, --count)
+			buffer->put(bottom++, work);
+
+		// a single publication for the entire chain
+		std::atomic_thread_fence(std::memory_order::release);
+		m_Bottom.store(bottom, std::memory_order::relaxed);
+	}
+
+	Job* JobDeque::pop() {
+		int64_t bottom = m_Bottom.load(std::memory_order::relaxed) - 1;
+		Buffer* buffer = m_Buffer.load(std::memory_order::relaxed);
+
+		// reserve the bottom slot first, then see if any thief got there before us
+		m_Bottom.store(bottom, std::memory_order::relaxed);
+		std::atomic_thread_fence(std::memory_order::seq_cst);
+
+		int64_t top = m_Top.load(std::memory_order::relaxed);
+
+		if (top > bottom) {
+			// was already empty, restore
+			m_Bottom.store(bottom + 1, std::memory_order::relaxed);
+			return nullptr;
+		}
+
+		Job* result = buffer->get(bottom);
+
+		if (top == bottom) {
+			// last remaining entry; race against thieves for it
+			if (!m_Top.compare_exchange_strong(
+				top,
+				top + 1,
+				std::memory_order::seq_cst,
+				std::memory_order::relaxed
+			))
+				result = nullptr; // a thief won
+
+			m_Bottom.store(bottom + 1, std::memory_order::relaxed);
+		}
+
+		return result;
+	}
+
+	Job* JobDeque::steal() {
+		int64_t top = m_Top.load(std::memory_order::acquire);
+		std::atomic_thread_fence(std::memory_order::seq_cst);
+		int64_t bottom = m_Bottom.load(std::memory_order::acquire);
+
+		if (top >= bottom)
+			return nullptr;
+
+		// [NOTE] this should be a consume load, acquire is what compilers currently emit anyway
+		Buffer* buffer = m_Buffer.load(std::memory_order::acquire);
+		Job*    result = buffer->get(top);
+
+		if (!m_Top.compare_exchange_strong(
+			top,
+			top + 1,
+			std::memory_order::seq_cst,
+			std::memory_order::relaxed
+		))
+			return nullptr; // lost the race against the owner or another thief
+
+		return result;
+	}
+
+	uint32_t JobDeque::steal_half(
+		JobDeque& destination,
+		Job*&     first,
+		uint32_t  max_count
+	) {
+		// claiming several slots with a single CAS would race with the owner, which only does a CAS for 
+		// the very last entry -- so claim them one by one, bounded by what was queued up at the start
+		uint32_t batch = std::min((size() + 1) / 2, max_count);
+
+		first = (batch > 0) ? 
+			steal() : 
+			nullptr;
+
+		if (!first)
+			return 0;
+
+		uint32_t result = 1;
+
+		for (; result < batch; ++result) {
+			Job* work = steal();
+			if (!work)
+				break;
+
+			destination.push(work);
+		}
+
+		return result;
+	}
+
+	uint32_t JobDeque::size() const noexcept {
+		int64_t bottom = m_Bottom.load(std::memory_order::relaxed);
+		int64_t top    = m_Top.load(std::memory_order::relaxed);
+
+		return (bottom > top) ?
+			static_cast<uint32_t>(bottom - top) :
+			0;
+	}
+
+	bool JobDeque::empty() const noexcept {
+		return size() == 0;
+	}
+
+	JobDeque::Buffer* JobDeque::grow(
+		Buffer* current,
+		int64_t top,
+		int64_t bottom
+	) {
+		auto bigger = std::make_unique<Buffer>(current->m_Capacity * 2);
+
+		for (int64_t i = top; i < bottom; ++i)
+			bigger->put(i, current->get(i));
+
+		// the old buffer is retired but not released; a thief may still be reading from it
+		Buffer* result = bigger.get();
+		m_Buffers.push_back(std::move(bigger));
+		m_Buffer.store(result, std::memory_order::release);
+
+		return result;
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../util/cacheline.h"
+
+namespace bop::job {
+	class Job;
+
+	// lock-free work-stealing deque, non-owning (Chase-Lev)
+	//
+	// The owning worker pushes and pops at the bottom (LIFO) without any atomic read-modify-write
+	// operations; other threads steal from the top (FIFO) with a single CAS. The ring buffer grows
+	// when needed, retired buffers are kept alive until the deque is destroyed because a thief may
+	// still be reading from them.
+	//
+	// based on 'Correct and Efficient Work-Stealing for Weak Memory Models' (Le, Pop, Cohen, Zappa Nardelli - 2013)
+	class JobDeque {
+	public:
+		static constexpr uint32_t k_DefaultCapacity = 1 << 8;
+
+		explicit JobDeque(uint32_t initial_capacity = k_DefaultCapacity); // rounded up to a power of two
+
+		JobDeque             (const JobDeque&) = delete;
+		JobDeque& operator = (const JobDeque&) = delete;
+		JobDeque             (JobDeque&&)      = delete;
+		JobDeque& operator = (JobDeque&&)      = delete;
+
+		// NOTE only the owning thread may push/pop
+		void push(Job* work);
+		void push_chain(Job* head, uint32_t count); // pushes a chain of jobs linked via Job::m_Next, publishing them all at once
+		Job* pop(); // returns nullptr if there's nothing to return
+
+		// may be called from any thread
+		Job* steal(); // returns nullptr if there's nothing to steal, or if another thread won the race
+
+		// takes up to half of the queued jobs (at most max_count), the oldest one is returned and the rest 
+		// is pushed into 'destination', which must be owned by the calling thread. Returns the number of jobs taken
+		uint32_t steal_half(
+			JobDeque& destination, 
+			Job*&     first, 
+			uint32_t  max_count = ~0u
+		);
+
+		uint32_t size()  const noexcept; // only a snapshot when other threads are active
+		bool     empty() const noexcept;
+
+	private:
+		struct Buffer {
+			explicit Buffer(int64_t capacity);
+
+			Job* get(int64_t index) const noexcept;
+			void put(int64_t index, Job* work) noexcept;
+
+			int64_t                              m_Capacity;
+			int64_t                              m_Mask;
+			std::unique_ptr<std::atomic<Job*>[]> m_Slots;
+		};
+
+		Buffer* grow(Buffer* current, int64_t top, int64_t bottom);
+
+		// top is written by thieves, bottom only by the owner -- keep them on separate cachelines
+		alignas(util::hardware_destructive_interference_size) std::atomic<int64_t> m_Top    = 0;
+		alignas(util::hardware_destructive_interference_size) std::atomic<int64_t> m_Bottom = 0;
+
+		std::atomic<Buffer*>                 m_Buffer;
+		std::vector<std::unique_ptr<Buffer>> m_Buffers; // current and retired buffers (only modified by the owner)
+	};
+}
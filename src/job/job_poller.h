@@ -0,0 +1,27 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+
+namespace bop::job {
+	// a source of outside events (I/O completions and such) that the workers of a pool take care of
+	//
+	// Workers poll() in between jobs every so often, and whenever they run out of work. While something
+	// is pending, one of the parked workers blocks in wait() instead of sleeping as usual; the pool
+	// interrupts it when new work is queued up that nobody else is around for (or when it shuts down).
+	// See JobSystem::get_poller.
+	class Poller {
+	public:
+		using Clock     = std::chrono::steady_clock;
+		using Timepoint = Clock::time_point;
+
+		virtual ~Poller() = default;
+
+		virtual bool poll()       noexcept = 0;       // handles whatever is ready without blocking, false if nothing was
+		virtual bool is_pending() const noexcept = 0; // true while there's something to wait for
+
+		// blocks until something may be ready, until the deadline passed or until interrupted
+		virtual void wait(std::optional<Timepoint> deadline) noexcept = 0;
+		virtual void interrupt() noexcept = 0; // makes the current wait return (or else the next one)
+	};
+}
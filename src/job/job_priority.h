@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace bop::job {
+	// workers drain higher priority classes first; background jobs still get a guaranteed share
+	enum class e_Priority: uint8_t {
+		critical,
+		normal,
+		background
+	};
+
+	static constexpr uint32_t k_NumPriorities = 3;
+}
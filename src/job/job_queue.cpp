@@ -23,6 +23,26 @@ namespace bop::job {
 		m_Lock.clear(std::memory_order::release);
 	}
 
+	void JobQueue::push_chain(Job* head, Job* tail, uint32_t count) {
+		while (m_Lock.test_and_set(std::memory_order::acquire));
+
+		tail->m_Next = nullptr; // cut off whatever followed the chain
+
+		if (!m_Head)
+			m_Head = head;
+
+		if (!m_Tail)
+			m_Tail = tail;
+		else {
+			m_Tail->m_Next = head;
+			m_Tail = tail;
+		}
+
+		m_NumEntries += count;
+
+		m_Lock.clear(std::memory_order::release);
+	}
+
 	Job* JobQueue::pop() {
 		while (m_Lock.test_and_set(std::memory_order::acquire));
 
@@ -65,52 +85,4 @@ namespace bop::job {
 
 		return result;
 	}
-
-	void JobQueueNonThreadsafe::push(Job* work) {
-		work->m_Next = nullptr;
-
-		if (!m_Head)
-			m_Head = work;
-
-		if (!m_Tail)
-			m_Tail = work;
-		else {
-			// single link push
-			m_Tail->m_Next = work;
-			m_Tail = work;
-		}
-
-		++m_NumEntries;
-	}
-
-	Job* JobQueueNonThreadsafe::pop() {
-		auto* result = m_Head;
-
-		if (result) {
-			// single link pop
-			m_Head = result->m_Next;
-			--m_NumEntries;
-
-			if (result == m_Tail)
-				m_Tail = nullptr;
-		}
-
-		return result;
-	}
-
-	uint32_t JobQueueNonThreadsafe::clear() {
-		uint32_t result = m_NumEntries;
-
-		m_Head       = nullptr;
-		m_Tail       = nullptr;
-		m_NumEntries = 0;
-
-		return result;
-	}
-
-	uint32_t JobQueueNonThreadsafe::size() {
-		uint32_t result = m_NumEntries;
-
-		return result;
-	}
 }
\ No newline at end of file
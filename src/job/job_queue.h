@@ -22,6 +22,7 @@ namespace bop::job {
 		// NOTE push/pop mechanics are non-owning!
 		//      by using pointers we also support derived types
 		void push(Job* work);
+		void push_chain(Job* head, Job* tail, uint32_t count); // splice a pre-linked chain of jobs (tail inclusive)
 		Job* pop(); // returns nullptr if there's nothing to return
 
 		uint32_t clear(); // returns the number of jobs cleared
@@ -36,24 +37,4 @@ namespace bop::job {
 
 		uint32_t m_NumEntries = 0;
 	};
-
-	// very similar design, but this one doesn't have locking
-	// the non-owning nature actually makes this copyable 
-	// (you probably shouldn't though)
-	class JobQueueNonThreadsafe {
-	public:
-		JobQueueNonThreadsafe() = default;
-
-		void push(Job* work);
-		Job* pop(); // returns nullptr if there's nothing to return
-
-		uint32_t clear(); // returns the number of jobs cleared
-		uint32_t size();  // returns the number of jobs currently in the queue
-
-	private:
-		Job* m_Head = nullptr;
-		Job* m_Tail = nullptr;
-
-		uint32_t m_NumEntries = 0;
-	};
 }
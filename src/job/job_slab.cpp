@@ -0,0 +1,185 @@
+#include "job_slab.h"
+#include "job.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace bop::job {
+	static_assert(sizeof(Job)  <= JobSlab::k_SlotSize);
+	static_assert(alignof(Job) <= JobSlab::k_SlotSize);
+	static_assert(JobSlab::k_ChunkSize % JobSlab::k_SlotSize == 0);
+
+	/***** Chunk *****/
+	std::byte* JobSlab::Chunk::slot(uint32_t index) noexcept {
+		return reinterpret_cast<std::byte*>(this) + (index + 1) * k_SlotSize;
+	}
+
+	/***** JobSlab *****/
+	JobSlab::JobSlab(
+		std::pmr::memory_resource* resource,
+		SlabFootprint*             footprint
+	):
+		m_Resource (resource),
+		m_Footprint(footprint)
+	{
+	}
+
+	JobSlab::~JobSlab() {
+		while (m_Chunks) {
+			Chunk* next = m_Chunks->m_Next;
+			m_Resource->deallocate(m_Chunks, k_ChunkSize, k_ChunkSize);
+			m_Chunks = next;
+		}
+
+		if (m_Footprint)
+			m_Footprint->m_Current.fetch_sub(uint64_t(m_NumChunks) * k_ChunkSize, std::memory_order::relaxed);
+	}
+
+	void* JobSlab::allocate() {
+		if (!m_LocalFree)
+			collect_remote();
+
+		if (!m_LocalFree)
+			add_chunk();
+
+		FreeSlot* result = m_LocalFree;
+		m_LocalFree = result->m_Next;
+
+		++chunk_of(result)->m_NumLive;
+		m_PeakLive = std::max(m_PeakLive, ++m_NumLive);
+
+		return result;
+	}
+
+	void JobSlab::free_local(void* job) {
+		assert(owner_of(job) == this);
+
+		m_LocalFree = new (job) FreeSlot{ m_LocalFree };
+
+		--chunk_of(job)->m_NumLive;
+		--m_NumLive;
+	}
+
+	void JobSlab::free_remote(void* job) {
+		FreeSlot* slot = new (job) FreeSlot{ m_RemoteFree.load(std::memory_order::relaxed) };
+
+		// (push only; the owner takes the entire list at once, so there's no ABA problem)
+		while (!m_RemoteFree.compare_exchange_weak(
+			slot->m_Next,
+			slot,
+			std::memory_order::release,
+			std::memory_order::relaxed
+		));
+	}
+
+	uint32_t JobSlab::trim() {
+		collect_remote();
+
+		// keep enough to cover the demand since the previous trim, hand back any empty chunk beyond that
+		uint32_t needed = (m_PeakLive + k_SlotsPerChunk - 1) / k_SlotsPerChunk + k_SpareChunks;
+
+		m_PeakLive = m_NumLive;
+
+		if (m_NumChunks <= needed)
+			return 0;
+
+		uint32_t num_released = 0;
+
+		for (Chunk* chunk = m_Chunks; chunk && (m_NumChunks - num_released > needed); chunk = chunk->m_Next)
+			if (chunk->m_NumLive == 0) {
+				chunk->m_Released = true;
+				++num_released;
+			}
+
+		if (num_released == 0)
+			return 0;
+
+		// the free slots of the released chunks have to go
+		FreeSlot** link = &m_LocalFree;
+
+		while (*link)
+			if (chunk_of(*link)->m_Released)
+				*link = (*link)->m_Next;
+			else
+				link = &(*link)->m_Next;
+
+		for (Chunk** chunk = &m_Chunks; *chunk;)
+			if ((*chunk)->m_Released) {
+				Chunk* released = *chunk;
+				*chunk = released->m_Next;
+
+				m_Resource->deallocate(released, k_ChunkSize, k_ChunkSize);
+			}
+			else
+				chunk = &(*chunk)->m_Next;
+
+		m_NumChunks -= num_released;
+
+		if (m_Footprint)
+			m_Footprint->m_Current.fetch_sub(uint64_t(num_released) * k_ChunkSize, std::memory_order::relaxed);
+
+		return num_released;
+	}
+
+	JobSlab* JobSlab::owner_of(const void* job) noexcept {
+		return chunk_of(job)->m_Owner;
+	}
+
+	uint32_t JobSlab::get_num_chunks() const noexcept {
+		return m_NumChunks;
+	}
+
+	uint32_t JobSlab::get_num_live() const noexcept {
+		return m_NumLive;
+	}
+
+	JobSlab::Chunk* JobSlab::chunk_of(const void* job) noexcept {
+		// chunks are aligned to their size
+		return reinterpret_cast<Chunk*>(reinterpret_cast<uintptr_t>(job) & ~uintptr_t(k_ChunkSize - 1));
+	}
+
+	void JobSlab::add_chunk() {
+		void* memory = m_Resource->allocate(k_ChunkSize, k_ChunkSize);
+
+		Chunk* chunk = new (memory) Chunk{
+			.m_Owner    = this,
+			.m_Next     = m_Chunks,
+			.m_NumLive  = 0,
+			.m_Released = false
+		};
+
+		m_Chunks = chunk;
+		++m_NumChunks;
+
+		// carve it up right away, in address order
+		for (uint32_t i = k_SlotsPerChunk; i > 0; --i)
+			m_LocalFree = new (chunk->slot(i - 1)) FreeSlot{ m_LocalFree };
+
+		if (m_Footprint) {
+			uint64_t current = m_Footprint->m_Current.fetch_add(k_ChunkSize, std::memory_order::relaxed) + k_ChunkSize;
+			uint64_t peak    = m_Footprint->m_Peak.load(std::memory_order::relaxed);
+
+			while (
+				(peak < current) &&
+				!m_Footprint->m_Peak.compare_exchange_weak(peak, current, std::memory_order::relaxed)
+			);
+		}
+	}
+
+	void JobSlab::collect_remote() noexcept {
+		FreeSlot* slot = m_RemoteFree.exchange(nullptr, std::memory_order::acquire);
+
+		while (slot) {
+			FreeSlot* next = slot->m_Next;
+
+			slot->m_Next = m_LocalFree;
+			m_LocalFree  = slot;
+
+			--chunk_of(slot)->m_NumLive;
+			--m_NumLive;
+
+			slot = next;
+		}
+	}
+}
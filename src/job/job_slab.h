@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+#include "../util/cacheline.h"
+
+namespace bop::job {
+	// bytes obtained from the memory resource by all slabs of a pool
+	struct SlabFootprint {
+		std::atomic<uint64_t> m_Current = 0;
+		std::atomic<uint64_t> m_Peak    = 0;
+	};
+
+	// allocator for job memory, owned by a single thread
+	//
+	// Jobs are carved from fixed-size chunks that are aligned to their size, so the owning slab can be
+	// found from the address of any job. The owner allocates and frees without atomic operations; other
+	// threads hand jobs back through a lock-free list that the owner collects when it runs out. trim()
+	// returns chunks that are unused (and not needed to cover recent demand) to the memory resource.
+	class JobSlab {
+	public:
+		static constexpr size_t   k_ChunkSize     = 1 << 14;
+		static constexpr size_t   k_SlotSize      = 128;     // a single job
+		static constexpr uint32_t k_SlotsPerChunk = static_cast<uint32_t>(k_ChunkSize / k_SlotSize) - 1; // (the first slot holds the chunk header)
+		static constexpr uint32_t k_SpareChunks   = 1;       // kept around on top of what recent demand requires
+
+		explicit JobSlab(
+			std::pmr::memory_resource* resource,
+			SlabFootprint*             footprint = nullptr // if set, chunk allocations are accounted here
+		);
+		~JobSlab(); // releases all chunks, whether there are live jobs in them or not
+
+		JobSlab             (const JobSlab&) = delete;
+		JobSlab& operator = (const JobSlab&) = delete;
+		JobSlab             (JobSlab&&)      = delete;
+		JobSlab& operator = (JobSlab&&)      = delete;
+
+		// NOTE only the owning thread may allocate, free_local or trim
+		void*    allocate();            // uninitialized memory for a single job
+		void     free_local(void* job); // (the job must have been destroyed already)
+		uint32_t trim();                // returns the number of chunks that were released
+
+		// may be called from any thread
+		void            free_remote(void* job);
+		static JobSlab* owner_of(const void* job) noexcept;
+
+		uint32_t get_num_chunks() const noexcept; // only a snapshot when other threads are active
+		uint32_t get_num_live()   const noexcept; // allocated jobs, including those in the remote list
+
+	private:
+		struct FreeSlot {
+			FreeSlot* m_Next;
+		};
+
+		struct Chunk {
+			JobSlab* m_Owner;
+			Chunk*   m_Next;
+			uint32_t m_NumLive;  // slots that are neither in the local free list nor uncollected in the remote list
+			bool     m_Released;
+
+			std::byte* slot(uint32_t index) noexcept;
+		};
+
+		static Chunk* chunk_of(const void* job) noexcept;
+
+		void add_chunk();
+		void collect_remote() noexcept; // moves remotely freed jobs into the local free list
+
+		std::pmr::memory_resource* m_Resource;
+		SlabFootprint*             m_Footprint;
+
+		Chunk*    m_Chunks    = nullptr;
+		uint32_t  m_NumChunks = 0;
+		FreeSlot* m_LocalFree = nullptr;
+		uint32_t  m_NumLive   = 0;
+		uint32_t  m_PeakLive  = 0; // since the last trim
+
+		alignas(util::hardware_destructive_interference_size) std::atomic<FreeSlot*> m_RemoteFree = nullptr;
+	};
+}
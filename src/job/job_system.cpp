@@ -1,64 +1,199 @@
 #include "job_system.h"
 #include "job.h"
+#include "../util/platform.h"
 
 #include <nlohmann/json.hpp>
 
+#include <cassert>
 #include <iostream>
 #include <fstream>
 #include <format>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if BOP_PLATFORM == BOP_PLATFORM_WINDOWS
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <sched.h>
+#endif
 
 namespace bop::job {
-	JobSystem::JobSystem(
-		std::optional<uint32_t> num_threads,
-		MemoryResource*         memory_resource
-	) noexcept {
-		// make sure that the system is initialized just once
-		// (we're initializing static variables via a non-static object construction)
-		{
-			if (m_InitOnce > 0)
-				[[likely]]
-				return;
+	namespace {
+		// names the calling thread and optionally pins it to a single cpu
+		void setup_worker_thread(
+			uint32_t                thread_index,
+			std::optional<uint32_t> cpu
+		) {
+			std::string name = "bop worker " + std::to_string(thread_index);
+
+#if BOP_PLATFORM == BOP_PLATFORM_WINDOWS
+			SetThreadDescription(GetCurrentThread(), std::wstring(name.begin(), name.end()).c_str());
+
+			if (cpu) {
+				bool pinned = 
+					(*cpu < sizeof(DWORD_PTR) * 8) &&
+					(SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << *cpu) != 0);
+
+				if (!pinned)
+					std::cerr << std::format("Failed to pin worker {} to cpu {}\n", thread_index, *cpu);
+			}
+#else
+			name.resize(std::min<size_t>(name.size(), 15)); // linux limits thread names to 16 characters (including the terminator)
+			pthread_setname_np(pthread_self(), name.c_str());
+
+			if (cpu) {
+				bool pinned = false;
+
+				if (*cpu < CPU_SETSIZE) {
+					cpu_set_t cpus;
 
-			uint64_t count = m_InitOnce.fetch_add(1);
-			if (count > 0)
-				return;
+					CPU_ZERO(&cpus);
+					CPU_SET(*cpu, &cpus);
+
+					pinned = (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0);
+				}
+
+				if (!pinned)
+					std::cerr << std::format("Failed to pin worker {} to cpu {}\n", thread_index, *cpu);
+			}
+#endif
 		}
+	}
 
-		// initalize (static) members
-		m_MemoryResource = memory_resource;
+	JobSystem::JobSystem(
+		std::optional<uint32_t> num_threads,
+		MemoryResource*         memory_resource,
+		std::optional<uint32_t> queue_capacity,
+		e_Placement             placement,
+		std::vector<uint32_t>   cpu_list
+	) noexcept:
+		m_MemoryResource(memory_resource),
+		m_Placement     (placement),
+		m_QueueCapacity (queue_capacity)
+	{
+		switch (placement) {
+		case e_Placement::none:           break;
+		case e_Placement::compact:        m_WorkerCpus = util::CpuTopology::detect().compact_order();       break;
+		case e_Placement::scatter:        m_WorkerCpus = util::CpuTopology::detect().scatter_order();       break;
+		case e_Placement::physical_cores: m_WorkerCpus = util::CpuTopology::detect().physical_core_order(); break;
+		case e_Placement::explicit_list:  m_WorkerCpus = std::move(cpu_list);                              break;
+		}
 
-		if (!num_threads) 
-			m_NumThreads = std::thread::hardware_concurrency(); // default to hardware concurrency count
-		else
+		if (num_threads)
 			m_NumThreads = *num_threads;
+		else if (!m_WorkerCpus.empty())
+			m_NumThreads = static_cast<uint32_t>(m_WorkerCpus.size()); // a worker per selected cpu
+		else
+			m_NumThreads = std::thread::hardware_concurrency(); // default to hardware concurrency count
 
 		if (m_NumThreads == 0)
 			m_NumThreads = 1; // always have at least one worker
 
+		m_StartingWorkers = m_NumThreads;
+		m_ActiveWorkers   = m_NumThreads;
+
 		m_ApplicationStart = Clock::now();
 
 		// initialize queue logic for all worker threads
 		// sadness - the semantics of vector 
-		m_GlobalQueues = std::make_unique<JobQueue[]>(m_NumThreads);
-		m_LocalQueues  = std::make_unique<JobQueue[]>(m_NumThreads);
-		m_Mutexes      = std::make_unique<std::mutex[]>(m_NumThreads);
+		uint32_t num_queues = m_NumThreads * k_NumPriorities;
+
+		m_GlobalQueues     = std::make_unique<JobDeque[]>(num_queues);
+		m_SubmissionQueues = std::make_unique<JobQueue[]>(num_queues);
+		m_LocalQueues      = std::make_unique<JobQueue[]>(num_queues);
+		m_ExternalSlab     = std::make_unique<JobSlab>(memory_resource, &m_SlabFootprint);
+		m_StealCounters    = std::make_unique<StealCounters[]>(m_NumThreads);
+		m_FrameAllocator   = std::make_unique<CoFrameAllocator>(*this, memory_resource, m_NumThreads);
+
+		for (uint32_t i = 0; i < m_NumThreads; ++i)
+			m_Slabs.push_back(std::make_unique<JobSlab>(memory_resource, &m_SlabFootprint));
+
+		if (m_QueueCapacity)
+			for (uint32_t i = 0; i < num_queues; ++i)
+				m_SubmissionRings.push_back(std::make_unique<JobRing>(*m_QueueCapacity));
 
 		m_Traces.resize(m_NumThreads, TraceLog(memory_resource));
 
-		// launch and detach worker threads
-		for (uint32_t i = 0; i < m_NumThreads; ++i) {
+		// the first pool becomes the default one
+		JobSystem* no_default = nullptr;
+		m_DefaultSystem.compare_exchange_strong(no_default, this);
+
+		// launch worker threads
+		for (uint32_t i = 0; i < m_NumThreads; ++i)
 			m_WorkerThreads.push_back(std::thread(
 				&JobSystem::worker, 
 				this, 
 				i // thread index
 			));
+	}
+
+	JobSystem::~JobSystem() {
+		shutdown();
+
+		for (auto& t : m_WorkerThreads)
+			if (t.joinable()) {
+				assert(t.get_id() != std::this_thread::get_id()); // a pool cannot be destroyed by one of its own jobs
+				t.join();
+			}
+
+		// the workers have all stopped, so whatever is left may be released from here
+		m_Timers.clear();
+
+		// (operations that are still pending are abandoned, whoever awaits them is never resumed)
+		for (auto& slot : m_Pollers)
+			slot.m_Poller.reset();
+
+		for (uint32_t i = 0; i < m_NumThreads * k_NumPriorities; ++i) {
+			deallocate_job_queue(m_GlobalQueues[i]);
+			deallocate_job_queue(m_SubmissionQueues[i]);
+			if (m_QueueCapacity)
+				deallocate_job_queue(*m_SubmissionRings[i]);
+			deallocate_job_queue(m_LocalQueues[i]);
+		}
+
+		// (frames that outlive the pool keep its allocator around)
+		CoFrameAllocator::retire(std::move(m_FrameAllocator));
+
+		JobSystem* self = this;
+		m_DefaultSystem.compare_exchange_strong(self, nullptr);
+	}
+
+	JobSystem& JobSystem::get_default() {
+		if (JobSystem* result = m_DefaultSystem.load(std::memory_order::acquire))
+			[[likely]]
+			return *result;
+
+		// nothing was set up explicitly, use a pool with default settings
+		// (which registers itself as the default, unless some other pool got there first)
+		static JobSystem fallback;
+
+		if (JobSystem* result = m_DefaultSystem.load(std::memory_order::acquire))
+			return *result;
 
-			m_WorkerThreads[i].detach();
-		}		
+		return fallback;
+	}
+
+	JobSystem& JobSystem::get_current() {
+		if (l_CurrentSystem)
+			return *l_CurrentSystem;
+
+		return get_default();
+	}
+
+	JobSystem* JobSystem::find_current() noexcept {
+		return l_CurrentSystem;
 	}
 
 	void JobSystem::shutdown() noexcept {
 		m_Shutdown.store(true);
+		m_Parking.notify_all();
+		interrupt_pollers();
 	}
 
 	void JobSystem::wait_for_shutdown() noexcept {
@@ -73,131 +208,570 @@ namespace bop::job {
 
 		// at some point, there's no more task dependencies remaining
 		if (remaining <= 1) { 
-			if (job->m_Parent)
-				job_completed(job->m_Parent);
-
-			recycle(job);
-			
+			finish(job);
 			return true; // this job was fully completed
 		}
 
+		// only the hold of a waiting thread is left, which is still around to be told (see AwaitableJob::wait)
+		// (seq_cst, pairs with the flag and the recheck there)
+		if ((remaining == 2) && job->m_HasWaiters.load(std::memory_order::seq_cst))
+			m_Completions.notify_all();
+
 		return false; // more stuff to do
 	}
 
+	void JobSystem::finish(Job* job) noexcept {
+		if (job->m_Parent)
+			job_completed(job->m_Parent);
+
+		std::coroutine_handle<> awaiter  = job->m_Awaiter;
+		e_Priority              priority = job->m_Priority;
+
+		// a waiting thread holds a reference, so the job is still around when it's told
+		// (seq_cst, pairs with the flag and the recheck in wait_until)
+		if (job->m_HasWaiters.load(std::memory_order::seq_cst))
+			m_Completions.notify_all();
+
+		release(job);
+
+		// the awaiting coroutine continues in a job of its own, at the same priority
+		if (awaiter)
+			submit(construct(
+				[awaiter] { awaiter.resume(); },
+				nullptr,
+				std::nullopt,
+				priority
+			));
+	}
+
 	void JobSystem::worker(uint32_t thread_index) noexcept {
-		constexpr uint32_t k_LoopsUntilGC = 1 << 8;
+		constexpr uint32_t k_SpinRounds = 1 << 6; // attempts to find work before parking
 
-		thread_local static uint32_t l_no_work_counter = 0;
+		l_ThreadIndex   = thread_index;
+		l_CurrentSystem = this;
+		l_RandomState   = (thread_index + 1) * 0x9E3779B9u; // (never zero)
 
-		l_ThreadIndex = thread_index;
+		setup_worker_thread(thread_index, get_worker_cpu(thread_index));
 
 		// wait until all threads are started
 		{
 			using namespace std::chrono_literals;
 
-			static std::atomic<uint32_t> remaining_workers = m_NumThreads.load();
-
-			remaining_workers.fetch_sub(1);
+			m_StartingWorkers.fetch_sub(1);
 
-			while (remaining_workers.load() > 0)
+			while (m_StartingWorkers.load() > 0)
 				std::this_thread::sleep_for(10ms);
 		}
 
-		// set up work-stealing indices
-		uint32_t steal_from = (thread_index + 1) % m_NumThreads.load();
-
-		std::unique_lock lock(m_Mutexes[l_ThreadIndex]);
-
 		// main execution loop -- do work until we're shutting down
 		while (!m_Shutdown) {
-			// prioritize local queue over the global one (should have less contention)
-			l_CurrentJob = m_LocalQueues[l_ThreadIndex].pop();
+			Job* work = find_work();
+
+			// the timers and pollers are checked every so often while busy, and whenever we ran out of work
+			if (!work || ((l_NumSearches % k_PollInterval) == 0))
+				if ((expire_timers() | poll_events()) && !work) // (both)
+					work = find_work();
+
+			// spin for a bit before going to sleep; submitters won't wake anyone while we're spinning
+			if (!work) {
+				m_NumSpinning.fetch_add(1);
+
+				for (
+					uint32_t round = 0; 
+					!work && (round < k_SpinRounds) && !m_Shutdown; 
+					++round
+				) {
+					std::this_thread::yield();
+					work = find_work();
+				}
 
-			if (!l_CurrentJob)
-				l_CurrentJob = m_GlobalQueues[l_ThreadIndex].pop();
+				// if the last spinner found something, another worker should take over spinning
+				// (submitters may have skipped a wakeup because of us)
+				if ((m_NumSpinning.fetch_sub(1) == 1) && work)
+					m_Parking.notify_one();
+			}
 
-			// if we still don't have any work yet try to steal it from another global queue
-			uint32_t numStealAttempts = m_NumThreads - 1;
-			while (!l_CurrentJob && (--numStealAttempts > 0)) {
-				if (++steal_from >= m_NumThreads)
-					steal_from = 0;
+			if (!work) {
+				// about to sleep, so this is a good time to hand back some memory
+				m_Slabs[l_ThreadIndex]->trim();
+
+				if (m_ExternalSlabLock.try_lock()) {
+					m_ExternalSlab->trim();
+					m_ExternalSlabLock.unlock();
+				}
 
-				l_CurrentJob = m_GlobalQueues[steal_from].pop();
+				// announce that we're parking first, then check once more
+				auto key = m_Parking.prepare_wait();
+
+				if (m_Shutdown)
+					m_Parking.cancel_wait();
+				else if ((work = find_work()))
+					m_Parking.cancel_wait();
+				else if (expire_timers() | poll_events())
+					m_Parking.cancel_wait(); // (whatever expired or completed was queued up, it's picked up next round)
+				else
+					work = park(key);
 			}
 
-			// if we have a job, execute it; while there are continuations
-			// available, perform those as well (avoiding context switches)
-			while (l_CurrentJob) {
-				Timepoint job_start;
+			if (work)
+				execute(work);
+		} // end of execution loop
 
-				if constexpr (k_EnableProfiling) {
-					job_start = Clock::now();
-				}
+		// we're outside of the execution loop; shutdown was triggered.
+		// Remaining queued jobs are released when the pool is destroyed
+		if (Job* retained = std::exchange(l_RetainedJob, nullptr))
+			release(retained);
 
-				// before doing the work, remember if this was a regular function or a coroutine
-				// (in the coro case the job may destroy itself)
-				(*l_CurrentJob)(); // do the actual work
-				
-				if constexpr (k_EnableProfiling) {
-					store_trace(
-						job_start,
-						Clock::now(),
-						l_ThreadIndex
-					);
-				}
+		l_CurrentSystem = nullptr;
 
-				l_no_work_counter = 0;
-				
-				// do notifications, recycling and/or 
-				// see if we have a continuation and if so, traverse down the chain
-				Job* continuation = l_CurrentJob->m_Continuation;
-
-				if (continuation) {
-					// propagate the 'parent' job to the continuation
-					if (l_CurrentJob->m_Parent) {
-						l_CurrentJob->m_Parent->m_NumChildren++;
-						continuation->m_Parent = l_CurrentJob->m_Parent;
-					}
-				}
+		// the last worker may save the trace report
+		uint32_t active_workers = m_ActiveWorkers.fetch_sub(1);
+		if (active_workers == 1) {
+			if constexpr (k_EnableProfiling) {
+				save_tracelog();
+			}
+
+			m_ShutdownComplete = true;
+		}
+	}
+
+	// a node per delayed job, which is only submitted once it expires
+	class JobSystem::DelayedJob final:
+		public TimerNode
+	{
+	public:
+		DelayedJob(JobSystem& system, Job* work) noexcept:
+			m_System(&system),
+			m_Work  (work)
+		{
+		}
 
-				job_completed(l_CurrentJob);
+		void expire() noexcept override {
+			JobSystem* system = m_System;
+			Job*       work   = m_Work;
 
-				l_CurrentJob = continuation;
+			release();
+			system->submit(work);
+		}
+
+		void discard() noexcept override {
+			JobSystem* system = m_System;
+			Job*       work   = m_Work;
+
+			release();
+			system->recycle(work);
+		}
+
+	private:
+		void release() noexcept {
+			std::pmr::polymorphic_allocator<>(m_System->m_MemoryResource).delete_object(this);
+		}
+
+		JobSystem* m_System;
+		Job*       m_Work;
+	};
+
+	void JobSystem::start_delayed(Job* work, TimerWheel::Timepoint deadline) {
+		auto timer = std::pmr::polymorphic_allocator<>(m_MemoryResource).new_object<DelayedJob>(*this, work);
+
+		add_timer(*timer, deadline);
+	}
+
+	void JobSystem::add_timer(TimerNode& node, TimerWheel::Timepoint deadline) noexcept {
+		uint64_t tick = m_Timers.add(&node, deadline);
+
+		// (seq_cst, pairs with the compare-exchange in park) if nobody watches the timers any parked
+		// worker will do, otherwise the watcher has to wake up earlier than it planned to
+		uint64_t watched = m_TimerWatch.load(std::memory_order::seq_cst);
+
+		// (workers that are blocked in a poller aren't parked on the event count)
+		if (tick < watched) {
+			if (watched != TimerWheel::k_Never) {
+				m_Parking.notify_all();
+				interrupt_pollers();
 			}
-			
-			// if we still don't have work for a long time we may try reclaiming some memory
-			if (++l_no_work_counter > k_LoopsUntilGC) [[unlikely]] {
-				using namespace std::chrono_literals;
+			else if (m_Parking.get_num_waiters() > 0)
+				m_Parking.notify_one();
+			else
+				interrupt_pollers();
+		}
+	}
+
+	bool JobSystem::expire_timers() noexcept {
+		if (m_Timers.empty()) [[likely]]
+			return false;
+
+		TimerNode* expired = m_Timers.advance(TimerWheel::Clock::now());
 
-				l_GarbageBin.clear();
-				m_WaitCondition.wait_for(lock, 100ms);
+		if (!expired)
+			return false;
 
-				l_no_work_counter /= 2; // it's not like this worker is hot, so don't reset the counter entirely
+		while (expired) {
+			TimerNode* next = expired->m_Next; // (expiring may release the node)
+
+			expired->expire();
+			expired = next;
+		}
+
+		return true;
+	}
+
+	bool JobSystem::poll_events() noexcept {
+		bool any = false;
+
+		for (uint32_t i = 0, n = m_NumPollers.load(std::memory_order::acquire); i < n; ++i)
+			any |= m_Pollers[i].m_Poller->poll();
+
+		return any;
+	}
+
+	void JobSystem::interrupt_pollers() noexcept {
+		// (seq_cst, pairs with the announcement in park)
+		if (m_NumBlocked.load(std::memory_order::seq_cst) == 0)
+			[[likely]]
+			return;
+
+		for (uint32_t i = 0, n = m_NumPollers.load(std::memory_order::acquire); i < n; ++i)
+			if (m_Pollers[i].m_Blocked.load(std::memory_order::seq_cst))
+				m_Pollers[i].m_Poller->interrupt();
+	}
+
+	Job* JobSystem::park(util::EventCount::Key key) noexcept {
+		// a single parked worker watches the timers, sleeping until the next one is due
+		uint64_t due      = m_Timers.next_expiry();
+		uint64_t none     = TimerWheel::k_Never;
+		bool     watching = (due != TimerWheel::k_Never) && m_TimerWatch.compare_exchange_strong(none, due);
+
+		std::optional<TimerWheel::Timepoint> deadline;
+
+		if (watching)
+			deadline = m_Timers.to_timepoint(due);
+
+		// while a poller has something pending, a worker blocks in there instead (a single one per poller)
+		PollerSlot* claimed = nullptr;
+
+		for (uint32_t i = 0, n = m_NumPollers.load(std::memory_order::acquire); (i < n) && !claimed; ++i)
+			if (
+				m_Pollers[i].m_Poller->is_pending() &&
+				!m_Pollers[i].m_Blocked.exchange(true, std::memory_order::seq_cst)
+			)
+				claimed = &m_Pollers[i];
+
+		Job* work        = nullptr;
+		bool woken_early = false; // (by something other than the timer that is watched)
+
+		if (claimed) {
+			m_Parking.cancel_wait();
+
+			// announce first, then check once more; whoever queues work after this interrupts the poller
+			m_NumBlocked.fetch_add(1, std::memory_order::seq_cst);
+
+			if (!m_Shutdown.load(std::memory_order::seq_cst) && !(work = find_work())) {
+				claimed->m_Poller->wait(deadline);
+				claimed->m_Poller->poll();
 			}
-		} // end of execution loop
 
-		// we're outside of the execution loop; shutdown was triggered so do cleanup this workers' resources
-		deallocate_job_queue(m_GlobalQueues[l_ThreadIndex]);
-		deallocate_job_queue(m_LocalQueues[l_ThreadIndex]);
-		deallocate_job_queue(l_RecyclingBin);
-		deallocate_job_queue(l_GarbageBin);
-		
-		// the last worker may save the trace report
-		uint32_t active_workers = m_NumThreads.fetch_sub(1);
-		if (active_workers == 1) {
+			m_NumBlocked.fetch_sub(1, std::memory_order::seq_cst);
+			claimed->m_Blocked.store(false, std::memory_order::release);
+
+			woken_early = work || (deadline && (TimerWheel::Clock::now() < *deadline));
+		}
+		else if (watching)
+			woken_early = m_Parking.wait_until(key, *deadline);
+		else
+			m_Parking.wait(key);
+
+		if (watching) {
+			m_TimerWatch.store(TimerWheel::k_Never);
+
+			// woken up for something else, so someone else should take over watching
+			if (woken_early && !m_Timers.empty())
+				m_Parking.notify_one();
+		}
+
+		return work;
+	}
+
+	Poller* JobSystem::find_poller(const void* type) const noexcept {
+		for (uint32_t i = 0, n = m_NumPollers.load(std::memory_order::acquire); i < n; ++i)
+			if (m_Pollers[i].m_Type == type)
+				return m_Pollers[i].m_Poller.get();
+
+		return nullptr;
+	}
+
+	Poller& JobSystem::add_poller(const void* type, std::unique_ptr<Poller> poller) {
+		uint32_t n = m_NumPollers.load(std::memory_order::relaxed);
+
+		if (n == k_MaxPollers)
+			throw std::length_error("Too many kinds of pollers");
+
+		m_Pollers[n].m_Type   = type;
+		m_Pollers[n].m_Poller = std::move(poller);
+
+		// (publishes the slot)
+		m_NumPollers.store(n + 1, std::memory_order::release);
+
+		return *m_Pollers[n].m_Poller;
+	}
+
+	void JobSystem::notify_poller_pending() noexcept {
+		// a parked worker comes around and blocks in the poller
+		m_Parking.notify_one();
+	}
+
+	Job* JobSystem::find_work() noexcept {
+		// normally the highest priority class goes first. To avoid starvation, every so often
+		// one of the lower classes gets to go first instead (taking turns)
+		uint32_t first = 0;
+
+		if ((++l_NumSearches % k_AgingInterval) == 0) [[unlikely]]
+			first = 1 + (l_NumSearches / k_AgingInterval) % (k_NumPriorities - 1);
+
+		if (Job* work = find_work(static_cast<e_Priority>(first)))
+			return work;
+
+		for (uint32_t i = 0; i < k_NumPriorities; ++i)
+			if (i != first)
+				if (Job* work = find_work(static_cast<e_Priority>(i)))
+					return work;
+
+		return nullptr;
+	}
+
+	Job* JobSystem::find_work(e_Priority priority) noexcept {
+		uint32_t own = queue_index(l_ThreadIndex, priority);
+
+		// prioritize local queue over the global one (should have less contention)
+		Job* work = m_LocalQueues[own].pop();
+
+		// our own deque is uncontended unless someone is stealing from it
+		if (!work)
+			work = m_GlobalQueues[own].pop();
+
+		if (!work)
+			work = pop_submission(l_ThreadIndex, priority);
+
+		// if we still don't have any work yet try to steal it from another worker
+		if (!work && (m_NumThreads > 1))
+			work = steal_work(priority);
+
+		return work;
+	}
+
+	Job* JobSystem::steal_work(e_Priority priority) noexcept {
+		// power of two choices; of two random victims, go for the one with the most work queued up
+		uint32_t a = random_victim();
+		uint32_t b = random_victim();
+
+		uint32_t victim = (
+			m_GlobalQueues[queue_index(a, priority)].size() >= 
+			m_GlobalQueues[queue_index(b, priority)].size()
+		) ? a : b;
+
+		if (Job* work = steal_from(victim, priority))
+			return work;
+
+		// work may be concentrated in just a few queues, so before giving up go over all of them 
+		// (starting at a random one to avoid convoys)
+		uint32_t start = random_victim();
+
+		for (uint32_t i = 0; i < m_NumThreads; ++i) {
+			victim = (start + i) % m_NumThreads;
+
+			if (victim == l_ThreadIndex)
+				continue;
+
+			if (Job* work = steal_from(victim, priority))
+				return work;
+
+			if (Job* work = pop_submission(victim, priority))
+				return work;
+		}
+
+		return nullptr;
+	}
+
+	Job* JobSystem::steal_from(
+		uint32_t   victim, 
+		e_Priority priority
+	) noexcept {
+		auto& counters = m_StealCounters[l_ThreadIndex];
+		auto& own      = m_GlobalQueues[queue_index(l_ThreadIndex, priority)];
+
+		// (only this worker writes its counters, no need for read-modify-write)
+		auto bump = [](std::atomic<uint64_t>& counter, uint64_t amount) {
+			counter.store(counter.load(std::memory_order::relaxed) + amount, std::memory_order::relaxed);
+		};
+
+		bump(counters.m_Attempts, 1);
+
+		// don't let the stolen jobs overflow a bounded deque
+		uint32_t max_count = ~0u;
+
+		if (m_QueueCapacity)
+			max_count = 1 + ((own.size() < *m_QueueCapacity) ? 
+				*m_QueueCapacity - own.size() : 
+				0
+			);
+
+		Job*     work      = nullptr;
+		uint32_t num_moved = m_GlobalQueues[queue_index(victim, priority)].steal_half(own, work, max_count);
+
+		if (num_moved > 0) {
+			bump(counters.m_Successes, 1);
+			bump(counters.m_JobsMoved, num_moved);
+
+			// the remainder is up for grabs by our idle peers as well
+			if (num_moved > 1)
+				wake_workers(num_moved - 1);
+		}
+
+		return work;
+	}
+
+	uint32_t JobSystem::random_victim() noexcept {
+		// xorshift32
+		l_RandomState ^= l_RandomState << 13;
+		l_RandomState ^= l_RandomState >> 17;
+		l_RandomState ^= l_RandomState << 5;
+
+		// skip over ourselves
+		uint32_t result = l_RandomState % (m_NumThreads - 1);
+
+		if (result >= l_ThreadIndex)
+			++result;
+
+		return result;
+	}
+
+	JobMemoryUsage JobSystem::get_job_memory_usage() const noexcept {
+		return JobMemoryUsage {
+			.m_Current = m_SlabFootprint.m_Current.load(std::memory_order::relaxed),
+			.m_Peak    = m_SlabFootprint.m_Peak   .load(std::memory_order::relaxed)
+		};
+	}
+
+	StealStats JobSystem::get_steal_stats(uint32_t thread_index) const noexcept {
+		const auto& counters = m_StealCounters[thread_index];
+
+		return StealStats {
+			.m_Attempts  = counters.m_Attempts .load(std::memory_order::relaxed),
+			.m_Successes = counters.m_Successes.load(std::memory_order::relaxed),
+			.m_JobsMoved = counters.m_JobsMoved.load(std::memory_order::relaxed)
+		};
+	}
+
+	void JobSystem::wake_workers(uint32_t num_jobs) noexcept {
+		// make sure the queued work is visible before looking at the spinners
+		std::atomic_thread_fence(std::memory_order::seq_cst);
+
+		// a spinning worker will pick it up (and wakes up another one when it does)
+		if (m_NumSpinning.load(std::memory_order::seq_cst) > 0)
+			return;
+
+		// (no syscall if nobody is parked)
+		if (num_jobs > 1)
+			m_Parking.notify_all();
+		else
+			m_Parking.notify_one();
+
+		// workers that are blocked in a poller aren't parked on the event count; if there's nobody
+		// else to take the work, one of those should
+		if (m_Parking.get_num_waiters() == 0)
+			interrupt_pollers();
+	}
+
+	void JobSystem::execute(Job* job) noexcept {
+		Job* previous = l_CurrentJob; // (may be nested when a worker executes a job from within another job)
+
+		l_CurrentJob = job;
+
+		// while there are continuations available, perform those as well (avoiding context switches)
+		while (l_CurrentJob) {
+			Timepoint job_start;
+
 			if constexpr (k_EnableProfiling) {
-				save_tracelog();
+				job_start = Clock::now();
 			}
 
-			m_ShutdownComplete = true;
+			(*l_CurrentJob)(); // do the actual work
+			l_CurrentJob->m_Work = nullptr; // release the captures (and any spilled storage) right away
+				
+			if constexpr (k_EnableProfiling) {
+				store_trace(
+					*l_CurrentJob,
+					job_start,
+					Clock::now(),
+					l_ThreadIndex
+				);
+			}
+				
+			// do notifications, recycling and/or 
+			// see if we have a continuation and if so, traverse down the chain
+			Job* continuation = l_CurrentJob->m_Continuation.exchange(Job::k_Executed, std::memory_order::acq_rel);
+
+			if (continuation) {
+				// the continuation is executed right away, it didn't have to wait in a queue
+				if constexpr (k_EnableProfiling) {
+					continuation->m_QueuedAt = Clock::now();
+				}
+
+				// propagate the 'parent' job to the continuation
+				if (l_CurrentJob->m_Parent) {
+					l_CurrentJob->m_Parent->m_NumChildren++;
+					continuation->m_Parent = l_CurrentJob->m_Parent;
+				}
+			}
+
+			job_completed(l_CurrentJob);
+
+			l_CurrentJob = continuation;
+		}
+
+		l_CurrentJob = previous;
+	}
+
+	void JobSystem::retain(Job* work) noexcept {
+		// a reference for the scheduler and one for the thread (nobody else can see the job yet)
+		work->m_NumRefs.store(2, std::memory_order::relaxed);
+
+		Job* previous = nullptr;
+
+		if (is_worker())
+			previous = std::exchange(l_RetainedJob, work);
+		else {
+			std::scoped_lock guard(m_ExternalRetainedLock);
+			previous = std::exchange(m_ExternalRetained[std::this_thread::get_id()], work);
 		}
+
+		if (previous)
+			release(previous);
+	}
+
+	void JobSystem::release(Job* work) noexcept {
+		// (a job that was never handed out is only referred to by the scheduler, which is the common case)
+		if (
+			(work->m_NumRefs.load(std::memory_order::relaxed) == 0) ||
+			(work->m_NumRefs.fetch_sub(1, std::memory_order::acq_rel) == 1)
+		)
+			recycle(work);
 	}
 
 	void JobSystem::recycle(Job* work) noexcept {
-		if (l_RecyclingBin.size() <= k_RecyclingCapacity)
-			l_RecyclingBin.push(work); // tag for re-use
+		std::destroy_at(work);
+
+		// back to the slab it came from; only the owning worker may skip the remote list
+		JobSlab* owner = JobSlab::owner_of(work);
+
+		if (is_worker() && (owner == m_Slabs[l_ThreadIndex].get()))
+			owner->free_local(work);
 		else
-			l_GarbageBin.push(work); // tag as garbage
+			owner->free_remote(work);
+	}
+
+	bool JobSystem::is_worker() const noexcept {
+		return l_CurrentSystem == this;
 	}
 
 	uint32_t JobSystem::get_thread_index() const noexcept {
@@ -212,78 +786,319 @@ namespace bop::job {
 		return m_MemoryResource;
 	}
 
+	CoFrameAllocator& JobSystem::get_frame_allocator() noexcept {
+		return *m_FrameAllocator;
+	}
+
+	std::optional<uint32_t> JobSystem::get_queue_capacity() const noexcept {
+		return m_QueueCapacity;
+	}
+
+	e_Placement JobSystem::get_placement() const noexcept {
+		return m_Placement;
+	}
+
+	std::optional<uint32_t> JobSystem::get_worker_cpu(uint32_t thread_index) const noexcept {
+		if (m_WorkerCpus.empty())
+			return std::nullopt;
+
+		return m_WorkerCpus[thread_index % m_WorkerCpus.size()];
+	}
+
 	Job* JobSystem::create_job() {
-		// first see if we have anything we can recycle
-		Job* result = l_RecyclingBin.pop();
+		void* memory = nullptr;
+
+		if (is_worker())
+			memory = m_Slabs[l_ThreadIndex]->allocate();
+		else {
+			std::scoped_lock guard(m_ExternalSlabLock);
+			memory = m_ExternalSlab->allocate();
+		}
+
+		return std::construct_at(static_cast<Job*>(memory));
+	}
+
+	// (jobs that were never executed may still hold a callable, recycling destroys them properly)
+	void JobSystem::deallocate_job_queue(JobQueue& jq) {
+		for (auto* job = jq.pop(); job; job = jq.pop())
+			recycle(job);
+
+		jq.clear();
+	}
+
+	void JobSystem::deallocate_job_queue(JobDeque& jq) {
+		// (only the owning worker should do this)
+		for (auto* job = jq.pop(); job; job = jq.pop())
+			recycle(job);
+	}
 
-		if (!result) {
-			// do an actual allocation in that case
-			JobAllocator allocator(m_MemoryResource);
+	void JobSystem::deallocate_job_queue(JobRing& jq) {
+		for (Job* job = nullptr; jq.try_pop(job);)
+			recycle(job);
+	}
 
-			result = allocator.allocate(1);
+	void JobSystem::submit(Job* work) noexcept {
+		// if the queues are bounded and full, workers execute the job themselves
+		// while other threads wait for some room to become available
+		while (!schedule_work(work)) [[unlikely]] {
+			if (is_worker()) {
+				execute(work);
+				break;
+			}
+			else
+				std::this_thread::yield();
+		}
+	}
 
-			if (!result) {
-				std::cerr << "Failed to allocate a job\n";
-				std::terminate();
+	bool JobSystem::schedule_work(Job* work) noexcept {
+		if constexpr (k_EnableProfiling) {
+			work->m_QueuedAt = Clock::now();
+		}
+
+		// if no specific execution thread was set, workers push into their own deque (other workers
+		// will steal it if they're idle), other threads plonk it in any of the submission queues
+		// (a thread index that is out of range counts as 'any thread')
+		if (work->m_ThreadIndex >= m_NumThreads) {
+			bool scheduled = false;
+
+			if (
+				is_worker() && (
+					!m_QueueCapacity ||
+					(m_GlobalQueues[queue_index(l_ThreadIndex, work->m_Priority)].size() < *m_QueueCapacity)
+				)
+			) {
+				m_GlobalQueues[queue_index(l_ThreadIndex, work->m_Priority)].push(work);
+				scheduled = true;
 			}
+			else
+				scheduled = push_submission(work); // (a worker with a full deque may still find room here)
+
+			if (scheduled)
+				wake_workers(1);
+
+			return scheduled;
+		}
+
+		// if a specific execution thread was set, plonk it in the appropriate local queue.
+		// Only that worker can run it, and we can't tell which one gets woken up; so wake them all
+		// (including the one that may be blocked in a poller, that isn't parked on the event count)
+		m_LocalQueues[queue_index(work->m_ThreadIndex, work->m_Priority)].push(work);
+		
+		std::atomic_thread_fence(std::memory_order::seq_cst);
+		m_Parking.notify_all();
+		interrupt_pollers();
+
+		return true;
+	}
+
+	void JobSystem::schedule_chain(
+		Job*     head, 
+		Job*     tail, 
+		uint32_t count
+	) noexcept {
+		// (all jobs in a chain have the same priority)
+		e_Priority priority = head->m_Priority;
+
+		if constexpr (k_EnableProfiling) {
+			Timepoint now = Clock::now();
+
+			for (Job* work = head; work != tail; work = work->m_Next)
+				work->m_QueuedAt = now;
 
-			allocator.construct(result);
+			tail->m_QueuedAt = now;
+		}
+
+		if (
+			is_worker() && (
+				!m_QueueCapacity ||
+				(m_GlobalQueues[queue_index(l_ThreadIndex, priority)].size() + count <= *m_QueueCapacity)
+			)
+		)
+			// idle workers will steal parts of the chain
+			m_GlobalQueues[queue_index(l_ThreadIndex, priority)].push_chain(head, count);
+		else if (!m_QueueCapacity) {
+			// spread the chain over the submission queues, one lock acquisition per queue
+			uint32_t per_queue = (count + m_NumThreads - 1) / m_NumThreads;
+
+			while (head) {
+				Job*     segment_tail = head;
+				uint32_t segment_size = 1;
+
+				while ((segment_size < per_queue) && (segment_tail != tail)) {
+					segment_tail = segment_tail->m_Next;
+					++segment_size;
+				}
+
+				Job* next = (segment_tail == tail) ? 
+					nullptr : 
+					segment_tail->m_Next;
+
+				m_SubmissionQueues[queue_index(next_submission_index(), priority)].push_chain(head, segment_tail, segment_size);
+
+				head = next;
+			}
 		}
 		else {
-			result->reset(); // re-use a previously allocated job
+			// the rings have no splicing operation, so these are pushed one by one.
+			// When full, the same policy as in schedule() applies
+			while (head) {
+				Job* next = (head == tail) ? 
+					nullptr : 
+					head->m_Next;
+
+				while (!push_submission(head)) [[unlikely]] {
+					wake_workers(count);
+
+					if (is_worker()) {
+						execute(head);
+						break;
+					}
+					else
+						std::this_thread::yield();
+				}
+
+				head = next;
+			}
 		}
 
-		return result;
+		// coalesced wakeup
+		wake_workers(count);
 	}
 
-	void JobSystem::deallocate_job_queue(JobQueue& jq) {
-		JobAllocator allocator(m_MemoryResource);
+	bool JobSystem::push_submission(Job* work) noexcept {
+		if (!m_QueueCapacity) {
+			m_SubmissionQueues[queue_index(next_submission_index(), work->m_Priority)].push(work);
 
-		for (auto* job = jq.pop(); job; job = jq.pop()) {
-			//allocator.destroy(job); // jobs don't have destructors, no need
-			allocator.deallocate(job, 1);
+			return true;
 		}
 
-		jq.clear();
+		// bounded; try every ring once before reporting that everything is full
+		for (uint32_t attempt = 0; attempt < m_NumThreads; ++attempt)
+			if (m_SubmissionRings[queue_index(next_submission_index(), work->m_Priority)]->try_push(work))
+				return true;
+
+		return false;
 	}
 
-	void JobSystem::deallocate_job_queue(JobQueueNonThreadsafe& jq) {
-		JobAllocator allocator(m_MemoryResource);
+	Job* JobSystem::pop_submission(
+		uint32_t   thread_index, 
+		e_Priority priority
+	) noexcept {
+		uint32_t idx = queue_index(thread_index, priority);
 
-		for (auto* job = jq.pop(); job; job = jq.pop()) {
-			//allocator.destroy(job); // jobs don't have destructors, no need
-			allocator.deallocate(job, 1);
-		}
+		if (!m_QueueCapacity)
+			return m_SubmissionQueues[idx].pop();
 
-		jq.clear();
+		Job* result = nullptr;
+		m_SubmissionRings[idx]->try_pop(result);
+
+		return result;
 	}
 
-	bool JobSystem::schedule_work(Job* work) noexcept {
-		static thread_local uint32_t tidx(0); // simplest possible load-balancing
+	uint32_t JobSystem::queue_index(
+		uint32_t   thread_index, 
+		e_Priority priority
+	) const noexcept {
+		return thread_index * k_NumPriorities + static_cast<uint32_t>(priority);
+	}
 
-		// if no specific execution thread was set, plonk it any global queue
-		if (
-			(!work->m_ThreadIndex) ||
-			(*work->m_ThreadIndex >= m_NumThreads)
-		) {
-			++tidx;
-			if (tidx >= m_NumThreads)
-				tidx = 0;
+	e_Priority JobSystem::current_priority() const noexcept {
+		return l_CurrentJob ?
+			l_CurrentJob->m_Priority :
+			e_Priority::normal;
+	}
+
+	bool JobSystem::should_split() const noexcept {
+		// either a thief took everything we had, or there was nothing to begin with
+		return 
+			is_worker() &&
+			m_GlobalQueues[queue_index(l_ThreadIndex, current_priority())].empty();
+	}
+
+	void JobSystem::wait(Job& job) noexcept {
+		assert((job.m_NumRefs.load() > 0) && "only the job that was most recently handed out to this thread can be waited on");
+
+		// a reference of our own; a worker may be handed other jobs while it helps out (see retain)
+		job.m_NumRefs.fetch_add(1, std::memory_order::relaxed);
 
-			m_GlobalQueues[tidx].push(work);
-			m_WaitCondition.notify_one(); // wake up a thread (if any was waiting)
+		wait_until(job.m_NumChildren, 0, &job);
+
+		release(&job);
+	}
+
+	void JobSystem::wait(const std::atomic<uint32_t>& counter) noexcept {
+		wait_until(counter, 0);
+	}
+
+	void JobSystem::notify_completion() noexcept {
+		m_Completions.notify_all();
+	}
+
+	void JobSystem::wait_until(
+		const std::atomic<uint32_t>& counter, 
+		uint32_t                     value,
+		Job*                         flagged
+	) noexcept {
+		constexpr uint32_t k_SpinRounds = 1 << 6; // before a non-worker parks
+
+		if (is_worker()) {
+			// instead of idling, workers execute whatever else is queued up
+			while (counter.load(std::memory_order::acquire) > value)
+				if (!help())
+					std::this_thread::yield();
+
+			return;
+		}
 
+		for (
+			uint32_t round = 0; 
+			(round < k_SpinRounds) && (counter.load(std::memory_order::acquire) > value); 
+			++round
+		)
+			std::this_thread::yield();
+
+		while (counter.load(std::memory_order::acquire) > value) {
+			// flag the job first so whoever completes it knows to notify, then check once more before parking
+			if (flagged)
+				flagged->m_HasWaiters.store(true, std::memory_order::seq_cst);
+
+			auto key = m_Completions.prepare_wait();
+
+			if (counter.load(std::memory_order::seq_cst) <= value)
+				m_Completions.cancel_wait();
+			else
+				m_Completions.wait(key);
+		}
+	}
+
+	bool JobSystem::help() noexcept {
+		// whatever is on top of our own deques was most likely pushed by the job we're waiting for
+		for (uint32_t i = 0; i < k_NumPriorities; ++i)
+			if (Job* work = m_GlobalQueues[queue_index(l_ThreadIndex, static_cast<e_Priority>(i))].pop()) {
+				execute(work);
+				return true;
+			}
+
+		if (Job* work = find_work()) {
+			execute(work);
 			return true;
 		}
 
-		// if a specific execution thread was set, plonk it in the appropriate local queue
-		m_LocalQueues[l_ThreadIndex].push(work);
-		m_WaitCondition.notify_one();
+		// (what we're waiting for may be waiting for a timer or an event in turn)
+		return expire_timers() | poll_events(); // (both)
+	}
 
-		return true;
+	uint32_t JobSystem::next_submission_index() const noexcept {
+		static thread_local uint32_t tidx(0); // simplest possible load-balancing
+
+		if (++tidx >= m_NumThreads)
+			tidx = 0;
+
+		return tidx;
 	}
 
 	void JobSystem::store_trace(
+		const Job&       job,
 		const Timepoint& job_start,
 		const Timepoint& job_current,
 		uint32_t         executing_thread_index
@@ -291,7 +1106,9 @@ namespace bop::job {
 		m_Traces[executing_thread_index].push_back(JobTrace(
 			job_start,
 			job_current,
-			executing_thread_index
+			executing_thread_index,
+			job.m_QueuedAt,
+			job.m_Priority
 		));
 	}
 
@@ -307,14 +1124,30 @@ namespace bop::job {
 			auto start_time_ms = duration_cast<microseconds>(trace.m_StartTime - m_ApplicationStart);
 			auto duration_ms   = duration_cast<microseconds>(trace.m_CurrentTime - trace.m_StartTime);
 
-			thread_events["cat"]  = "cat";                 // categories (comma separated)
+			const char* priority = "normal";
+
+			switch (trace.m_Priority) {
+			case e_Priority::critical:   priority = "critical";   break;
+			case e_Priority::normal:     priority = "normal";     break;
+			case e_Priority::background: priority = "background"; break;
+			}
+
+			// time spent waiting in a queue before a worker picked it up
+			auto queue_wait_us = (trace.m_QueuedTime == Timepoint()) ?
+				microseconds(0) :
+				duration_cast<microseconds>(trace.m_StartTime - trace.m_QueuedTime);
+
+			thread_events["cat"]  = priority;              // categories (comma separated)
 			thread_events["pid"]  = 0;                     // process ID
 			thread_events["tid"]  = trace.m_ThreadIndex;   // executing thread ID
 			thread_events["ts"]   = start_time_ms.count(); // tracing clock timestamp in microseconds
 			thread_events["dur"]  = duration_ms.count();   // duration (specific to 'complete' events) in microseconds
 			thread_events["ph"]   = "X";                   // program phase - X is 'complete' event (pp 4)
-			thread_events["name"] = "-";                   // display name; we could possibly put a job type here
-			thread_events["args"] = nlohmann::json();      // may hold any additional information
+			thread_events["name"] = priority;              // display name; we could possibly put a job type here
+			thread_events["args"] = {                      // may hold any additional information
+				{ "priority",      priority },
+				{ "queue_wait_us", queue_wait_us.count() }
+			};
 
 			return thread_events;
 		};
@@ -326,6 +1159,15 @@ namespace bop::job {
 				js["traceEvents"].push_back(make_entry(thread_evt));
 
 		js["displayTimeUnit"] = "ms"; // either "ms" or "ns"
+
+		// shown in the metadata panel of the viewer
+		JobMemoryUsage memory = get_job_memory_usage();
+
+		js["otherData"] = {
+			{ "job_memory_current_bytes", memory.m_Current },
+			{ "job_memory_peak_bytes",    memory.m_Peak }
+		};
+
 		// the remaining keys are optional and not needed for our usage
 
 		std::ofstream out("tracelog.json");
@@ -343,10 +1185,10 @@ namespace bop::job {
 
 namespace bop {
 	void shutdown() {
-		job::JobSystem::shutdown();
+		job::JobSystem::get_default().shutdown();
 	}
 
 	void wait_for_shutdown() {
-		job::JobSystem::wait_for_shutdown();
+		job::JobSystem::get_default().wait_for_shutdown();
 	}
 }
\ No newline at end of file
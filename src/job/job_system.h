@@ -1,56 +1,114 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <concepts>
 #include <cstdint>
 #include <chrono>
 #include <map>
 #include <memory>
 #include <memory_resource>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 #include <optional>
+#include <ranges>
+#include <type_traits>
 
+#include "co_frame_allocator.h"
+#include "job_awaitable.h"
 #include "job_queue.h"
+#include "job_deque.h"
+#include "job_poller.h"
+#include "job_slab.h"
+#include "job_priority.h"
+#include "job_timer.h"
 #include "job_trace.h"
+#include "../util/cacheline.h"
 #include "../util/traits.h"
+#include "../util/event_count.h"
+#include "../util/mpmc_ring.h"
+#include "../util/spinlock.h"
+#include "../util/topology.h"
 
 namespace bop::job {
 	class Job;
 
+	// how workers are pinned to cpus (see util::CpuTopology)
+	enum class e_Placement {
+		none,           // leave it to the OS
+		compact,        // fill up SMT siblings and cores that share a cache first
+		scatter,        // spread over numa nodes and cache groups, physical cores first
+		physical_cores, // a single worker per physical core
+		explicit_list   // use the provided list of cpus
+	};
+
+	// work stealing statistics of a single worker (totals since the pool was created)
+	struct StealStats {
+		uint64_t m_Attempts  = 0; // victim deques that were probed
+		uint64_t m_Successes = 0; // probes that yielded at least one job
+		uint64_t m_JobsMoved = 0; // jobs that were taken in total (a steal may take up to half of a deque)
+	};
+
+	// memory held by the job allocator of a pool, in bytes
+	struct JobMemoryUsage {
+		uint64_t m_Current = 0;
+		uint64_t m_Peak    = 0;
+	};
+
 	/*
-	*	Program wide threadpool for executing Jobs (ie. void()-like invocable things)
+	*	Threadpool for executing Jobs (ie. void()-like invocable things)
 	*   The system owns the actual jobs, and takes care of memory management as needed
+	* 
+	*   Every instance is a separate pool with its own workers and queues, so several pools 
+	*   (e.g. one for latency-critical work and one for batch work) may coexist. The first 
+	*   pool that is constructed becomes the default one, which is what the bop::schedule 
+	*   family of functions uses when called from outside of a pool.
 	*/
 	class JobSystem {
 	private:
-		static constexpr uint32_t k_RecyclingCapacity = 1 << 10;
+		static constexpr uint32_t k_AgingInterval     = 1 << 4;  // every so many searches for work, a lower priority class goes first
+		static constexpr uint32_t k_PollInterval      = 1 << 4;  // every so many searches for work, a busy worker checks the timers and pollers
+		static constexpr uint32_t k_MaxPollers        = 4;
 		static constexpr bool     k_EnableProfiling   = true; // when true, a tracelog.json is generated at shutdown that can be viewed in chrome about://tracing
 		
 	public:
 		friend class Job;
+		friend class AwaitableJob;
 
 		using MemoryResource = std::pmr::memory_resource;
-		using JobAllocator   = std::pmr::polymorphic_allocator<Job>;
 		using TraceLog       = std::pmr::vector<JobTrace>;
 		using JobQueueArray  = std::unique_ptr<JobQueue[]>;
-		using MutexArray     = std::unique_ptr<std::mutex[]>;
+		using JobDequeArray  = std::unique_ptr<JobDeque[]>;
+		using JobSlabArray   = std::vector<std::unique_ptr<JobSlab>>;
+		using JobRing        = util::MpmcRing<Job*>;
+		using JobRingArray   = std::vector<std::unique_ptr<JobRing>>;
 		using Clock          = std::chrono::high_resolution_clock;
 		using Timepoint      = Clock::time_point;
 
 		// uses the PMR composable memory allocation backend
 		JobSystem(
 			std::optional<uint32_t> num_threads     = std::nullopt,                   // by default this will use the hardware concurrency
-			MemoryResource*         memory_resource = std::pmr::new_delete_resource()
+			MemoryResource*         memory_resource = std::pmr::new_delete_resource(),
+			std::optional<uint32_t> queue_capacity  = std::nullopt,                   // if set, queues are bounded to this depth (per worker)
+			e_Placement             placement       = e_Placement::none,              // when pinned without a thread count, there is a worker for each selected cpu
+			std::vector<uint32_t>   cpu_list        = {}                              // OS cpu indices, only used with e_Placement::explicit_list
 		) noexcept;
+		~JobSystem(); // shuts down and joins all workers
+
+		// the workers refer to the pool, so it has to stay put
+		JobSystem             (const JobSystem&) = delete;
+		JobSystem& operator = (const JobSystem&) = delete;
+		JobSystem             (JobSystem&&)      = delete;
+		JobSystem& operator = (JobSystem&&)      = delete;
 
-		JobSystem             (const JobSystem&)     = delete;
-		JobSystem& operator = (const JobSystem&)     = delete;
-		JobSystem             (JobSystem&&) noexcept = default;
-		JobSystem& operator = (JobSystem&&) noexcept = default;
+		static JobSystem& get_default();          // the first constructed pool (if there's none, a pool with default settings is created)
+		static JobSystem& get_current();          // the pool the calling thread is a worker of, otherwise the default pool
+		static JobSystem* find_current() noexcept; // the pool the calling thread is a worker of, otherwise nullptr
 
-		static void shutdown() noexcept;          // this can be scheduled as a job
-		static void wait_for_shutdown() noexcept; // blocks until all workers have stopped
+		void shutdown() noexcept;          // this can be scheduled as a job
+		void wait_for_shutdown() noexcept; // blocks until all workers have stopped
 
 		void worker(uint32_t thread_index) noexcept; // executed on a worker thread
 		
@@ -59,30 +117,201 @@ namespace bop::job {
 		inline Job& schedule(
 			std::invocable auto&&   fn, 
 			Job*                    parent       = nullptr,      // if set, indicates which job waits for this one to complete
-			std::optional<uint32_t> thread_index = std::nullopt
+			std::optional<uint32_t> thread_index = std::nullopt,
+			e_Priority              priority     = e_Priority::normal
+		);
+
+		// same as schedule, but the job can be co_awaited (see AwaitableJob)
+		inline AwaitableJob schedule_awaitable(
+			std::invocable auto&&   fn, 
+			Job*                    parent       = nullptr,
+			std::optional<uint32_t> thread_index = std::nullopt,
+			e_Priority              priority     = e_Priority::normal
+		);
+
+		// same as schedule, but reports a full (bounded) queue by returning nullptr instead of waiting for room
+		inline Job* try_schedule(
+			std::invocable auto&&   fn, 
+			Job*                    parent       = nullptr,
+			std::optional<uint32_t> thread_index = std::nullopt,
+			e_Priority              priority     = e_Priority::normal
+		);
+
+		// schedules a job for each invocable in the range, with a single queue operation per target
+		// queue and a single wakeup. Returns the number of jobs that were scheduled
+		template <std::ranges::input_range R>
+		requires std::invocable<std::ranges::range_reference_t<R>>
+		inline uint32_t schedule_range(
+			R&&        work,
+			Job*       parent   = nullptr, // if set, the parent waits for all jobs in the range
+			e_Priority priority = e_Priority::normal
+		);
+
+		// data-parallel loop over [first, last), blocks until every iteration was done
+		// ranges are split lazily -- the remainder is only halved when the local queue ran dry (that is, 
+		// when another worker stole the previous half or when there's nothing else queued up). Leaf chunks 
+		// of 'grain_size' iterations are executed inline
+		template <std::integral I, std::invocable<I> Fn>
+		inline void parallel_for(
+			I                                      first,
+			std::type_identity_t<I>                last,
+			Fn&&                                   fn,
+			std::optional<std::type_identity_t<I>> grain_size = std::nullopt // by default a small fraction of the range per worker
 		);
 
+		// schedules fn once the delay has passed. There is no thread per timer; the workers check a timing
+		// wheel in between jobs and one of the parked workers sleeps until the next timer is due. Timers
+		// never expire early, but may be late by a tick (or by as long as the workers are all busy)
+		inline void schedule_after(
+			TimerWheel::Duration  delay,
+			std::invocable auto&& fn,
+			e_Priority            priority = e_Priority::normal
+		);
+
+		// schedules fn every period, until the pool shuts down or until fn returns false. A run is not
+		// started before the previous one completed; periods that were missed entirely are skipped
+		template <typename Fn>
+		requires std::invocable<Fn&> && (
+			std::is_void_v<std::invoke_result_t<Fn&>> || 
+			std::same_as<std::invoke_result_t<Fn&>, bool>
+		)
+		inline void schedule_every(
+			TimerWheel::Duration period,
+			Fn&&                 fn,
+			e_Priority           priority = e_Priority::normal
+		);
+
+		// the node is expired by one of the workers once the deadline passed (see SleepAwaiter).
+		// Nodes that are still pending when the pool is destroyed are discarded
+		void add_timer(TimerNode& node, TimerWheel::Timepoint deadline) noexcept;
+
+		// the pool's instance of a poller type, which lives as long as the pool (see Poller). It's constructed
+		// on first use from the pool and the arguments, which are ignored after that. Only this instance is
+		// ever polled, so poller types keep their constructors private and befriend the pool.
+		// Throws std::length_error when there are too many kinds of them
+		template <std::derived_from<Poller> T, typename... Args>
+		inline T& get_poller(Args&&... args);
+		void notify_poller_pending() noexcept; // pollers call this when something became pending, so a parked worker waits for it
+
+		// blocks until the job and all of its children completed. Workers keep executing queued jobs in
+		// the meantime (their own most recent ones first), other threads park until the job completes.
+		// Completed jobs are recycled, so this only applies to the job that schedule or then most recently
+		// returned to the calling thread (see retain); AwaitableJob can be waited on regardless
+		void wait(Job& job) noexcept;
+
+		// same, for a plain counter. Whoever brings it to zero has to call notify_completion afterwards
+		void wait(const std::atomic<uint32_t>& counter) noexcept;
+		void notify_completion() noexcept; // wakes the threads outside of the pool that are waiting
+
+		bool            is_worker()           const noexcept; // true if the calling thread is one of the workers of this pool
 		uint32_t        get_thread_index()    const noexcept; // thread-local
 		uint32_t        get_num_threads()     const noexcept; // same everywhere
 		MemoryResource* get_memory_resource() const noexcept; // exposing this allows coroutines to make use of it to allocate their stackframes
+		CoFrameAllocator& get_frame_allocator() noexcept;     // pooled coroutine frames, backed by the memory resource
+		e_Priority      current_priority()    const noexcept; // the priority of the job that is running on this thread (normal if none)
+		
+		std::optional<uint32_t> get_queue_capacity() const noexcept; // nullopt if the queues are unbounded
+
+		e_Placement             get_placement()                          const noexcept;
+		std::optional<uint32_t> get_worker_cpu(uint32_t thread_index)    const noexcept; // nullopt if the worker is not pinned
+
+		StealStats     get_steal_stats(uint32_t thread_index) const noexcept; // only a snapshot while the pool is running
+		JobMemoryUsage get_job_memory_usage()                 const noexcept; // chunks obtained from the memory resource for jobs
 
 	private:
 		Job* create_job();
 		void deallocate_job_queue(JobQueue& jq);
-		void deallocate_job_queue(JobQueueNonThreadsafe& jq);
+		void deallocate_job_queue(JobDeque& jq);
+		void deallocate_job_queue(JobRing& jq);
 		
 		inline Job* construct(
 			std::invocable auto&&   fn, 
 			Job*                    parent,
-			std::optional<uint32_t> thread_index
+			std::optional<uint32_t> thread_index,
+			e_Priority              priority
+		) noexcept;
+
+		// all queues are kept per worker and per priority class, the ones of a single worker are adjacent
+		uint32_t queue_index(uint32_t thread_index, e_Priority priority) const noexcept;
+
+		// the job that schedule or then most recently returned to a thread stays around after it completed,
+		// until the thread is handed the next one (so it can still be waited on). Call before publishing it
+		void retain(Job* work) noexcept;
+		void release(Job* work) noexcept; // drops a reference to the job, whoever drops the last one recycles it (see finish)
+
+		void submit(Job* work) noexcept;        // waits for room when the (bounded) queues are full, workers execute the job inline instead
+		bool schedule_work(Job* work) noexcept; // returns false if the work could not be queued because the (bounded) queues are full
+
+		template <std::integral I, typename Fn>
+		struct ParallelForState;
+
+		template <std::integral I, typename Fn>
+		inline void parallel_for_range(
+			ParallelForState<I, Fn>& state,
+			I                        first,
+			I                        last
+		);
+
+		// a split-off range is done; the last one wakes the thread that started the loop, if it's parked
+		template <std::integral I, typename Fn>
+		inline void complete_range(ParallelForState<I, Fn>& state) noexcept;
+
+		class DelayedJob;
+
+		template <typename Fn>
+		class PeriodicJob;
+
+		void start_delayed(Job* work, TimerWheel::Timepoint deadline); // takes ownership of the job
+		bool expire_timers() noexcept;                                // schedules whatever is due, false if nothing was
+		bool poll_events()   noexcept;                                // polls all pollers, false if none of them had anything
+		void interrupt_pollers() noexcept;                            // the ones a worker is blocked in
+
+		// sleeps until notified, the next timer or an event of a poller. Blocking in a poller
+		// cancels the wait, a job that was found meanwhile is returned
+		Job* park(util::EventCount::Key key) noexcept;
+
+		template <typename T>
+		static constexpr char k_PollerType = 0; // (its address identifies T, whatever get_poller was called with)
+
+		Poller* find_poller(const void* type) const noexcept;
+		Poller& add_poller(const void* type, std::unique_ptr<Poller> poller); // (requires m_PollerLock)
+
+		bool should_split() const noexcept; // true if the calling worker has nothing queued up
+		bool help()               noexcept; // executes a single queued job on behalf of a waiting worker, false if there was none
+
+		// until the counter is down to the value. Workers keep executing queued jobs meanwhile, other threads
+		// park (the flagged job notifies them when it completes, otherwise whoever changes the counter has to)
+		void wait_until(
+			const std::atomic<uint32_t>& counter, 
+			uint32_t                     value,
+			Job*                         flagged = nullptr
+		) noexcept;
+
+		void schedule_chain(Job* head, Job* tail, uint32_t count) noexcept; // jobs linked via m_Next
+		bool push_submission(Job* work) noexcept;
+		Job* pop_submission(uint32_t thread_index, e_Priority priority) noexcept;
+		uint32_t next_submission_index() const noexcept;
+
+		Job* find_work() noexcept;                    // highest priority first, with periodic aging
+		Job* find_work(e_Priority priority) noexcept; // own queues first, then steal
+		Job* steal_work(e_Priority priority) noexcept;
+
+		// steals up to half of the victim's deque, the remainder ends up in our own deque
+		Job* steal_from(
+			uint32_t   victim, 
+			e_Priority priority
 		) noexcept;
 
-		bool schedule_work(Job* work) noexcept; // returns true if it is scheduled generically and false for a tagged phase
+		uint32_t random_victim() noexcept; // any worker other than the calling one (requires at least 2 workers)
+		void wake_workers(uint32_t num_jobs) noexcept; // call after queueing work
 
+		void execute(Job* job) noexcept; // runs the job and any continuations that follow it
 		bool job_completed(Job* job) noexcept;
+		void finish(Job* job) noexcept; // once the job and its children completed; notifies, recycles and resumes an awaiter
 		void recycle(Job* work) noexcept;
 
 		void store_trace(
+			const Job&       job,
 			const Timepoint& job_start,
 			const Timepoint& job_end,
 			uint32_t         executing_thread_index
@@ -91,29 +320,88 @@ namespace bop::job {
 		void clear_tracelog();
 
 		// pool-related
-		static inline std::atomic<uint64_t>    m_InitOnce         = 0;
-		static inline MemoryResource*          m_MemoryResource   = nullptr;
-		static inline std::vector<std::thread> m_WorkerThreads;	  
-		static inline std::atomic<uint32_t>    m_NumThreads       = 0;       // number of threads in the pool
-		static inline std::atomic<bool>        m_Shutdown         = false;   // flag to stop workers
-		static inline std::atomic<bool>        m_ShutdownComplete = false;   // when true, all worker threads have stopped
+		MemoryResource*          m_MemoryResource   = nullptr;
+		std::vector<std::thread> m_WorkerThreads;
+		uint32_t                 m_NumThreads       = 0;       // number of threads in the pool
+		std::atomic<uint32_t>    m_StartingWorkers  = 0;       // workers wait for each other before starting
+		std::atomic<uint32_t>    m_ActiveWorkers    = 0;       // workers that haven't stopped yet
+		std::atomic<bool>        m_Shutdown         = false;   // flag to stop workers
+		std::atomic<bool>        m_ShutdownComplete = false;   // when true, all worker threads have stopped
+		e_Placement              m_Placement        = e_Placement::none;
+		std::vector<uint32_t>    m_WorkerCpus;                 // worker i runs on m_WorkerCpus[i % size] (empty when not pinned)
 
 		// queue related (these are accessible from all running workers)
-		static inline JobQueueArray            m_GlobalQueues;
-		static inline JobQueueArray            m_LocalQueues;
-		static inline std::condition_variable  m_WaitCondition;
-		static inline MutexArray               m_Mutexes;
+		// - global queues are work-stealing deques; only the owning worker may push into them
+		// - submission queues accept work from threads outside of the pool; these are either
+		//   unbounded linked lists or bounded rings (when a queue capacity was specified)
+		// - local queues hold work that must be executed on a specific worker
+		// each of these has a queue per priority class (see queue_index)
+		std::optional<uint32_t>  m_QueueCapacity;
+		JobDequeArray            m_GlobalQueues;
+		JobQueueArray            m_SubmissionQueues;
+		JobRingArray             m_SubmissionRings;
+		JobQueueArray            m_LocalQueues;
+
+		// idle workers spin for a bit, then park. Submitters only wake a parked worker when nobody is spinning
+		util::EventCount         m_Parking;
+		std::atomic<uint32_t>    m_NumSpinning = 0;
+
+		// delayed work; a single parked worker watches the timers, sleeping until m_TimerWatch (k_Never if nobody does)
+		TimerWheel               m_Timers;
+		std::atomic<uint64_t>    m_TimerWatch = TimerWheel::k_Never;
+
+		// every kind of poller has a slot, a parked worker that blocks in it claims it for the time being
+		struct PollerSlot {
+			const void*             m_Type    = nullptr;
+			std::unique_ptr<Poller> m_Poller;
+			std::atomic<bool>       m_Blocked = false;
+		};
+
+		std::array<PollerSlot, k_MaxPollers> m_Pollers;
+		std::atomic<uint32_t>                m_NumPollers = 0; // (slots are only published, never removed)
+		std::atomic<uint32_t>                m_NumBlocked = 0; // workers that are blocked in a poller
+		std::mutex                           m_PollerLock;     // serializes adding pollers
+
+		// threads outside of the pool that wait for a job park here; notified when a waited job completes
+		util::EventCount         m_Completions;
+
+		// the jobs that were most recently handed out to threads outside of the pool (see retain)
+		std::unordered_map<std::thread::id, Job*> m_ExternalRetained;
+		util::Spinlock                            m_ExternalRetainedLock;
+
+		// only written by the owning worker
+		struct alignas(util::hardware_destructive_interference_size) StealCounters {
+			std::atomic<uint64_t> m_Attempts  = 0;
+			std::atomic<uint64_t> m_Successes = 0;
+			std::atomic<uint64_t> m_JobsMoved = 0;
+		};
+
+		std::unique_ptr<StealCounters[]> m_StealCounters;
+
+		// jobs are allocated from a slab per worker (and a shared one for other threads); completed jobs 
+		// go back to the slab they came from. Idle workers trim their slab
+		SlabFootprint            m_SlabFootprint;
+		JobSlabArray             m_Slabs;
+		std::unique_ptr<JobSlab> m_ExternalSlab;
+		util::Spinlock           m_ExternalSlabLock;
+
+		// coroutine frames are pooled per size class, with a cache per worker
+		std::unique_ptr<CoFrameAllocator> m_FrameAllocator;
 
 		// profiling/tracing/logging
-		static inline Timepoint                  m_ApplicationStart;
-		static inline std::pmr::vector<TraceLog> m_Traces;
-		static inline bool                       m_DoLogging = false;
-
-		// per-thread stuff
-		static inline thread_local uint32_t              l_ThreadIndex;
-		static inline thread_local Job*                  l_CurrentJob  = nullptr;
-		static inline thread_local JobQueueNonThreadsafe l_RecyclingBin;
-		static inline thread_local JobQueueNonThreadsafe l_GarbageBin;
+		Timepoint                  m_ApplicationStart;
+		std::pmr::vector<TraceLog> m_Traces;
+		bool                       m_DoLogging = false;
+
+		static inline std::atomic<JobSystem*> m_DefaultSystem = nullptr;
+
+		// per-thread stuff (a thread is a worker of at most one pool)
+		static inline thread_local JobSystem* l_CurrentSystem = nullptr; // the pool this thread is a worker of
+		static inline thread_local uint32_t   l_ThreadIndex   = 0;
+		static inline thread_local Job*       l_CurrentJob    = nullptr;
+		static inline thread_local Job*       l_RetainedJob   = nullptr; // the one that was most recently handed out to this worker (see retain)
+		static inline thread_local uint32_t   l_NumSearches   = 0;       // drives the priority aging
+		static inline thread_local uint32_t   l_RandomState   = 1;       // victim selection (xorshift, seeded per worker)
 	};
 }
 
@@ -122,9 +410,53 @@ namespace bop {
 	inline job::Job& schedule(
 		std::invocable auto&&   work,
 		job::Job*               parent       = nullptr, // indicates which job is waiting for this one
-		std::optional<uint32_t> thread_index = std::nullopt
+		std::optional<uint32_t> thread_index = std::nullopt,
+		job::e_Priority         priority     = job::e_Priority::normal
 	) noexcept; // returns the number of jobs scheduled
 
+	inline job::AwaitableJob schedule_awaitable(
+		std::invocable auto&&   work,
+		job::Job*               parent       = nullptr,
+		std::optional<uint32_t> thread_index = std::nullopt,
+		job::e_Priority         priority     = job::e_Priority::normal
+	); // for coroutines, co_await the result
+
+	inline job::Job* try_schedule(
+		std::invocable auto&&   work,
+		job::Job*               parent       = nullptr,
+		std::optional<uint32_t> thread_index = std::nullopt,
+		job::e_Priority         priority     = job::e_Priority::normal
+	) noexcept; // returns nullptr if the (bounded) queues are full
+
+	template <std::ranges::input_range R>
+	requires std::invocable<std::ranges::range_reference_t<R>>
+	inline uint32_t schedule_batch(
+		R&&             work,
+		job::Job*       parent   = nullptr,
+		job::e_Priority priority = job::e_Priority::normal
+	); // returns the number of jobs scheduled
+
+	template <std::integral I, std::invocable<I> Fn>
+	inline void parallel_for(
+		I                                      first,
+		std::type_identity_t<I>                last,
+		Fn&&                                   fn,
+		std::optional<std::type_identity_t<I>> grain_size = std::nullopt
+	);
+
+	inline void schedule_after(
+		job::TimerWheel::Duration delay,
+		std::invocable auto&&     work,
+		job::e_Priority           priority = job::e_Priority::normal
+	);
+
+	template <typename Fn>
+	inline void schedule_every(
+		job::TimerWheel::Duration period,
+		Fn&&                      work,
+		job::e_Priority           priority = job::e_Priority::normal
+	); // work may return false to stop
+
 	void shutdown();
 	void wait_for_shutdown();
 }
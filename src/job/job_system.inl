@@ -2,35 +2,443 @@
 
 #include "job_system.h"
 #include "job.h"
+#include <algorithm>
 #include <cassert>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <thread>
+#include <type_traits>
 
 namespace bop::job {
+	Job& Job::then(
+		std::invocable auto&&     work,
+		std::optional<uint32_t>   thread_index,
+		std::optional<e_Priority> priority
+	) noexcept {
+		// only constructed, not scheduled yet (and belonging to the same pool)
+		Job* continuation = m_System->construct(
+			std::forward<decltype(work)>(work),
+			nullptr,
+			thread_index,
+			priority.value_or(m_Priority)
+		);
+
+		m_System->retain(continuation);
+
+		return *continue_with(continuation);
+	}
+
+	AwaitableJob AwaitableJob::then(
+		std::invocable auto&&     work,
+		std::optional<uint32_t>   thread_index,
+		std::optional<e_Priority> priority
+	) {
+		Job* continuation = m_Job->m_System->construct(
+			std::forward<decltype(work)>(work),
+			nullptr,
+			thread_index,
+			priority.value_or(m_Job->m_Priority)
+		);
+
+		// the hold keeps the continuation around until it's awaited (nobody else can see it yet)
+		continuation->m_NumChildren.fetch_add(1, std::memory_order::relaxed);
+
+		// (this job is held, so it cannot have been recycled)
+		return AwaitableJob(m_Job->continue_with(continuation));
+	}
+
 	Job& JobSystem::schedule(
 		std::invocable auto&&   fn,
 		Job*                    parent,
-		std::optional<uint32_t> thread_index
+		std::optional<uint32_t> thread_index,
+		e_Priority              priority
 	) {
 		Job* work = construct(
 			std::forward<decltype(fn)>(fn), 
 			parent,
-			thread_index
+			thread_index,
+			priority
 		);
 
-		schedule_work(work);
+		retain(work);
+		submit(work);
 
 		return *work;
 	}
 
+	AwaitableJob JobSystem::schedule_awaitable(
+		std::invocable auto&&   fn,
+		Job*                    parent,
+		std::optional<uint32_t> thread_index,
+		e_Priority              priority
+	) {
+		Job* work = construct(
+			std::forward<decltype(fn)>(fn), 
+			parent,
+			thread_index,
+			priority
+		);
+
+		// the hold keeps the job around until it's awaited (nobody else can see it yet)
+		work->m_NumChildren.fetch_add(1, std::memory_order::relaxed);
+
+		submit(work);
+
+		return AwaitableJob(work);
+	}
+
+	Job* JobSystem::try_schedule(
+		std::invocable auto&&   fn,
+		Job*                    parent,
+		std::optional<uint32_t> thread_index,
+		e_Priority              priority
+	) {
+		Job* work = construct(
+			std::forward<decltype(fn)>(fn), 
+			parent,
+			thread_index,
+			priority
+		);
+
+		if (schedule_work(work))
+			return work;
+
+		// undo the parent link, the parent may have been waiting on just this one
+		if (parent)
+			job_completed(parent);
+
+		recycle(work);
+
+		return nullptr;
+	}
+
+	void JobSystem::schedule_after(
+		TimerWheel::Duration  delay,
+		std::invocable auto&& fn,
+		e_Priority            priority
+	) {
+		Job* work = construct(
+			std::forward<decltype(fn)>(fn),
+			nullptr,
+			std::nullopt,
+			priority
+		);
+
+		start_delayed(work, TimerWheel::Clock::now() + delay);
+	}
+
+	// a node per periodic timer, re-armed after every run
+	template <typename Fn>
+	class JobSystem::PeriodicJob final:
+		public TimerNode
+	{
+	public:
+		template <typename U>
+		PeriodicJob(
+			JobSystem&            system,
+			TimerWheel::Duration  period,
+			TimerWheel::Timepoint first,
+			U&&                   fn,
+			e_Priority            priority
+		):
+			m_System  (&system),
+			m_Period  (std::max(period, TimerWheel::k_Resolution)), // (at most once per tick)
+			m_Deadline(first),
+			m_Priority(priority),
+			m_Fn      (std::forward<U>(fn))
+		{
+		}
+
+		void expire() noexcept override {
+			// the run owns the node until it re-arms it (so a run that is dropped at shutdown releases it)
+			m_System->submit(m_System->construct(
+				[timer = std::unique_ptr<PeriodicJob, Discard>(this)]() mutable { 
+					timer.release()->run(); 
+				},
+				nullptr,
+				std::nullopt,
+				m_Priority
+			));
+		}
+
+		void discard() noexcept override {
+			std::pmr::polymorphic_allocator<>(m_System->m_MemoryResource).delete_object(this);
+		}
+
+	private:
+		struct Discard {
+			void operator()(PeriodicJob* timer) const noexcept {
+				timer->discard();
+			}
+		};
+
+		void run() {
+			bool again = true;
+
+			if constexpr (std::is_void_v<std::invoke_result_t<Fn&>>)
+				std::invoke(m_Fn);
+			else
+				again = std::invoke(m_Fn);
+
+			if (!again || m_System->m_Shutdown.load()) {
+				discard();
+				return;
+			}
+
+			// keep to the original schedule, skipping the periods that were missed entirely
+			auto now = TimerWheel::Clock::now();
+
+			m_Deadline += m_Period;
+
+			if (m_Deadline <= now)
+				m_Deadline += ((now - m_Deadline) / m_Period + 1) * m_Period;
+
+			m_System->add_timer(*this, m_Deadline);
+		}
+
+		JobSystem*            m_System;
+		TimerWheel::Duration  m_Period;
+		TimerWheel::Timepoint m_Deadline;
+		e_Priority            m_Priority;
+		Fn                    m_Fn;
+	};
+
+	template <typename Fn>
+	requires std::invocable<Fn&> && (
+		std::is_void_v<std::invoke_result_t<Fn&>> || 
+		std::same_as<std::invoke_result_t<Fn&>, bool>
+	)
+	void JobSystem::schedule_every(
+		TimerWheel::Duration period,
+		Fn&&                 fn,
+		e_Priority           priority
+	) {
+		using Timer = PeriodicJob<std::decay_t<Fn>>;
+
+		auto first = TimerWheel::Clock::now() + period;
+		auto timer = std::pmr::polymorphic_allocator<>(m_MemoryResource).new_object<Timer>(
+			*this,
+			period,
+			first,
+			std::forward<Fn>(fn),
+			priority
+		);
+
+		add_timer(*timer, first);
+	}
+
+	template <std::derived_from<Poller> T, typename... Args>
+	T& JobSystem::get_poller(Args&&... args) {
+		if (Poller* existing = find_poller(&k_PollerType<T>))
+			[[likely]]
+			return static_cast<T&>(*existing);
+
+		std::scoped_lock guard(m_PollerLock);
+
+		// (someone else may have gotten here first)
+		if (Poller* existing = find_poller(&k_PollerType<T>))
+			return static_cast<T&>(*existing);
+
+		// (not make_unique, the constructor is private)
+		return static_cast<T&>(add_poller(&k_PollerType<T>, std::unique_ptr<T>(new T(*this, std::forward<Args>(args)...))));
+	}
+
+	template <std::ranges::input_range R>
+	requires std::invocable<std::ranges::range_reference_t<R>>
+	uint32_t JobSystem::schedule_range(
+		R&&        work,
+		Job*       parent,
+		e_Priority priority
+	) {
+		// build a pre-linked chain first, the queues can splice that in one go
+		Job*     head  = nullptr;
+		Job*     tail  = nullptr;
+		uint32_t count = 0;
+
+		for (auto&& fn : work) {
+			Job* job = construct(
+				std::forward<decltype(fn)>(fn),
+				nullptr,     // the parent is linked below
+				std::nullopt,
+				priority
+			);
+
+			job->m_Parent = parent;
+
+			if (tail)
+				tail->m_Next = job;
+			else
+				head = job;
+
+			tail = job;
+			++count;
+		}
+
+		if (count == 0)
+			return 0;
+
+		tail->m_Next = nullptr;
+
+		// a single update for all children
+		if (parent)
+			parent->m_NumChildren.fetch_add(count);
+
+		schedule_chain(head, tail, count);
+
+		return count;
+	}
+
+	template <std::integral I, typename Fn>
+	struct JobSystem::ParallelForState {
+		// distances are unsigned and at least 64 bits, so they can't overflow (or truncate) for any range of I
+		using Count = std::common_type_t<I, uint64_t>;
+
+		ParallelForState(Fn& fn, Count grain_size) noexcept:
+			m_Fn       (fn),
+			m_GrainSize(grain_size)
+		{
+		}
+
+		static Count distance(I first, I last) noexcept {
+			return static_cast<Count>(last) - static_cast<Count>(first);
+		}
+
+		Fn&                   m_Fn;
+		Count                 m_GrainSize;
+		std::atomic<uint32_t> m_Pending = 0;     // number of split-off ranges that are still running
+		std::atomic<bool>     m_Failed  = false;
+		std::exception_ptr    m_Exception;       // the first exception thrown by fn (if any)
+	};
+
+	template <std::integral I, std::invocable<I> Fn>
+	void JobSystem::parallel_for(
+		I                                      first,
+		std::type_identity_t<I>                last,
+		Fn&&                                   fn,
+		std::optional<std::type_identity_t<I>> grain_size
+	) {
+		using State = ParallelForState<I, Fn>;
+		using Count = typename State::Count;
+
+		if (first >= last)
+			return;
+
+		Count grain;
+
+		if (grain_size)
+			grain = static_cast<Count>(std::max<I>(*grain_size, 1));
+		else {
+			constexpr Count k_ChunksPerThread = 16;
+
+			grain = std::max<Count>(State::distance(first, last) / (m_NumThreads * k_ChunksPerThread), 1);
+		}
+
+		State state(fn, grain);
+
+		if (is_worker())
+			parallel_for_range(state, first, last); // start inline, idle workers will steal the splits
+		else {
+			// we're not part of the pool, so hand over the entire range
+			++state.m_Pending;
+
+			submit(construct(
+				[this, &state, first, last] {
+					parallel_for_range(state, first, last);
+					complete_range(state);
+				},
+				nullptr,
+				std::nullopt,
+				current_priority()
+			));
+		}
+
+		wait_until(state.m_Pending, 0);
+
+		if (state.m_Exception)
+			std::rethrow_exception(state.m_Exception);
+	}
+
+	template <std::integral I, typename Fn>
+	void JobSystem::parallel_for_range(
+		ParallelForState<I, Fn>& state,
+		I                        first,
+		I                        last
+	) {
+		while (first < last) {
+			if (state.m_Failed.load(std::memory_order::relaxed)) [[unlikely]]
+				return;
+
+			// lazy splitting - only offer up the upper half when it is likely that someone will take it
+			auto remaining = state.distance(first, last);
+
+			if (
+				(remaining > state.m_GrainSize) && 
+				should_split()
+			) {
+				I middle = static_cast<I>(first + static_cast<I>(remaining / 2)); // (half of a distance always fits in I)
+
+				++state.m_Pending;
+
+				submit(construct(
+					[this, &state, middle, last] {
+						parallel_for_range(state, middle, last);
+						complete_range(state);
+					},
+					nullptr,
+					std::nullopt,
+					current_priority()
+				));
+
+				last = middle;
+				continue;
+			}
+
+			// leaf chunk (the grain size fits in I: it was given as one, or it's a small fraction of the distance)
+			I chunk_end = (remaining <= state.m_GrainSize) ?
+				last :
+				static_cast<I>(first + static_cast<I>(state.m_GrainSize));
+
+			try {
+				for (I i = first; i < chunk_end; ++i)
+					state.m_Fn(i);
+			}
+			catch (...) {
+				if (!state.m_Failed.exchange(true))
+					state.m_Exception = std::current_exception();
+
+				return;
+			}
+
+			first = chunk_end;
+		}
+	}
+
+	template <std::integral I, typename Fn>
+	void JobSystem::complete_range(ParallelForState<I, Fn>& state) noexcept {
+		// (seq_cst, pairs with the recheck in wait_until; the state may be gone once the count is zero)
+		if (state.m_Pending.fetch_sub(1, std::memory_order::seq_cst) == 1)
+			notify_completion();
+	}
+
 	Job* JobSystem::construct(
 		std::invocable auto&&   fn,
 		Job*                    parent,
-		std::optional<uint32_t> thread_index
+		std::optional<uint32_t> thread_index,
+		e_Priority              priority
 	) noexcept {
 		Job* result = create_job(); // construct an empty job first
 
+		result->m_System      = this;
 		result->m_Parent      = parent;       // may be nullptr
-		result->m_ThreadIndex = thread_index; // optionally specified		
-		result->m_Work        = std::forward<decltype(fn)>(fn);
+		result->m_ThreadIndex = thread_index.value_or(Job::k_AnyThread);
+		result->m_Priority    = priority;
+		result->m_Work        = Job::Work(std::forward<decltype(fn)>(fn), m_MemoryResource);
+
+		// the parent is not complete until this job is
+		if (parent)
+			parent->m_NumChildren.fetch_add(1);
 
 		return result;
 	}
@@ -40,14 +448,104 @@ namespace bop {
 	job::Job& schedule(
 		std::invocable auto&&   work,
 		job::Job*               parent,
-		std::optional<uint32_t> thread_index
+		std::optional<uint32_t> thread_index,
+		job::e_Priority         priority
 	) noexcept {
 		// we're adding a single task
-		return job::JobSystem()
+		return job::JobSystem::get_current()
 			.schedule(
 				std::forward<decltype(work)>(work),
 				parent,
-				thread_index
+				thread_index,
+				priority
+			);
+	}
+
+	job::AwaitableJob schedule_awaitable(
+		std::invocable auto&&   work,
+		job::Job*               parent,
+		std::optional<uint32_t> thread_index,
+		job::e_Priority         priority
+	) {
+		return job::JobSystem::get_current()
+			.schedule_awaitable(
+				std::forward<decltype(work)>(work),
+				parent,
+				thread_index,
+				priority
+			);
+	}
+
+	job::Job* try_schedule(
+		std::invocable auto&&   work,
+		job::Job*               parent,
+		std::optional<uint32_t> thread_index,
+		job::e_Priority         priority
+	) noexcept {
+		return job::JobSystem::get_current()
+			.try_schedule(
+				std::forward<decltype(work)>(work),
+				parent,
+				thread_index,
+				priority
+			);
+	}
+
+	template <std::integral I, std::invocable<I> Fn>
+	void parallel_for(
+		I                                      first,
+		std::type_identity_t<I>                last,
+		Fn&&                                   fn,
+		std::optional<std::type_identity_t<I>> grain_size
+	) {
+		job::JobSystem::get_current()
+			.parallel_for(
+				first,
+				last,
+				std::forward<Fn>(fn),
+				grain_size
+			);
+	}
+
+	void schedule_after(
+		job::TimerWheel::Duration delay,
+		std::invocable auto&&     work,
+		job::e_Priority           priority
+	) {
+		job::JobSystem::get_current()
+			.schedule_after(
+				delay,
+				std::forward<decltype(work)>(work),
+				priority
+			);
+	}
+
+	template <typename Fn>
+	void schedule_every(
+		job::TimerWheel::Duration period,
+		Fn&&                      work,
+		job::e_Priority           priority
+	) {
+		job::JobSystem::get_current()
+			.schedule_every(
+				period,
+				std::forward<Fn>(work),
+				priority
+			);
+	}
+
+	template <std::ranges::input_range R>
+	requires std::invocable<std::ranges::range_reference_t<R>>
+	uint32_t schedule_batch(
+		R&&             work,
+		job::Job*       parent,
+		job::e_Priority priority
+	) {
+		return job::JobSystem::get_current()
+			.schedule_range(
+				std::forward<R>(work),
+				parent,
+				priority
 			);
 	}
 }
\ No newline at end of file
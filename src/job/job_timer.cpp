@@ -0,0 +1,203 @@
+#include "job_timer.h"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+namespace bop::job {
+	namespace {
+		// the ticks below the given level
+		constexpr uint64_t level_mask(uint32_t level, uint32_t slot_bits) noexcept {
+			return (uint64_t(1) << (slot_bits * level)) - 1;
+		}
+	}
+
+	TimerWheel::TimerWheel(Timepoint start) noexcept:
+		m_Start(start)
+	{
+	}
+
+	uint64_t TimerWheel::add(TimerNode* node, Timepoint deadline) noexcept {
+		Duration since_start = deadline - m_Start;
+		uint64_t tick        = 0;
+
+		// (rounded up, so it doesn't expire early)
+		if (since_start > Duration::zero())
+			tick = static_cast<uint64_t>((since_start + k_Resolution - Duration(1)) / k_Resolution);
+
+		std::scoped_lock guard(m_Lock);
+
+		uint64_t current = m_CurrentTick.load(std::memory_order::relaxed);
+
+		// the current tick was expired already, so anything that is overdue goes into the next one
+		node->m_Tick = std::max(tick, current + 1);
+
+		link(node, current);
+		m_NumTimers.fetch_add(1, std::memory_order::relaxed);
+
+		return node->m_Tick;
+	}
+
+	TimerNode* TimerWheel::advance(Timepoint now) noexcept {
+		if (now < m_Start)
+			return nullptr;
+
+		uint64_t target = static_cast<uint64_t>((now - m_Start) / k_Resolution);
+
+		if (target <= m_CurrentTick.load(std::memory_order::acquire))
+			return nullptr;
+
+		// a single thread moves the wheel, the others just carry on
+		if (!m_Lock.try_lock())
+			return nullptr;
+
+		std::scoped_lock guard(std::adopt_lock, m_Lock);
+
+		TimerNode* expired = nullptr;
+		uint64_t   tick    = m_CurrentTick.load(std::memory_order::relaxed);
+
+		while ((tick < target) && (m_NumTimers.load(std::memory_order::relaxed) > 0)) {
+			// with nothing in level 0, nothing expires until the next block starts
+			if (m_NumDue == 0) {
+				tick = std::min(target, tick | k_SlotMask);
+
+				if (tick == target)
+					break;
+			}
+
+			++tick;
+
+			// when a level wraps around, the next slot of the level above it is spread out over the
+			// levels below (from the top down, so nodes can move down several levels at once)
+			if ((tick & level_mask(k_NumLevels, k_SlotBits)) == 0)
+				relink(std::exchange(m_Overflow, nullptr), tick);
+
+			uint32_t wrapped = 0;
+
+			while (
+				(wrapped + 1 < k_NumLevels) &&
+				((tick & level_mask(wrapped + 1, k_SlotBits)) == 0)
+			)
+				++wrapped;
+
+			for (uint32_t level = wrapped; level > 0; --level) {
+				TimerNode*& slot = m_Levels[level][(tick >> (k_SlotBits * level)) & k_SlotMask];
+
+				relink(std::exchange(slot, nullptr), tick);
+			}
+
+			// whatever is in the level 0 slot is due now
+			TimerNode* node = std::exchange(m_Levels[0][tick & k_SlotMask], nullptr);
+
+			while (node) {
+				TimerNode* next = node->m_Next;
+
+				node->m_Next = expired;
+				expired      = node;
+				node         = next;
+
+				--m_NumDue;
+				m_NumTimers.fetch_sub(1, std::memory_order::relaxed);
+			}
+		}
+
+		// (an empty wheel just jumps ahead)
+		m_CurrentTick.store(target, std::memory_order::release);
+
+		return expired;
+	}
+
+	void TimerWheel::clear() noexcept {
+		TimerNode* pending = nullptr;
+
+		auto take = [&pending](TimerNode* list) {
+			while (list) {
+				TimerNode* next = list->m_Next;
+
+				list->m_Next = pending;
+				pending      = list;
+				list         = next;
+			}
+		};
+
+		{
+			std::scoped_lock guard(m_Lock);
+
+			for (auto& level : m_Levels)
+				for (auto& slot : level)
+					take(std::exchange(slot, nullptr));
+
+			take(std::exchange(m_Overflow, nullptr));
+
+			m_NumDue = 0;
+			m_NumTimers.store(0, std::memory_order::relaxed);
+		}
+
+		while (pending) {
+			TimerNode* next = pending->m_Next;
+
+			pending->discard(); // (may release the node)
+			pending = next;
+		}
+	}
+
+	uint64_t TimerWheel::next_expiry() const noexcept {
+		std::scoped_lock guard(m_Lock);
+
+		if (m_NumTimers.load(std::memory_order::relaxed) == 0)
+			return k_Never;
+
+		uint64_t current   = m_CurrentTick.load(std::memory_order::relaxed);
+		uint64_t block_end = current | k_SlotMask;
+
+		// level 0 only holds ticks of the current block
+		if (m_NumDue > 0)
+			for (uint64_t tick = current + 1; tick <= block_end; ++tick)
+				if (m_Levels[0][tick & k_SlotMask])
+					return tick;
+
+		// otherwise the earliest anything can expire is after the levels above have been cascaded
+		return block_end + 1;
+	}
+
+	TimerWheel::Timepoint TimerWheel::to_timepoint(uint64_t tick) const noexcept {
+		return m_Start + tick * k_Resolution;
+	}
+
+	bool TimerWheel::empty() const noexcept {
+		return m_NumTimers.load(std::memory_order::relaxed) == 0;
+	}
+
+	void TimerWheel::link(TimerNode* node, uint64_t current) noexcept {
+		// (overdue nodes that are cascaded go into the current slot, which is expired right after)
+		uint64_t tick = std::max(node->m_Tick, current);
+
+		// the lowest level at which the tick falls in the same block as the current one
+		uint64_t differing = tick ^ current;
+
+		for (uint32_t level = 0; level < k_NumLevels; ++level)
+			if ((differing >> (k_SlotBits * (level + 1))) == 0) {
+				TimerNode*& slot = m_Levels[level][(tick >> (k_SlotBits * level)) & k_SlotMask];
+
+				node->m_Next = slot;
+				slot         = node;
+
+				if (level == 0)
+					++m_NumDue;
+
+				return;
+			}
+
+		node->m_Next = m_Overflow;
+		m_Overflow   = node;
+	}
+
+	void TimerWheel::relink(TimerNode* list, uint64_t current) noexcept {
+		while (list) {
+			TimerNode* next = list->m_Next;
+
+			link(list, current);
+			list = next;
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "../util/spinlock.h"
+
+namespace bop::job {
+	// something that is due at some point (the node is linked into the wheel itself, so adding a timer never allocates)
+	class TimerNode {
+	public:
+		virtual void expire()  noexcept = 0; // once the deadline passed (called by a worker, outside of the wheel's lock)
+		virtual void discard() noexcept = 0; // the wheel is cleared before the deadline passed
+
+		TimerNode* m_Next = nullptr;
+		uint64_t   m_Tick = 0;       // the deadline, in ticks since the start of the wheel
+
+	protected:
+		~TimerNode() = default;
+	};
+
+	// hierarchical timing wheel (Varghese & Lauck)
+	//
+	// Level 0 has a slot per tick for the current block of 64 ticks, every level above covers 64 times
+	// the range of the one below it. Adding a timer picks a level and a slot with a few bit operations;
+	// whenever a level wraps around, the next slot of the level above is spread out over the levels
+	// below it. That makes adding and expiring O(1), independent of the number of pending timers.
+	// Deadlines beyond the top level are kept in an overflow list until the wheel comes around.
+	//
+	// Deadlines are rounded up to whole ticks, so timers never expire early. The wheel only moves when
+	// advance() is called; JobSystem does that from its workers, in between jobs and before parking.
+	class TimerWheel {
+	public:
+		using Clock     = std::chrono::steady_clock;
+		using Duration  = Clock::duration;
+		using Timepoint = Clock::time_point;
+
+		static constexpr Duration k_Resolution = std::chrono::milliseconds(1); // a single tick
+		static constexpr uint64_t k_Never      = UINT64_MAX;
+
+		explicit TimerWheel(Timepoint start = Clock::now()) noexcept;
+
+		TimerWheel             (const TimerWheel&) = delete;
+		TimerWheel& operator = (const TimerWheel&) = delete;
+		TimerWheel             (TimerWheel&&)      = delete;
+		TimerWheel& operator = (TimerWheel&&)      = delete;
+
+		uint64_t   add(TimerNode* node, Timepoint deadline) noexcept; // returns the tick it will expire at
+		TimerNode* advance(Timepoint now) noexcept;                   // the timers that expired (linked via m_Next), nullptr if none or if another thread is advancing
+		void       clear() noexcept;                                  // discards all pending timers
+
+		uint64_t  next_expiry() const noexcept;           // the tick the wheel has to be advanced at next (k_Never if empty)
+		Timepoint to_timepoint(uint64_t tick) const noexcept;
+		bool      empty() const noexcept;                 // only a snapshot
+
+	private:
+		static constexpr uint32_t k_NumLevels = 4;
+		static constexpr uint32_t k_SlotBits  = 6;
+		static constexpr uint32_t k_NumSlots  = 1 << k_SlotBits;
+		static constexpr uint64_t k_SlotMask  = k_NumSlots - 1;
+
+		using Level = std::array<TimerNode*, k_NumSlots>;
+
+		void link  (TimerNode* node, uint64_t current) noexcept; // (requires the lock) puts the node in the slot for its tick
+		void relink(TimerNode* list, uint64_t current) noexcept; // (requires the lock)
+
+		mutable util::Spinlock         m_Lock;
+		Timepoint                      m_Start;
+		std::atomic<uint64_t>          m_CurrentTick = 0;       // everything up to and including this tick was expired
+		std::atomic<uint32_t>          m_NumTimers   = 0;
+		uint32_t                       m_NumDue      = 0;       // timers in level 0 (without any, the wheel may skip ahead)
+		std::array<Level, k_NumLevels> m_Levels      = {};
+		TimerNode*                     m_Overflow    = nullptr;
+	};
+}
@@ -2,13 +2,17 @@
 
 namespace bop::job {
 	JobTrace::JobTrace(
-		Timepoint start_time,
-		Timepoint current_time,
-		uint32_t  thread_index
+		Timepoint  start_time,
+		Timepoint  current_time,
+		uint32_t   thread_index,
+		Timepoint  queued_time,
+		e_Priority priority
 	) noexcept:
 		m_StartTime  (start_time),
 		m_CurrentTime(current_time),
-		m_ThreadIndex(thread_index)
+		m_QueuedTime (queued_time),
+		m_ThreadIndex(thread_index),
+		m_Priority   (priority)
 	{
 	}
 }
\ No newline at end of file
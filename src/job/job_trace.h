@@ -3,19 +3,25 @@
 #include <chrono>
 #include <cstdint>
 
+#include "job_priority.h"
+
 namespace bop::job {
 	struct JobTrace {
 		using Clock     = std::chrono::high_resolution_clock;
 		using Timepoint = Clock::time_point;
 
 		JobTrace(
-			Timepoint start_time,
-			Timepoint current_time,
-			uint32_t  thread_index
+			Timepoint  start_time,
+			Timepoint  current_time,
+			uint32_t   thread_index,
+			Timepoint  queued_time = {},
+			e_Priority priority    = e_Priority::normal
 		) noexcept;
 
-		Timepoint m_StartTime;
-		Timepoint m_CurrentTime;
-		uint32_t  m_ThreadIndex;
+		Timepoint  m_StartTime;
+		Timepoint  m_CurrentTime;
+		Timepoint  m_QueuedTime;  // when the job was put in a queue (the difference with start time is the queue wait)
+		uint32_t   m_ThreadIndex;
+		e_Priority m_Priority;
 	};
 }
\ No newline at end of file
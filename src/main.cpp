@@ -250,7 +250,7 @@ struct Foo {
 int main() {
 	std::cout << "Starting application\n";
 
-	// creating a local instance will initialize the static class, optionally with some settings
+	// the first pool that is created becomes the default one, used by bop::schedule etc.
 	bop::job::JobSystem js(std::nullopt, &g_GlobalMemoryResource);
 	bop::schedule([] { std::cout << "ping\n"; });
 
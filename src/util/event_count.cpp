@@ -0,0 +1,118 @@
+#include "event_count.h"
+#include "platform.h"
+
+#include <algorithm>
+#include <climits>
+#include <thread>
+
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+	#include <ctime>
+	#include <linux/futex.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+namespace bop::util {
+	namespace {
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+		// std::atomic<uint32_t> is layout-compatible with the 32-bit futex word
+		void futex_wait(std::atomic<uint32_t>* address, uint32_t expected) noexcept {
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+		}
+
+		// the timeout is relative (and measured against the monotonic clock, like steady_clock)
+		void futex_wait(std::atomic<uint32_t>* address, uint32_t expected, std::chrono::nanoseconds timeout) noexcept {
+			timespec ts;
+
+			ts.tv_sec  = static_cast<time_t>(timeout.count() / 1'000'000'000);
+			ts.tv_nsec = static_cast<long>  (timeout.count() % 1'000'000'000);
+
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+		}
+
+		void futex_wake(std::atomic<uint32_t>* address, int count) noexcept {
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+		}
+#endif
+	}
+
+	EventCount::Key EventCount::prepare_wait() noexcept {
+		// (seq_cst, so either the notifier sees us waiting or we see whatever it published)
+		m_Waiters.fetch_add(1, std::memory_order::seq_cst);
+
+		return m_Epoch.load(std::memory_order::seq_cst);
+	}
+
+	void EventCount::cancel_wait() noexcept {
+		m_Waiters.fetch_sub(1, std::memory_order::seq_cst);
+	}
+
+	void EventCount::wait(Key key) noexcept {
+		// the futex returns spuriously every now and then, so check the epoch each time
+		while (m_Epoch.load(std::memory_order::acquire) == key) {
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+			futex_wait(&m_Epoch, key);
+#else
+			m_Epoch.wait(key, std::memory_order::acquire);
+#endif
+		}
+
+		m_Waiters.fetch_sub(1, std::memory_order::seq_cst);
+	}
+
+	bool EventCount::wait_until(Key key, std::chrono::steady_clock::time_point deadline) noexcept {
+		bool notified = true;
+
+		while (m_Epoch.load(std::memory_order::acquire) == key) {
+			auto remaining = deadline - std::chrono::steady_clock::now();
+
+			if (remaining <= decltype(remaining)::zero()) {
+				notified = false;
+				break;
+			}
+
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+			futex_wait(&m_Epoch, key, remaining);
+#else
+			// (std::atomic::wait has no timeout, so this polls)
+			std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(remaining, std::chrono::milliseconds(1)));
+#endif
+		}
+
+		m_Waiters.fetch_sub(1, std::memory_order::seq_cst);
+
+		return notified;
+	}
+
+	void EventCount::notify_one() noexcept {
+		notify(false);
+	}
+
+	void EventCount::notify_all() noexcept {
+		notify(true);
+	}
+
+	uint32_t EventCount::get_num_waiters() const noexcept {
+		return m_Waiters.load(std::memory_order::relaxed);
+	}
+
+	void EventCount::notify(bool all) noexcept {
+		// pairs with prepare_wait; whatever the caller published before this is ordered before the check
+		std::atomic_thread_fence(std::memory_order::seq_cst);
+
+		if (m_Waiters.load(std::memory_order::seq_cst) == 0)
+			[[likely]]
+			return; // nobody to wake up, no syscall
+
+		m_Epoch.fetch_add(1, std::memory_order::seq_cst);
+
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+		futex_wake(&m_Epoch, all ? INT_MAX : 1);
+#else
+		if (all)
+			m_Epoch.notify_all();
+		else
+			m_Epoch.notify_one();
+#endif
+	}
+}
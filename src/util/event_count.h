@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace bop::util {
+	// lets threads sleep until 'something happened', without a mutex
+	//
+	// A waiter first announces itself with prepare_wait(), then re-checks its condition, and only then
+	// commits with wait() (or backs out with cancel_wait()). A notification that happens anywhere after
+	// prepare_wait() makes wait() return immediately, so no wakeups are lost. Notifying is just an atomic
+	// load when nobody is waiting; only when there are waiters a syscall is made.
+	//
+	// On linux the epoch counter is waited on directly with a futex, elsewhere std::atomic::wait is used.
+	class EventCount {
+	public:
+		using Key = uint32_t;
+
+		EventCount() noexcept = default;
+
+		EventCount             (const EventCount&) = delete;
+		EventCount& operator = (const EventCount&) = delete;
+		EventCount             (EventCount&&)      = delete;
+		EventCount& operator = (EventCount&&)      = delete;
+
+		Key  prepare_wait() noexcept;
+		void cancel_wait()  noexcept;
+		void wait(Key key)  noexcept; // blocks until a notification after the matching prepare_wait
+
+		// same, but gives up at the deadline; returns false if it did
+		bool wait_until(Key key, std::chrono::steady_clock::time_point deadline) noexcept;
+
+		void notify_one() noexcept;
+		void notify_all() noexcept;
+
+		uint32_t get_num_waiters() const noexcept; // only a snapshot
+
+	private:
+		void notify(bool all) noexcept;
+
+		std::atomic<uint32_t> m_Epoch   = 0; // bumped by every notification that had waiters
+		std::atomic<uint32_t> m_Waiters = 0; // threads between prepare_wait and the end of wait/cancel_wait
+	};
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+
+namespace bop::util {
+	template <typename t_Fn, size_t t_Size = 64>
+	class InlineFunction;
+
+	// move-only callable wrapper that is exactly t_Size bytes
+	//
+	// Callables that fit in the inline buffer (and can be moved without throwing) are stored in place,
+	// larger ones are spilled to the memory resource that was provided at construction. Which of the two
+	// is used is decided at compile time; spilled allocations are rounded up to a power of two so
+	// pooling resources can serve them from a handful of size classes.
+	template <
+		typename    t_Result,
+		typename... t_Args,
+		size_t      t_Size
+	>
+	class InlineFunction<t_Result(t_Args...), t_Size> {
+	private:
+		// a single 'manager' function pointer takes care of everything except invocation
+		enum class e_Operation {
+			relocate, // move-construct into dst, then destroy src
+			destroy
+		};
+
+		using Invoker = t_Result(*)(void*, t_Args&&...);
+		using Manager = void(*)(e_Operation, void* src, void* dst);
+
+	public:
+		static constexpr size_t k_InlineSize  = t_Size - sizeof(Invoker) - sizeof(Manager);
+		static constexpr size_t k_InlineAlign = alignof(std::max_align_t);
+
+		static_assert(t_Size > sizeof(Invoker) + sizeof(Manager) + sizeof(void*) * 2, "Too small to hold a spilled callable");
+
+		template <typename Fn>
+		static constexpr bool fits_inline() noexcept; // true if Fn is stored without any allocation
+
+		InlineFunction() noexcept = default;
+		~InlineFunction();
+
+		template <typename Fn>
+		requires (!std::is_same_v<std::remove_cvref_t<Fn>, InlineFunction>)
+		InlineFunction(
+			Fn&&                        fn,
+			std::pmr::memory_resource*  resource = std::pmr::get_default_resource() // only used when the callable doesn't fit
+		);
+
+		InlineFunction             (const InlineFunction&) = delete;
+		InlineFunction& operator = (const InlineFunction&) = delete;
+		InlineFunction             (InlineFunction&& fn) noexcept;
+		InlineFunction& operator = (InlineFunction&& fn) noexcept;
+
+		InlineFunction& operator = (std::nullptr_t) noexcept;
+
+		[[nodiscard]] explicit operator bool() const noexcept;
+
+		t_Result operator()(t_Args... args);
+
+	private:
+		// what is stored inline when the callable had to be spilled
+		template <typename Fn>
+		struct Spilled {
+			static constexpr size_t k_AllocSize = std::bit_ceil(sizeof(Fn));
+
+			Fn*                        m_Fn;
+			std::pmr::memory_resource* m_Resource;
+		};
+
+		template <typename Fn> static t_Result invoke_inline (void* storage, t_Args&&... args);
+		template <typename Fn> static t_Result invoke_spilled(void* storage, t_Args&&... args);
+		template <typename Fn> static void     manage_inline (e_Operation op, void* src, void* dst) noexcept;
+		template <typename Fn> static void     manage_spilled(e_Operation op, void* src, void* dst) noexcept;
+
+		void reset() noexcept;
+
+		Invoker m_Invoker = nullptr;
+		Manager m_Manager = nullptr;
+
+		alignas(k_InlineAlign) std::byte m_Storage[k_InlineSize];
+	};
+}
+
+#include "inline_function.inl"
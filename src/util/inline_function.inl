@@ -0,0 +1,174 @@
+#pragma once
+
+#include "inline_function.h"
+
+#include <bit>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace bop::util {
+	template <typename R, typename... Ts, size_t N>
+	template <typename Fn>
+	constexpr bool InlineFunction<R(Ts...), N>::fits_inline() noexcept {
+		using decayed = std::decay_t<Fn>;
+
+		return
+			(sizeof(decayed)  <= k_InlineSize)  &&
+			(alignof(decayed) <= k_InlineAlign) &&
+			std::is_nothrow_move_constructible_v<decayed>;
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	InlineFunction<R(Ts...), N>::~InlineFunction() {
+		reset();
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	template <typename Fn>
+	requires (!std::is_same_v<std::remove_cvref_t<Fn>, InlineFunction<R(Ts...), N>>)
+	InlineFunction<R(Ts...), N>::InlineFunction(
+		Fn&&                       fn,
+		std::pmr::memory_resource* resource
+	) {
+		using decayed = std::decay_t<Fn>;
+
+		if constexpr (fits_inline<decayed>()) {
+			new (m_Storage) decayed(std::forward<Fn>(fn)); // placement new to fill storage
+
+			m_Invoker = &invoke_inline<decayed>;
+			m_Manager = &manage_inline<decayed>;
+		}
+		else {
+			using spilled = Spilled<decayed>;
+
+			void* memory = resource->allocate(spilled::k_AllocSize, alignof(decayed));
+
+			try {
+				new (memory) decayed(std::forward<Fn>(fn));
+			}
+			catch (...) {
+				resource->deallocate(memory, spilled::k_AllocSize, alignof(decayed));
+				throw;
+			}
+
+			new (m_Storage) spilled{ static_cast<decayed*>(memory), resource };
+
+			m_Invoker = &invoke_spilled<decayed>;
+			m_Manager = &manage_spilled<decayed>;
+		}
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	InlineFunction<R(Ts...), N>::InlineFunction(InlineFunction&& fn) noexcept {
+		if (fn) {
+			fn.m_Manager(e_Operation::relocate, fn.m_Storage, m_Storage);
+
+			m_Invoker = std::exchange(fn.m_Invoker, nullptr);
+			m_Manager = std::exchange(fn.m_Manager, nullptr);
+		}
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	InlineFunction<R(Ts...), N>& InlineFunction<R(Ts...), N>::operator = (InlineFunction&& fn) noexcept {
+		if (this != &fn) {
+			reset();
+
+			if (fn) {
+				fn.m_Manager(e_Operation::relocate, fn.m_Storage, m_Storage);
+
+				m_Invoker = std::exchange(fn.m_Invoker, nullptr);
+				m_Manager = std::exchange(fn.m_Manager, nullptr);
+			}
+		}
+
+		return *this;
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	InlineFunction<R(Ts...), N>& InlineFunction<R(Ts...), N>::operator = (std::nullptr_t) noexcept {
+		reset();
+
+		return *this;
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	InlineFunction<R(Ts...), N>::operator bool() const noexcept {
+		return !!m_Invoker;
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	R InlineFunction<R(Ts...), N>::operator()(Ts... args) {
+		if (!m_Invoker)
+			throw std::bad_function_call();
+
+		return m_Invoker(m_Storage, std::forward<Ts>(args)...);
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	template <typename Fn>
+	R InlineFunction<R(Ts...), N>::invoke_inline(void* storage, Ts&&... args) {
+		return std::invoke(*std::launder(static_cast<Fn*>(storage)), std::forward<Ts>(args)...);
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	template <typename Fn>
+	R InlineFunction<R(Ts...), N>::invoke_spilled(void* storage, Ts&&... args) {
+		return std::invoke(*std::launder(static_cast<Spilled<Fn>*>(storage))->m_Fn, std::forward<Ts>(args)...);
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	template <typename Fn>
+	void InlineFunction<R(Ts...), N>::manage_inline(
+		e_Operation op,
+		void*       src,
+		void*       dst
+	) noexcept {
+		Fn* fn = std::launder(static_cast<Fn*>(src));
+
+		switch (op) {
+		case e_Operation::relocate:
+			new (dst) Fn(std::move(*fn));
+			std::destroy_at(fn);
+			break;
+
+		case e_Operation::destroy:
+			std::destroy_at(fn);
+			break;
+		}
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	template <typename Fn>
+	void InlineFunction<R(Ts...), N>::manage_spilled(
+		e_Operation op,
+		void*       src,
+		void*       dst
+	) noexcept {
+		using spilled = Spilled<Fn>;
+
+		spilled* s = std::launder(static_cast<spilled*>(src));
+
+		switch (op) {
+		case e_Operation::relocate:
+			// only the pointer moves, the callable itself stays put
+			new (dst) spilled(*s);
+			break;
+
+		case e_Operation::destroy:
+			std::destroy_at(s->m_Fn);
+			s->m_Resource->deallocate(s->m_Fn, spilled::k_AllocSize, alignof(Fn));
+			break;
+		}
+	}
+
+	template <typename R, typename... Ts, size_t N>
+	void InlineFunction<R(Ts...), N>::reset() noexcept {
+		if (m_Manager)
+			m_Manager(e_Operation::destroy, m_Storage, nullptr);
+
+		m_Invoker = nullptr;
+		m_Manager = nullptr;
+	}
+}
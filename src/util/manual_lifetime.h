@@ -6,6 +6,9 @@ namespace bop::util {
 	template <typename T>
 	class ManualLifetime final {
 	public:
+		ManualLifetime() noexcept;
+		~ManualLifetime();
+
 		template <typename...t_Args>
 		void construct(t_Args&&... args);
 		void destroy();
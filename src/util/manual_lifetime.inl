@@ -4,6 +4,15 @@
 #include <utility>
 
 namespace bop::util {
+	// the union member is neither constructed nor destroyed implicitly
+	template <typename T>
+	ManualLifetime<T>::ManualLifetime() noexcept {
+	}
+
+	template <typename T>
+	ManualLifetime<T>::~ManualLifetime() {
+	}
+
 	template <typename T>
 	template <typename...t_Args>
 	void ManualLifetime<T>::construct(t_Args&&... args) {
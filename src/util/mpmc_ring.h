@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "cacheline.h"
+#include "manual_lifetime.h"
+
+namespace bop::util {
+	// bounded, lock-free multi-producer/multi-consumer queue backed by a fixed array
+	// each slot carries a sequence number that tells producers and consumers whether it is
+	// ready for them, so a push/pop only touches the ring itself and never the stored object
+	//
+	// based on Dmitry Vyukov's bounded MPMC queue
+	// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+	template <typename T>
+	class MpmcRing {
+	public:
+		explicit MpmcRing(uint32_t capacity); // rounded up to a power of two
+		~MpmcRing();
+
+		MpmcRing             (const MpmcRing&) = delete;
+		MpmcRing& operator = (const MpmcRing&) = delete;
+		MpmcRing             (MpmcRing&&)      = delete;
+		MpmcRing& operator = (MpmcRing&&)      = delete;
+
+		template <typename U>
+		bool try_push(U&& value); // returns false if the ring is full (value is left untouched)
+		bool try_pop(T& result);  // returns false if the ring is empty
+		bool try_pop_into(std::optional<T>& result); // same, but constructs the result in place
+
+		uint32_t size()     const noexcept; // only a snapshot when other threads are active
+		uint32_t capacity() const noexcept;
+		bool     empty()    const noexcept;
+
+	private:
+		template <typename Fn>
+		bool try_pop_with(Fn&& take); // take(T&) moves the value out of the slot
+
+		struct Slot {
+			std::atomic<uint64_t> m_Sequence;
+			ManualLifetime<T>     m_Value;
+		};
+
+		uint64_t                m_Mask;
+		std::unique_ptr<Slot[]> m_Slots;
+
+		// producers and consumers each have their own cacheline
+		alignas(hardware_destructive_interference_size) std::atomic<uint64_t> m_PushPosition = 0;
+		alignas(hardware_destructive_interference_size) std::atomic<uint64_t> m_PopPosition  = 0;
+	};
+}
+
+#include "mpmc_ring.inl"
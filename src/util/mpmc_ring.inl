@@ -0,0 +1,124 @@
+#pragma once
+
+#include "mpmc_ring.h"
+
+#include <bit>
+#include <utility>
+
+namespace bop::util {
+	template <typename T>
+	MpmcRing<T>::MpmcRing(uint32_t capacity) {
+		if (capacity < 2)
+			capacity = 2;
+
+		uint64_t num_slots = std::bit_ceil(capacity);
+
+		m_Mask  = num_slots - 1;
+		m_Slots = std::make_unique<Slot[]>(num_slots);
+
+		// a slot is writable when its sequence matches the push position
+		for (uint64_t i = 0; i < num_slots; ++i)
+			m_Slots[i].m_Sequence.store(i, std::memory_order::relaxed);
+	}
+
+	template <typename T>
+	MpmcRing<T>::~MpmcRing() {
+		// (no other threads should be accessing the ring anymore)
+		uint64_t first = m_PopPosition.load(std::memory_order::acquire);
+		uint64_t last  = m_PushPosition.load(std::memory_order::acquire);
+
+		for (uint64_t position = first; position != last; ++position)
+			m_Slots[position & m_Mask].m_Value.destroy();
+	}
+
+	template <typename T>
+	template <typename U>
+	bool MpmcRing<T>::try_push(U&& value) {
+		uint64_t position = m_PushPosition.load(std::memory_order::relaxed);
+
+		while (true) {
+			Slot&    slot     = m_Slots[position & m_Mask];
+			uint64_t sequence = slot.m_Sequence.load(std::memory_order::acquire);
+			int64_t  diff     = static_cast<int64_t>(sequence - position);
+
+			if (diff == 0) {
+				// slot is free, try to claim it
+				if (m_PushPosition.compare_exchange_weak(
+					position,
+					position + 1,
+					std::memory_order::relaxed
+				)) {
+					slot.m_Value.construct(std::forward<U>(value));
+					slot.m_Sequence.store(position + 1, std::memory_order::release);
+					return true;
+				}
+				// (position was reloaded by the failed CAS)
+			}
+			else if (diff < 0)
+				return false; // full; the slot still holds a value from the previous lap
+			else
+				position = m_PushPosition.load(std::memory_order::relaxed); // another producer got here first
+		}
+	}
+
+	template <typename T>
+	bool MpmcRing<T>::try_pop(T& result) {
+		return try_pop_with([&](T& value) { result = std::move(value); });
+	}
+
+	template <typename T>
+	bool MpmcRing<T>::try_pop_into(std::optional<T>& result) {
+		return try_pop_with([&](T& value) { result.emplace(std::move(value)); });
+	}
+
+	template <typename T>
+	template <typename Fn>
+	bool MpmcRing<T>::try_pop_with(Fn&& take) {
+		uint64_t position = m_PopPosition.load(std::memory_order::relaxed);
+
+		while (true) {
+			Slot&    slot     = m_Slots[position & m_Mask];
+			uint64_t sequence = slot.m_Sequence.load(std::memory_order::acquire);
+			int64_t  diff     = static_cast<int64_t>(sequence - (position + 1));
+
+			if (diff == 0) {
+				if (m_PopPosition.compare_exchange_weak(
+					position,
+					position + 1,
+					std::memory_order::relaxed
+				)) {
+					take(slot.m_Value.get());
+					slot.m_Value.destroy();
+
+					// mark the slot as writable for the next lap
+					slot.m_Sequence.store(position + m_Mask + 1, std::memory_order::release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+				return false; // empty
+			else
+				position = m_PopPosition.load(std::memory_order::relaxed);
+		}
+	}
+
+	template <typename T>
+	uint32_t MpmcRing<T>::size() const noexcept {
+		uint64_t pushed = m_PushPosition.load(std::memory_order::relaxed);
+		uint64_t popped = m_PopPosition.load(std::memory_order::relaxed);
+
+		return (pushed > popped) ?
+			static_cast<uint32_t>(pushed - popped) :
+			0;
+	}
+
+	template <typename T>
+	uint32_t MpmcRing<T>::capacity() const noexcept {
+		return static_cast<uint32_t>(m_Mask + 1);
+	}
+
+	template <typename T>
+	bool MpmcRing<T>::empty() const noexcept {
+		return size() == 0;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "cacheline.h"
+#include "manual_lifetime.h"
+
+namespace bop::util {
+	// bounded, lock-free single-producer/single-consumer queue backed by a fixed array
+	// each side owns its own index and keeps a cached copy of the other one, so it only
+	// touches the other side's cacheline when the cached copy says the ring is full (or empty)
+	//
+	// exactly one thread may push and exactly one (other) thread may pop at any time
+	template <typename T>
+	class SpscRing {
+	public:
+		explicit SpscRing(uint32_t capacity); // exact; the slots are rounded up to a power of two
+		~SpscRing();
+
+		SpscRing             (const SpscRing&) = delete;
+		SpscRing& operator = (const SpscRing&) = delete;
+		SpscRing             (SpscRing&&)      = delete;
+		SpscRing& operator = (SpscRing&&)      = delete;
+
+		// producer side
+		template <typename U>
+		bool try_push(U&& value); // returns false if the ring is full (value is left untouched)
+		bool full() const noexcept;
+
+		// consumer side
+		T*   front() noexcept;    // nullptr if the ring is empty
+		void pop() noexcept;      // requires a preceding non-null front()
+		bool try_pop(T& result);  // returns false if the ring is empty
+
+		uint32_t size()     const noexcept; // only a snapshot when the other side is active
+		uint32_t capacity() const noexcept;
+		bool     empty()    const noexcept;
+
+	private:
+		uint64_t                             m_Mask;
+		uint32_t                             m_Capacity;
+		std::unique_ptr<ManualLifetime<T>[]> m_Slots;
+
+		// producer cacheline
+		alignas(hardware_destructive_interference_size) std::atomic<uint64_t> m_PushPosition = 0;
+		uint64_t                                                              m_CachedPop    = 0;
+
+		// consumer cacheline
+		alignas(hardware_destructive_interference_size) std::atomic<uint64_t> m_PopPosition  = 0;
+		uint64_t                                                              m_CachedPush   = 0;
+	};
+}
+
+#include "spsc_ring.inl"
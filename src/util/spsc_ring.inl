@@ -0,0 +1,111 @@
+#pragma once
+
+#include "spsc_ring.h"
+
+#include <bit>
+#include <utility>
+
+namespace bop::util {
+	template <typename T>
+	SpscRing<T>::SpscRing(uint32_t capacity) {
+		if (capacity < 1)
+			capacity = 1;
+
+		uint64_t num_slots = std::bit_ceil(capacity);
+
+		m_Mask     = num_slots - 1;
+		m_Capacity = capacity;
+		m_Slots    = std::make_unique<ManualLifetime<T>[]>(num_slots);
+	}
+
+	template <typename T>
+	SpscRing<T>::~SpscRing() {
+		// (no other threads should be accessing the ring anymore)
+		uint64_t first = m_PopPosition.load(std::memory_order::acquire);
+		uint64_t last  = m_PushPosition.load(std::memory_order::acquire);
+
+		for (uint64_t position = first; position != last; ++position)
+			m_Slots[position & m_Mask].destroy();
+	}
+
+	template <typename T>
+	template <typename U>
+	bool SpscRing<T>::try_push(U&& value) {
+		uint64_t position = m_PushPosition.load(std::memory_order::relaxed);
+
+		if (position - m_CachedPop >= m_Capacity) {
+			m_CachedPop = m_PopPosition.load(std::memory_order::acquire);
+
+			if (position - m_CachedPop >= m_Capacity)
+				return false;
+		}
+
+		m_Slots[position & m_Mask].construct(std::forward<U>(value));
+		m_PushPosition.store(position + 1, std::memory_order::release);
+
+		return true;
+	}
+
+	template <typename T>
+	bool SpscRing<T>::full() const noexcept {
+		uint64_t pushed = m_PushPosition.load(std::memory_order::relaxed);
+		uint64_t popped = m_PopPosition.load(std::memory_order::acquire);
+
+		return (pushed - popped) >= m_Capacity;
+	}
+
+	template <typename T>
+	T* SpscRing<T>::front() noexcept {
+		uint64_t position = m_PopPosition.load(std::memory_order::relaxed);
+
+		if (position == m_CachedPush) {
+			m_CachedPush = m_PushPosition.load(std::memory_order::acquire);
+
+			if (position == m_CachedPush)
+				return nullptr;
+		}
+
+		return &m_Slots[position & m_Mask].get();
+	}
+
+	template <typename T>
+	void SpscRing<T>::pop() noexcept {
+		uint64_t position = m_PopPosition.load(std::memory_order::relaxed);
+
+		m_Slots[position & m_Mask].destroy();
+		m_PopPosition.store(position + 1, std::memory_order::release);
+	}
+
+	template <typename T>
+	bool SpscRing<T>::try_pop(T& result) {
+		T* value = front();
+
+		if (!value)
+			return false;
+
+		result = std::move(*value);
+		pop();
+
+		return true;
+	}
+
+	template <typename T>
+	uint32_t SpscRing<T>::size() const noexcept {
+		uint64_t popped = m_PopPosition.load(std::memory_order::acquire);
+		uint64_t pushed = m_PushPosition.load(std::memory_order::acquire);
+
+		return (pushed > popped) ?
+			static_cast<uint32_t>(pushed - popped) :
+			0;
+	}
+
+	template <typename T>
+	uint32_t SpscRing<T>::capacity() const noexcept {
+		return m_Capacity;
+	}
+
+	template <typename T>
+	bool SpscRing<T>::empty() const noexcept {
+		return size() == 0;
+	}
+}
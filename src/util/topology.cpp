@@ -0,0 +1,361 @@
+#include "topology.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+
+namespace bop::util {
+	namespace {
+		std::optional<std::string> read_line(const std::filesystem::path& p) {
+			std::ifstream in(p);
+			std::string   result;
+
+			if (!in.good() || !std::getline(in, result))
+				return std::nullopt;
+
+			return result;
+		}
+
+		std::optional<uint32_t> read_uint(const std::filesystem::path& p) {
+			auto line = read_line(p);
+			if (!line)
+				return std::nullopt;
+
+			uint32_t result = 0;
+			auto [ptr, ec] = std::from_chars(line->data(), line->data() + line->size(), result);
+
+			if (ec != std::errc())
+				return std::nullopt;
+
+			return result;
+		}
+
+		// parses the number following a prefix, e.g. ("node12", "node") -> 12
+		std::optional<uint32_t> parse_suffix(
+			std::string_view name,
+			std::string_view prefix
+		) {
+			if (!name.starts_with(prefix))
+				return std::nullopt;
+
+			name.remove_prefix(prefix.size());
+
+			uint32_t result = 0;
+			auto [ptr, ec] = std::from_chars(name.data(), name.data() + name.size(), result);
+
+			if ((ec != std::errc()) || (ptr != name.data() + name.size()))
+				return std::nullopt;
+
+			return result;
+		}
+
+		// maps arbitrary keys to 0..N-1 in order of first appearance
+		template <typename K>
+		class DenseIds {
+		public:
+			uint32_t operator()(const K& key) {
+				auto [it, inserted] = m_Ids.try_emplace(key, static_cast<uint32_t>(m_Ids.size()));
+				return it->second;
+			}
+
+			uint32_t size() const noexcept {
+				return static_cast<uint32_t>(m_Ids.size());
+			}
+
+		private:
+			std::map<K, uint32_t> m_Ids;
+		};
+
+		constexpr uint32_t k_NoCacheInfo = 1u << 31; // tags a cache group that was derived from the package instead
+	}
+
+	CpuTopology CpuTopology::detect(const std::filesystem::path& sysfs_root) {
+		namespace fs = std::filesystem;
+
+		auto fallback = [] {
+			return flat(std::max(std::thread::hardware_concurrency(), 1u));
+		};
+
+		auto online = read_line(sysfs_root / "cpu" / "online");
+		if (!online)
+			return fallback();
+
+		auto cpus = parse_cpu_list(*online);
+		if (cpus.empty())
+			return fallback();
+
+		// numa nodes list their cpus, not the other way around
+		std::map<uint32_t, uint32_t> numa_node_of;
+		std::error_code              ec;
+
+		for (const auto& entry : fs::directory_iterator(sysfs_root / "node", ec)) {
+			auto node = parse_suffix(entry.path().filename().string(), "node");
+			if (!node)
+				continue;
+
+			if (auto cpulist = read_line(entry.path() / "cpulist"))
+				for (uint32_t cpu : parse_cpu_list(*cpulist))
+					numa_node_of[cpu] = *node;
+		}
+
+		// gather the raw ids first, these are made dense afterwards
+		CpuTopology result;
+
+		for (uint32_t cpu : cpus) {
+			fs::path cpu_dir = sysfs_root / "cpu" / ("cpu" + std::to_string(cpu));
+
+			CpuInfo info;
+
+			info.m_Cpu      = cpu;
+			info.m_Package  = read_uint(cpu_dir / "topology" / "physical_package_id").value_or(0);
+			info.m_Core     = read_uint(cpu_dir / "topology" / "core_id").value_or(cpu);
+			info.m_NumaNode = numa_node_of.contains(cpu) ? numa_node_of[cpu] : 0;
+
+			// the last level cache is the highest level data/unified cache,
+			// identified by the first cpu that shares it
+			uint32_t best_level = 0;
+
+			info.m_CacheGroup = k_NoCacheInfo | info.m_Package;
+
+			for (const auto& entry : fs::directory_iterator(cpu_dir / "cache", ec)) {
+				if (!parse_suffix(entry.path().filename().string(), "index"))
+					continue;
+
+				if (read_line(entry.path() / "type") == "Instruction")
+					continue;
+
+				auto level  = read_uint(entry.path() / "level");
+				auto shared = read_line(entry.path() / "shared_cpu_list");
+
+				if (!level || !shared || (*level <= best_level))
+					continue;
+
+				if (auto sharing = parse_cpu_list(*shared); !sharing.empty()) {
+					best_level        = *level;
+					info.m_CacheGroup = sharing.front();
+				}
+			}
+
+			result.m_Cpus.push_back(info);
+		}
+
+		result.finalize();
+
+		return result;
+	}
+
+	CpuTopology CpuTopology::flat(uint32_t num_cpus) {
+		CpuTopology result;
+
+		for (uint32_t i = 0; i < num_cpus; ++i)
+			result.m_Cpus.push_back(CpuInfo{
+				.m_Cpu  = i,
+				.m_Core = i
+			});
+
+		result.finalize();
+
+		return result;
+	}
+
+	const std::vector<CpuInfo>& CpuTopology::get_cpus() const noexcept {
+		return m_Cpus;
+	}
+
+	uint32_t CpuTopology::get_num_cpus() const noexcept {
+		return static_cast<uint32_t>(m_Cpus.size());
+	}
+
+	uint32_t CpuTopology::get_num_cores() const noexcept {
+		return m_NumCores;
+	}
+
+	uint32_t CpuTopology::get_num_packages() const noexcept {
+		return m_NumPackages;
+	}
+
+	uint32_t CpuTopology::get_num_cache_groups() const noexcept {
+		return m_NumCacheGroups;
+	}
+
+	uint32_t CpuTopology::get_num_numa_nodes() const noexcept {
+		return m_NumNumaNodes;
+	}
+
+	std::vector<uint32_t> CpuTopology::get_smt_siblings(uint32_t cpu) const {
+		std::vector<uint32_t> result;
+
+		auto it = std::ranges::find(m_Cpus, cpu, &CpuInfo::m_Cpu);
+		if (it == m_Cpus.end())
+			return result;
+
+		for (const auto& info : m_Cpus)
+			if (info.m_Core == it->m_Core)
+				result.push_back(info.m_Cpu);
+
+		return result;
+	}
+
+	std::vector<uint32_t> CpuTopology::compact_order() const {
+		std::vector<CpuInfo> sorted = m_Cpus;
+
+		std::ranges::stable_sort(sorted, {}, [](const CpuInfo& info) {
+			return std::tie(
+				info.m_NumaNode,
+				info.m_CacheGroup,
+				info.m_Core,
+				info.m_SmtRank
+			);
+		});
+
+		std::vector<uint32_t> result;
+
+		for (const auto& info : sorted)
+			result.push_back(info.m_Cpu);
+
+		return result;
+	}
+
+	std::vector<uint32_t> CpuTopology::scatter_order() const {
+		// order the cache groups such that consecutive ones are on different numa nodes
+		std::vector<uint32_t> group_node(m_NumCacheGroups, 0);
+
+		for (const auto& info : m_Cpus)
+			group_node[info.m_CacheGroup] = info.m_NumaNode;
+
+		std::vector<uint32_t> groups;
+		std::vector<uint32_t> group_rank(m_NumCacheGroups, 0); // position of the group within its node
+		std::vector<uint32_t> node_groups(m_NumNumaNodes, 0);
+
+		for (uint32_t group = 0; group < m_NumCacheGroups; ++group) {
+			group_rank[group] = node_groups[group_node[group]]++;
+			groups.push_back(group);
+		}
+
+		std::ranges::stable_sort(groups, {}, [&](uint32_t group) {
+			return std::pair(group_rank[group], group_node[group]);
+		});
+
+		// then round robin over the groups, first with one cpu per core before going for the SMT siblings
+		std::vector<uint32_t> compact = compact_order();
+		std::vector<uint32_t> result;
+
+		uint32_t max_smt_rank = 0;
+		for (const auto& info : m_Cpus)
+			max_smt_rank = std::max(max_smt_rank, info.m_SmtRank);
+
+		for (uint32_t rank = 0; rank <= max_smt_rank; ++rank) {
+			std::vector<std::vector<uint32_t>> buckets(m_NumCacheGroups);
+
+			for (uint32_t cpu : compact) {
+				const auto& info = *std::ranges::find(m_Cpus, cpu, &CpuInfo::m_Cpu);
+
+				if (info.m_SmtRank == rank)
+					buckets[info.m_CacheGroup].push_back(cpu);
+			}
+
+			for (size_t i = 0; result.size() < m_Cpus.size(); ++i) {
+				bool any = false;
+
+				for (uint32_t group : groups)
+					if (i < buckets[group].size()) {
+						result.push_back(buckets[group][i]);
+						any = true;
+					}
+
+				if (!any)
+					break;
+			}
+		}
+
+		return result;
+	}
+
+	std::vector<uint32_t> CpuTopology::physical_core_order() const {
+		std::vector<uint32_t> result;
+
+		for (uint32_t cpu : compact_order())
+			if (std::ranges::find(m_Cpus, cpu, &CpuInfo::m_Cpu)->m_SmtRank == 0)
+				result.push_back(cpu);
+
+		return result;
+	}
+
+	void CpuTopology::finalize() {
+		std::ranges::sort(m_Cpus, {}, &CpuInfo::m_Cpu);
+
+		DenseIds<std::pair<uint32_t, uint32_t>> cores; // core ids are only unique within a package
+		DenseIds<uint32_t>                      packages;
+		DenseIds<uint32_t>                      cache_groups;
+		DenseIds<uint32_t>                      numa_nodes;
+
+		std::vector<uint32_t> siblings_seen;
+
+		for (auto& info : m_Cpus) {
+			info.m_Core       = cores({ info.m_Package, info.m_Core });
+			info.m_Package    = packages(info.m_Package);
+			info.m_CacheGroup = cache_groups(info.m_CacheGroup);
+			info.m_NumaNode   = numa_nodes(info.m_NumaNode);
+
+			if (info.m_Core >= siblings_seen.size())
+				siblings_seen.resize(info.m_Core + 1, 0);
+
+			info.m_SmtRank = siblings_seen[info.m_Core]++;
+		}
+
+		m_NumCores       = cores.size();
+		m_NumPackages    = packages.size();
+		m_NumCacheGroups = cache_groups.size();
+		m_NumNumaNodes   = numa_nodes.size();
+	}
+
+	std::vector<uint32_t> parse_cpu_list(std::string_view list) {
+		std::vector<uint32_t> result;
+
+		auto parse = [](std::string_view sv, uint32_t& value) {
+			while (!sv.empty() && std::isspace(static_cast<unsigned char>(sv.front())))
+				sv.remove_prefix(1);
+			while (!sv.empty() && std::isspace(static_cast<unsigned char>(sv.back())))
+				sv.remove_suffix(1);
+
+			auto [ptr, ec] = std::from_chars(sv.data(), sv.data() + sv.size(), value);
+
+			return
+				!sv.empty() &&
+				(ec == std::errc()) &&
+				(ptr == sv.data() + sv.size());
+		};
+
+		while (!list.empty()) {
+			size_t           comma = list.find(',');
+			std::string_view token = list.substr(0, comma);
+
+			list = (comma == std::string_view::npos) ?
+				std::string_view() :
+				list.substr(comma + 1);
+
+			size_t   dash  = token.find('-');
+			uint32_t first = 0;
+			uint32_t last  = 0;
+
+			if (dash == std::string_view::npos) {
+				if (parse(token, first))
+					result.push_back(first);
+			}
+			else if (
+				parse(token.substr(0, dash),  first) &&
+				parse(token.substr(dash + 1), last)
+			)
+				for (uint32_t cpu = first; cpu <= last; ++cpu)
+					result.push_back(cpu);
+		}
+
+		return result;
+	}
+}
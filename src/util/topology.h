@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace bop::util {
+	// a single logical processor; all ids are dense (0..N-1), except for the OS index
+	struct CpuInfo {
+		uint32_t m_Cpu        = 0; // OS index, as used in affinity masks
+		uint32_t m_Core       = 0; // physical core, shared by SMT siblings
+		uint32_t m_Package    = 0; // socket
+		uint32_t m_CacheGroup = 0; // processors that share the last level cache
+		uint32_t m_NumaNode   = 0;
+		uint32_t m_SmtRank    = 0; // position among the SMT siblings of the core (0 for the first one)
+	};
+
+	// processor layout as reported by the OS
+	// on linux this is read from sysfs, if that is not available every logical processor is
+	// treated as a separate core in a single cache group/numa node
+	class CpuTopology {
+	public:
+		static CpuTopology detect(const std::filesystem::path& sysfs_root = "/sys/devices/system");
+		static CpuTopology flat(uint32_t num_cpus);
+
+		const std::vector<CpuInfo>& get_cpus() const noexcept; // ordered by OS index
+
+		uint32_t get_num_cpus()         const noexcept;
+		uint32_t get_num_cores()        const noexcept;
+		uint32_t get_num_packages()     const noexcept;
+		uint32_t get_num_cache_groups() const noexcept;
+		uint32_t get_num_numa_nodes()   const noexcept;
+
+		std::vector<uint32_t> get_smt_siblings(uint32_t cpu) const; // OS indices, including the cpu itself
+
+		// cpu orderings (OS indices) for worker placement
+		std::vector<uint32_t> compact_order()       const; // SMT siblings first, then cores sharing a cache, then the next cache group/node
+		std::vector<uint32_t> scatter_order()       const; // spread over numa nodes and cache groups, physical cores before SMT siblings
+		std::vector<uint32_t> physical_core_order() const; // a single cpu per physical core, in compact order
+
+	private:
+		void finalize(); // assigns dense ids and counts
+
+		std::vector<CpuInfo> m_Cpus;
+
+		uint32_t m_NumCores       = 0;
+		uint32_t m_NumPackages    = 0;
+		uint32_t m_NumCacheGroups = 0;
+		uint32_t m_NumNumaNodes   = 0;
+	};
+
+	// parses the linux cpu list format, e.g. "0-3,8,10-11" -> { 0, 1, 2, 3, 8, 10, 11 }
+	std::vector<uint32_t> parse_cpu_list(std::string_view list);
+}
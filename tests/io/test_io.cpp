@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../../src/io/io_context.h"
+#include "../../src/job/co_job.h"
+#include "../../src/job/co_when.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using namespace std::chrono_literals;
+
+    using bop::io::IoContext;
+    using bop::job::CoJob;
+
+    // an unlinked temporary file, closed when this goes away
+    struct TempFile {
+        TempFile() {
+            char name[] = "/tmp/bop_test_io_XXXXXX";
+
+            m_Fd = mkstemp(name);
+            unlink(name);
+        }
+
+        ~TempFile() {
+            if (m_Fd >= 0)
+                close(m_Fd);
+        }
+
+        int m_Fd;
+    };
+
+    std::vector<std::byte> make_pattern(size_t size, int seed) {
+        std::vector<std::byte> result(size);
+
+        for (size_t i = 0; i < size; ++i)
+            result[i] = static_cast<std::byte>((i * 31 + seed) & 0xFF);
+
+        return result;
+    }
+
+    CoJob<bool> round_trip(IoContext& context, int fd, size_t size) {
+        auto written = make_pattern(size, 7);
+
+        if (co_await context.write(fd, written, 0) != size)
+            co_return false;
+
+        co_await context.fsync(fd);
+        co_await context.fsync(fd, true);
+
+        std::vector<std::byte> read(size + 16); // (reading past the end is cut short)
+
+        if (co_await context.read(fd, read, 0) != size)
+            co_return false;
+
+        if (co_await context.read(fd, read, size) != 0)
+            co_return false;
+
+        co_return std::equal(written.begin(), written.end(), read.begin());
+    }
+
+    CoJob<int> read_failure(IoContext& context) {
+        std::byte buffer[16];
+
+        try {
+            co_await context.read(-1, buffer, 0);
+        }
+        catch (const std::system_error& e) {
+            co_return e.code().value();
+        }
+
+        co_return 0;
+    }
+
+    CoJob<bool> registered_round_trip(IoContext& context, int fd) {
+        auto buffer = context.acquire_buffer();
+
+        if (!buffer)
+            co_return false;
+
+        auto data    = buffer->data();
+        auto pattern = make_pattern(data.size(), 3);
+
+        std::copy(pattern.begin(), pattern.end(), data.begin());
+
+        if (co_await context.write(fd, data, 0) != data.size())
+            co_return false;
+
+        std::fill(data.begin(), data.end(), std::byte{ 0 });
+
+        // (part of a buffer goes as well)
+        if (co_await context.read(fd, data.subspan(0, 100), 0) != 100)
+            co_return false;
+
+        co_return std::equal(data.begin(), data.begin() + 100, pattern.begin());
+    }
+
+    CoJob<bool> read_block(int fd, size_t block, size_t block_size) {
+        std::vector<std::byte> buffer(block_size);
+
+        if (co_await bop::io::read(fd, buffer, block * block_size) != block_size)
+            co_return false;
+
+        co_return std::all_of(buffer.begin(), buffer.end(), [&](std::byte b) {
+            return b == static_cast<std::byte>(block & 0xFF);
+        });
+    }
+
+    CoJob<size_t> read_many(int fd, size_t num_blocks, size_t block_size) {
+        std::vector<CoJob<bool>> readers;
+
+        for (size_t i = 0; i < num_blocks; ++i)
+            readers.push_back(read_block(fd, i, block_size));
+
+        size_t correct = 0;
+
+        for (bool ok : co_await bop::job::when_all(std::move(readers)))
+            if (ok)
+                ++correct;
+
+        co_return correct;
+    }
+
+    // (zero while the read is pending)
+    CoJob<> read_pipe(IoContext& context, int fd, std::atomic<size_t>& num_read) {
+        std::byte buffer[16];
+
+        num_read = co_await context.read(fd, buffer, 0) + 1;
+    }
+
+    template <typename Predicate>
+    bool wait_until_true(Predicate pred, std::chrono::milliseconds timeout = 5s) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        while (!pred())
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            else
+                std::this_thread::sleep_for(1ms);
+
+        return true;
+    }
+}
+
+TEST_CASE("test_io[round_trip]") {
+    using bop::io::e_Backend;
+    using bop::io::IoContext;
+
+    // io_uring where available, and the blocking fallback (a pool has a single context)
+    for (auto backend : { e_Backend::automatic, e_Backend::io_uring, e_Backend::blocking }) {
+        bop::job::JobSystem pool(2);
+
+        IoContext* context = nullptr;
+
+        try {
+            context = &IoContext::get(pool, backend);
+        }
+        catch (const std::runtime_error&) {
+            REQUIRE(backend == e_Backend::io_uring); // (not available here)
+            continue;
+        }
+
+        if (backend != e_Backend::automatic)
+            REQUIRE(context->get_backend() == backend);
+
+        testing::TempFile file;
+        REQUIRE(file.m_Fd >= 0);
+
+        std::atomic<int> ok = 0;
+
+        // (the workers find the context that was set up above)
+        pool.schedule([&] {
+            if (testing::round_trip(IoContext::get(), file.m_Fd, 10'000).get())
+                ++ok;
+        });
+
+        REQUIRE(testing::wait_until_true([&] { return ok == 1; }));
+        REQUIRE(&pool.get_poller<IoContext>() == context);
+        REQUIRE(context->get_num_pending() == 0);
+    }
+}
+
+TEST_CASE("test_io[error]") {
+    bop::job::JobSystem pool(1);
+
+    std::atomic<int> code = 0;
+
+    pool.schedule([&] { code = testing::read_failure(pool.get_poller<bop::io::IoContext>()).get(); });
+
+    REQUIRE(testing::wait_until_true([&] { return code != 0; }));
+    REQUIRE(code == EBADF);
+}
+
+TEST_CASE("test_io[registered]") {
+    bop::job::JobSystem pool(2);
+
+    auto& context = pool.get_poller<bop::io::IoContext>();
+
+    REQUIRE(!context.acquire_buffer());
+
+    context.register_buffers(4, 1000);
+
+    REQUIRE_THROWS_AS(context.register_buffers(4, 1000), std::logic_error);
+
+    {
+        // all of them are handed out once, and come back when released
+        std::vector<bop::io::RegisteredBuffer> buffers;
+
+        while (auto buffer = context.acquire_buffer()) {
+            REQUIRE(buffer->data().size() >= 1000);
+            buffers.push_back(std::move(*buffer));
+        }
+
+        REQUIRE(buffers.size() == 4);
+    }
+
+    testing::TempFile file;
+    REQUIRE(file.m_Fd >= 0);
+
+    std::atomic<int> ok = 0;
+
+    pool.schedule([&] {
+        if (testing::registered_round_trip(context, file.m_Fd).get())
+            ++ok;
+    });
+
+    REQUIRE(testing::wait_until_true([&] { return ok == 1; }));
+}
+
+TEST_CASE("test_io[concurrent]") {
+    constexpr size_t k_NumBlocks = 200;
+    constexpr size_t k_BlockSize = 512;
+
+    testing::TempFile file;
+    REQUIRE(file.m_Fd >= 0);
+
+    for (size_t i = 0; i < k_NumBlocks; ++i) {
+        std::vector<std::byte> block(k_BlockSize, static_cast<std::byte>(i & 0xFF));
+        REQUIRE(pwrite(file.m_Fd, block.data(), block.size(), i * k_BlockSize) == static_cast<ssize_t>(k_BlockSize));
+    }
+
+    for (uint32_t num_threads : { 1u, 4u }) {
+        bop::job::JobSystem pool(num_threads);
+
+        std::atomic<size_t> correct = 0;
+        std::atomic<bool>   done    = false;
+
+        pool.schedule([&] {
+            correct = testing::read_many(file.m_Fd, k_NumBlocks, k_BlockSize).get();
+            done    = true;
+        });
+
+        REQUIRE(testing::wait_until_true([&] { return done.load(); }));
+        REQUIRE(correct == k_NumBlocks);
+    }
+}
+
+TEST_CASE("test_io[pinned]") {
+    using namespace std::chrono_literals;
+    using bop::io::e_Backend;
+    using bop::io::IoContext;
+
+    // the only worker blocks in the ring while the read is pending, a job for just that worker interrupts it
+    bop::job::JobSystem pool(1);
+
+    IoContext* context = nullptr;
+
+    try {
+        context = &IoContext::get(pool, e_Backend::io_uring);
+    }
+    catch (const std::runtime_error&) {
+        return; // (not available here)
+    }
+
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+
+    std::atomic<size_t>              num_read = 0;
+    std::atomic<bool>                pinned   = false;
+    std::optional<bop::job::CoJob<>> reader;
+
+    // (started without anyone waiting for it, so the worker is free to block)
+    pool.schedule([&] {
+        reader.emplace(testing::read_pipe(*context, fds[0], num_read));
+        bop::job::schedule_coroutine(reader->get_handle());
+    });
+
+    REQUIRE(testing::wait_until_true([&] { return context->get_num_pending() == 1; }));
+    std::this_thread::sleep_for(50ms);
+
+    pool.schedule([&] { pinned = true; }, nullptr, 0);
+
+    REQUIRE(testing::wait_until_true([&] { return pinned.load(); }, 1s));
+    REQUIRE(num_read == 0);
+
+    REQUIRE(write(fds[1], "x", 1) == 1);
+    REQUIRE(testing::wait_until_true([&] { return num_read == 2; }));
+
+    // (the coroutine is done running once the worker stopped)
+    pool.shutdown();
+    pool.wait_for_shutdown();
+
+    close(fds[0]);
+    close(fds[1]);
+}
@@ -0,0 +1,346 @@
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../../src/io/io_reactor.h"
+#include "../../src/job/co_job.h"
+#include "../../src/job/co_resume.h"
+#include "../../src/job/co_when.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using namespace std::chrono_literals;
+
+    using bop::io::Pollable;
+    using bop::job::CoJob;
+
+    // reads exactly the given number of bytes, waiting whenever there's nothing to read
+    CoJob<std::string> read_exactly(Pollable& pollable, size_t size) {
+        std::string result;
+        char        buffer[256];
+
+        while (result.size() < size) {
+            ssize_t n = ::read(pollable.get_fd(), buffer, std::min(sizeof(buffer), size - result.size()));
+
+            if (n > 0)
+                result.append(buffer, static_cast<size_t>(n));
+            else if (n == 0)
+                break; // (closed)
+            else if (errno == EAGAIN)
+                co_await pollable.readable();
+            else
+                throw std::system_error(errno, std::system_category());
+        }
+
+        co_return result;
+    }
+
+    CoJob<size_t> write_all(Pollable& pollable, std::string data) {
+        size_t written = 0;
+
+        while (written < data.size()) {
+            ssize_t n = ::write(pollable.get_fd(), data.data() + written, data.size() - written);
+
+            if (n >= 0)
+                written += static_cast<size_t>(n);
+            else if (errno == EAGAIN)
+                co_await pollable.writable();
+            else
+                throw std::system_error(errno, std::system_category());
+        }
+
+        co_return written;
+    }
+
+    // echoes a single message back, then answers the client
+    CoJob<bool> echo_pair(size_t index) {
+        int fds[2];
+
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0)
+            co_return false;
+
+        bool ok = false;
+
+        {
+            Pollable server(fds[0]);
+            Pollable client(fds[1]);
+
+            std::string message = "message " + std::to_string(index);
+
+            auto serve = [](Pollable& server, size_t size) -> CoJob<bool> {
+                std::string request = co_await read_exactly(server, size);
+                co_return co_await write_all(server, request) == size;
+            };
+
+            auto [served, sent, answer] = co_await bop::job::when_all(
+                serve(server, message.size()),
+                write_all(client, message),
+                read_exactly(client, message.size())
+            );
+
+            ok = served && (sent == message.size()) && (answer == message);
+        }
+
+        close(fds[0]);
+        close(fds[1]);
+
+        co_return ok;
+    }
+
+    CoJob<size_t> echo_many(size_t n) {
+        std::vector<CoJob<bool>> pairs;
+
+        for (size_t i = 0; i < n; ++i)
+            pairs.push_back(echo_pair(i));
+
+        size_t correct = 0;
+
+        for (bool ok : co_await bop::job::when_all(std::move(pairs)))
+            if (ok)
+                ++correct;
+
+        co_return correct;
+    }
+
+    CoJob<uint64_t> wait_for_signals(Pollable& event, uint64_t expected) {
+        uint64_t total = 0;
+
+        while (total < expected) {
+            uint64_t value = 0;
+
+            if (::read(event.get_fd(), &value, sizeof(value)) == sizeof(value))
+                total += value;
+            else
+                co_await event.readable();
+        }
+
+        co_return total;
+    }
+
+    // (zero while nothing was read)
+    CoJob<> read_one(Pollable& pollable, std::atomic<size_t>& num_read) {
+        num_read = (co_await read_exactly(pollable, 1)).size() + 1;
+    }
+
+    // keeps its worker busy until told to move on to the first one
+    CoJob<> hop_to_first(std::atomic<int>& stage, std::atomic<uint32_t>& resumed_on) {
+        stage = 1;
+
+        while (stage != 2)
+            std::this_thread::sleep_for(1ms);
+
+        co_await bop::job::resume_on(0);
+
+        resumed_on = bop::job::JobSystem::get_current().get_thread_index();
+    }
+
+    template <typename Predicate>
+    bool wait_until_true(Predicate pred, std::chrono::milliseconds timeout = 5s) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        while (!pred())
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            else
+                std::this_thread::sleep_for(1ms);
+
+        return true;
+    }
+}
+
+TEST_CASE("test_reactor[pipe]") {
+    using namespace std::chrono_literals;
+
+    bop::job::JobSystem pool(2);
+
+    int fds[2];
+    REQUIRE(pipe2(fds, O_CLOEXEC) == 0);
+
+    {
+        bop::io::Pollable reader(pool.get_poller<bop::io::Reactor>(), fds[0]);
+
+        std::string      received;
+        std::atomic<int> done = 0;
+
+        pool.schedule([&] {
+            received = testing::read_exactly(reader, 11).get();
+            ++done;
+        });
+
+        // the reader waits meanwhile, without occupying a worker
+        REQUIRE(testing::wait_until_true([&] { return pool.get_poller<bop::io::Reactor>().get_num_waiting() == 1; }));
+
+        REQUIRE(write(fds[1], "hello ", 6) == 6);
+        std::this_thread::sleep_for(10ms);
+        REQUIRE(write(fds[1], "world", 5) == 5);
+
+        REQUIRE(testing::wait_until_true([&] { return done == 1; }));
+        REQUIRE(received == "hello world");
+        REQUIRE(pool.get_poller<bop::io::Reactor>().get_num_waiting() == 0);
+
+        // a full pipe holds the writer back until it's drained
+        bop::io::Pollable writer(pool.get_poller<bop::io::Reactor>(), fds[1]);
+
+        std::string big(1 << 20, 'x');
+        size_t      written = 0;
+
+        pool.schedule([&] {
+            written = testing::write_all(writer, big).get();
+            ++done;
+        });
+
+        std::string drained;
+        char        buffer[4096];
+
+        while (drained.size() < big.size()) {
+            ssize_t n = read(fds[0], buffer, sizeof(buffer));
+
+            if (n > 0)
+                drained.append(buffer, static_cast<size_t>(n));
+            else
+                std::this_thread::sleep_for(1ms);
+        }
+
+        REQUIRE(testing::wait_until_true([&] { return done == 2; }));
+        REQUIRE(written == big.size());
+        REQUIRE(drained == big);
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_CASE("test_reactor[eventfd]") {
+    bop::job::JobSystem pool(2);
+
+    int fd = eventfd(0, EFD_CLOEXEC);
+    REQUIRE(fd >= 0);
+
+    {
+        bop::io::Pollable event(pool.get_poller<bop::io::Reactor>(), fd);
+
+        std::atomic<uint64_t> total = 0;
+
+        pool.schedule([&] { total = testing::wait_for_signals(event, 100).get(); });
+
+        for (int i = 0; i < 100; ++i)
+            pool.schedule([fd] {
+                uint64_t one = 1;
+                [[maybe_unused]] auto unused = write(fd, &one, sizeof(one)); // (Catch isn't thread safe)
+            });
+
+        REQUIRE(testing::wait_until_true([&] { return total == 100; }));
+    }
+
+    close(fd);
+}
+
+TEST_CASE("test_reactor[unix_sockets]") {
+    constexpr size_t k_NumPairs = 50;
+
+    for (uint32_t num_threads : { 1u, 4u }) {
+        bop::job::JobSystem pool(num_threads);
+
+        std::atomic<size_t> correct = 0;
+        std::atomic<bool>   done    = false;
+
+        pool.schedule([&] {
+            correct = testing::echo_many(k_NumPairs).get();
+            done    = true;
+        });
+
+        REQUIRE(testing::wait_until_true([&] { return done.load(); }));
+        REQUIRE(correct == k_NumPairs);
+    }
+}
+
+TEST_CASE("test_reactor[regular_file]") {
+    bop::job::JobSystem pool(1);
+
+    char name[] = "/tmp/bop_test_reactor_XXXXXX";
+    int  fd     = mkstemp(name);
+    REQUIRE(fd >= 0);
+    unlink(name);
+
+    // (epoll doesn't take regular files)
+    REQUIRE_THROWS_AS(bop::io::Pollable(pool.get_poller<bop::io::Reactor>(), fd), std::system_error);
+
+    close(fd);
+}
+
+TEST_CASE("test_reactor[pinned]") {
+    using namespace std::chrono_literals;
+
+    // the second worker is kept busy, so the first one is the only one blocked in the reactor
+    bop::job::JobSystem pool(2);
+
+    int fds[2];
+    REQUIRE(pipe2(fds, O_CLOEXEC) == 0);
+
+    {
+        bop::io::Pollable reader(pool.get_poller<bop::io::Reactor>(), fds[0]);
+
+        std::atomic<size_t>              num_read   = 0;
+        std::atomic<int>                 stage      = 0;
+        std::atomic<uint32_t>            resumed_on = ~0u;
+        std::atomic<bool>                pinned     = false;
+        std::optional<bop::job::CoJob<>> reading;
+        std::optional<bop::job::CoJob<>> hopping;
+
+        // (started without anyone waiting for them)
+        pool.schedule([&] {
+            reading.emplace(testing::read_one(reader, num_read));
+            bop::job::schedule_coroutine(reading->get_handle());
+        });
+
+        REQUIRE(testing::wait_until_true([&] { return pool.get_poller<bop::io::Reactor>().get_num_waiting() == 1; }));
+
+        pool.schedule([&] {
+            hopping.emplace(testing::hop_to_first(stage, resumed_on));
+            bop::job::schedule_coroutine(hopping->get_handle(), 1);
+        });
+
+        REQUIRE(testing::wait_until_true([&] { return stage == 1; }));
+        std::this_thread::sleep_for(50ms);
+
+        // a job for just that worker, and a coroutine that moves over to it
+        // (only checked at the end, the pipe is what would wake the worker otherwise)
+        pool.schedule([&] { pinned = true; }, nullptr, 0);
+
+        bool ran_pinned = testing::wait_until_true([&] { return pinned.load(); }, 1s);
+
+        stage = 2;
+
+        bool hopped       = testing::wait_until_true([&] { return resumed_on == 0; }, 1s);
+        bool not_read_yet = (num_read == 0);
+
+        REQUIRE(write(fds[1], "x", 1) == 1);
+        REQUIRE(testing::wait_until_true([&] { return (num_read == 2) && (resumed_on == 0); }));
+
+        // (the coroutines are done running once the workers stopped)
+        pool.shutdown();
+        pool.wait_for_shutdown();
+
+        REQUIRE(ran_pinned);
+        REQUIRE(hopped);
+        REQUIRE(not_read_yet);
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+}
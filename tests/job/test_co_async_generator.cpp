@@ -0,0 +1,194 @@
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../../src/job/co_async_generator.h"
+#include "../../src/job/co_job.h"
+#include "../../src/job/job_awaitable.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using bop::job::AsyncGenerator;
+    using bop::job::CoJob;
+
+    CoJob<int> squared(int x) {
+        co_return x * x;
+    }
+
+    // awaits child jobs in between values
+    AsyncGenerator<int> squares(int n) {
+        for (int i = 0; i < n; ++i) {
+            if (i % 2)
+                co_yield co_await squared(i);
+            else {
+                int value = 0;
+
+                co_await bop::schedule_awaitable([&] { value = i * i; });
+
+                co_yield value;
+            }
+        }
+    }
+
+    CoJob<std::vector<int>> collect(AsyncGenerator<int> gen) {
+        std::vector<int> result;
+
+        for (auto it = co_await gen.begin(); it != gen.end(); co_await ++it)
+            result.push_back(*it);
+
+        co_return result;
+    }
+
+    struct Pace {
+        std::atomic<int> m_Produced = 0;
+        std::atomic<int> m_Consumed = 0;
+        std::atomic<int> m_MaxAhead = 0;
+    };
+
+    AsyncGenerator<int> paced(Pace& pace, int n) {
+        for (int i = 0; i < n; ++i) {
+            int ahead = ++pace.m_Produced - pace.m_Consumed;
+
+            if (ahead > pace.m_MaxAhead)
+                pace.m_MaxAhead = ahead;
+
+            co_yield i;
+        }
+    }
+
+    CoJob<int> consume_paced(Pace& pace, int n, uint32_t lookahead) {
+        auto gen = paced(pace, n);
+        gen.set_lookahead(lookahead);
+
+        int sum = 0;
+
+        for (auto it = co_await gen.begin(); it != gen.end(); co_await ++it) {
+            sum += *it;
+            ++pace.m_Consumed;
+        }
+
+        co_return sum;
+    }
+
+    AsyncGenerator<int> failing(int n) {
+        for (int i = 0; i < n; ++i)
+            co_yield i;
+
+        throw std::runtime_error("failing");
+    }
+
+    CoJob<int> consume_failing(int n) {
+        auto gen = failing(n);
+
+        int count = 0;
+
+        try {
+            for (auto it = co_await gen.begin(); it != gen.end(); co_await ++it)
+                ++count;
+        }
+        catch (const std::runtime_error&) {
+            co_return count;
+        }
+
+        co_return -1;
+    }
+
+    struct OnDestroy {
+        std::atomic<int>& m_Counter;
+
+        ~OnDestroy() {
+            ++m_Counter;
+        }
+    };
+
+    AsyncGenerator<int> endless(std::atomic<int>& destroyed) {
+        OnDestroy guard{ destroyed };
+
+        for (int i = 0; ; ++i)
+            co_yield i;
+    }
+
+    CoJob<int> take_first(std::atomic<int>& destroyed) {
+        auto gen = endless(destroyed);
+
+        auto it = co_await gen.begin();
+
+        co_return *it;
+    }
+
+    // runs fn on a worker of the pool and waits for it
+    template <typename Fn>
+    void run_on_pool(bop::job::JobSystem& pool, Fn fn) {
+        std::atomic<bool> done = false;
+
+        pool.schedule([&] {
+            fn();
+            done = true;
+        });
+
+        while (!done)
+            std::this_thread::yield();
+    }
+}
+
+// (these run on the default pool)
+TEST_CASE("test_co_async_generator[values]") {
+    auto values = testing::collect(testing::squares(100)).get();
+
+    REQUIRE(values.size() == 100);
+
+    for (int i = 0; i < 100; ++i)
+        REQUIRE(values[i] == i * i);
+
+    REQUIRE(testing::collect(testing::squares(0)).get().empty());
+}
+
+TEST_CASE("test_co_async_generator[lookahead]") {
+    for (uint32_t lookahead : { 1u, 4u, 16u }) {
+        testing::Pace pace;
+
+        REQUIRE(testing::consume_paced(pace, 1000, lookahead).get() == 999 * 1000 / 2);
+
+        // (the consumer counts a value just after taking it from the buffer)
+        REQUIRE(pace.m_MaxAhead <= static_cast<int>(lookahead) + 1);
+    }
+}
+
+TEST_CASE("test_co_async_generator[exception]") {
+    // the values before the exception are still delivered
+    REQUIRE(testing::consume_failing(5).get() == 5);
+    REQUIRE(testing::consume_failing(0).get() == 0);
+}
+
+TEST_CASE("test_co_async_generator[abandoned]") {
+    std::atomic<int> destroyed = 0;
+
+    REQUIRE(testing::take_first(destroyed).get() == 0);
+
+    // the producer may still be running ahead when the generator is dropped
+    while (destroyed == 0)
+        std::this_thread::yield();
+
+    REQUIRE(destroyed == 1);
+
+    // never started, so the body (and the guard in it) never ran
+    {
+        auto gen = testing::endless(destroyed);
+    }
+
+    REQUIRE(destroyed == 1);
+}
+
+TEST_CASE("test_co_async_generator[single_worker]") {
+    bop::job::JobSystem pool(1);
+
+    // producer and consumer take turns on the only worker
+    size_t count = 0;
+
+    testing::run_on_pool(pool, [&] { count = testing::collect(testing::squares(50)).get().size(); });
+
+    REQUIRE(count == 50);
+}
@@ -0,0 +1,172 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src/job/co_channel.h"
+#include "../../src/job/co_when.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using bop::job::Channel;
+    using bop::job::CoJob;
+
+    CoJob<void> send_range(Channel<int>& ch, int n) {
+        for (int i = 0; i < n; ++i)
+            co_await ch.send(i);
+    }
+
+    CoJob<uint64_t> receive_all(Channel<int>& ch) {
+        uint64_t sum = 0;
+
+        while (auto value = co_await ch.receive())
+            sum += *value;
+
+        co_return sum;
+    }
+
+    CoJob<void> send_then_close(Channel<int>& ch, int num_senders, int n) {
+        std::vector<CoJob<void>> senders;
+
+        for (int i = 0; i < num_senders; ++i)
+            senders.push_back(send_range(ch, n));
+
+        co_await bop::job::when_all(std::move(senders));
+
+        ch.close();
+    }
+
+    CoJob<uint64_t> receive_sum(Channel<int>& ch, int num_receivers) {
+        std::vector<CoJob<uint64_t>> receivers;
+
+        for (int i = 0; i < num_receivers; ++i)
+            receivers.push_back(receive_all(ch));
+
+        uint64_t total = 0;
+
+        for (uint64_t sum : co_await bop::job::when_all(std::move(receivers)))
+            total += sum;
+
+        co_return total;
+    }
+
+    // every sender sends [0, n), every value is received exactly once
+    CoJob<uint64_t> fan_in_out(Channel<int>& ch, int num_senders, int num_receivers, int n) {
+        auto [closed, total] = co_await bop::job::when_all(
+            send_then_close(ch, num_senders, n),
+            receive_sum(ch, num_receivers)
+        );
+
+        co_return total;
+    }
+
+    CoJob<bool> send_closed(Channel<int>& ch) {
+        co_return co_await ch.send(1);
+    }
+
+    CoJob<bool> receive_closed(Channel<int>& ch) {
+        auto value = co_await ch.receive();
+
+        co_return !value.has_value();
+    }
+
+    // runs fn on a worker of the pool and waits for it
+    template <typename Fn>
+    void run_with_pool(bop::job::JobSystem& pool, Fn fn) {
+        std::atomic<bool> done = false;
+
+        pool.schedule([&] {
+            fn();
+            done = true;
+        });
+
+        while (!done)
+            std::this_thread::yield();
+    }
+}
+
+TEST_CASE("test_co_channel[try]") {
+    bop::job::Channel<std::unique_ptr<std::string>> ch(4);
+
+    for (int i = 0; i < 4; ++i)
+        REQUIRE(ch.try_send(std::make_unique<std::string>(std::to_string(i))));
+
+    // full; the value is left alone
+    auto extra = std::make_unique<std::string>("extra");
+    REQUIRE(!ch.try_send(std::move(extra)));
+    REQUIRE(extra);
+
+    for (int i = 0; i < 4; ++i) {
+        auto value = ch.try_receive();
+
+        REQUIRE(value.has_value());
+        REQUIRE(**value == std::to_string(i)); // FIFO
+    }
+
+    REQUIRE(!ch.try_receive().has_value());
+
+    ch.close();
+
+    REQUIRE(ch.is_closed());
+    REQUIRE(!ch.try_send(std::move(extra)));
+}
+
+TEST_CASE("test_co_channel[fan_in_out]") {
+    constexpr int      k_N        = 10'000;
+    constexpr uint64_t k_Expected = uint64_t(k_N) * (k_N - 1) / 2;
+
+    bop::job::JobSystem pool(4);
+
+    for (uint32_t capacity : { 1u, 8u, 1024u }) {
+        bop::job::Channel<int> ch(capacity, pool);
+
+        uint64_t total = 0;
+
+        testing::run_with_pool(pool, [&] { total = testing::fan_in_out(ch, 3, 2, k_N).get(); });
+
+        REQUIRE(total == 3 * k_Expected);
+    }
+}
+
+TEST_CASE("test_co_channel[single_worker]") {
+    bop::job::JobSystem pool(1);
+
+    // with a single slot, sender and receiver take turns suspending on the only worker
+    bop::job::Channel<int> ch(1, pool);
+
+    uint64_t total = 0;
+
+    testing::run_with_pool(pool, [&] { total = testing::fan_in_out(ch, 1, 1, 1000).get(); });
+
+    REQUIRE(total == 999 * 1000 / 2);
+}
+
+TEST_CASE("test_co_channel[close]") {
+    bop::job::JobSystem pool(2);
+
+    bop::job::Channel<int> ch(2, pool);
+
+    // a waiting receiver is resumed by close
+    std::atomic<int> result = -1;
+
+    pool.schedule([&] { result = testing::receive_closed(ch).get() ? 1 : 0; });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    ch.close();
+
+    while (result < 0)
+        std::this_thread::yield();
+
+    REQUIRE(result == 1);
+
+    bool sent = true;
+
+    testing::run_with_pool(pool, [&] { sent = testing::send_closed(ch).get(); });
+
+    REQUIRE(!sent);
+}
@@ -0,0 +1,164 @@
+#include <array>
+#include <atomic>
+#include <memory_resource>
+#include <optional>
+#include <thread>
+
+#include "../../src/job/co_generator.h"
+#include "../../src/job/co_job.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    // forwards to new/delete, keeping track of what is outstanding
+    class FrameResource:
+        public std::pmr::memory_resource
+    {
+    public:
+        std::atomic<uint64_t> m_NumAllocations = 0;
+        std::atomic<int64_t>  m_NumOutstanding = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            ++m_NumAllocations;
+            ++m_NumOutstanding;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            --m_NumOutstanding;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    bop::job::CoJob<int> twice(int x) {
+        co_return 2 * x;
+    }
+
+    bop::job::CoJob<size_t> count_bytes(std::array<char, 8192> large) {
+        co_return large.size();
+    }
+
+    int sum_iota(int n) {
+        int result = 0;
+
+        for (int x : bop::job::iota(n))
+            result += x;
+
+        return result;
+    }
+
+    // runs fn on a worker of the pool and waits for it
+    template <typename Fn>
+    void run_on_worker(bop::job::JobSystem& pool, Fn fn) {
+        std::atomic<bool> done = false;
+
+        pool.schedule([&] {
+            fn();
+            done = true;
+        });
+
+        while (!done)
+            std::this_thread::yield();
+    }
+}
+
+TEST_CASE("test_co_frame[pooled]") {
+    using bop::job::JobSystem;
+
+    testing::FrameResource resource;
+
+    {
+        JobSystem pool(1, &resource);
+
+        uint64_t warm_up = 0;
+        uint64_t steady  = 0;
+
+        testing::run_on_worker(pool, [&] {
+            // the first ones come from the memory resource...
+            uint64_t before = resource.m_NumAllocations;
+
+            { auto job = testing::twice(21); } // (created but never started)
+
+            warm_up = resource.m_NumAllocations - before;
+
+            // ...after that, frames are reused
+            before = resource.m_NumAllocations;
+
+            for (int i = 0; i < 1000; ++i) {
+                auto job = testing::twice(i);
+            }
+
+            steady = resource.m_NumAllocations - before;
+        });
+
+        REQUIRE(warm_up >  0);
+        REQUIRE(steady  == 0);
+    }
+
+    // everything was handed back when the pool went away
+    REQUIRE(resource.m_NumOutstanding == 0);
+}
+
+TEST_CASE("test_co_frame[external]") {
+    using bop::job::JobSystem;
+
+    // coroutines that are created outside of any worker use the global heap
+    REQUIRE(testing::twice(1).get() == 2);
+    REQUIRE(testing::sum_iota(4)    == 6);
+
+    // a generator that was created on a worker has a pooled frame, which may outlive the pool
+    testing::FrameResource                  resource;
+    std::optional<bop::job::Generator<int>> numbers;
+
+    {
+        JobSystem pool(1, &resource);
+
+        testing::run_on_worker(pool, [&] { numbers.emplace(bop::job::iota(5)); });
+    }
+
+    REQUIRE(resource.m_NumOutstanding == 1);
+
+    int total = 0;
+
+    for (int x : *numbers)
+        total += x;
+
+    numbers.reset();
+
+    REQUIRE(total == 10);
+    REQUIRE(resource.m_NumOutstanding == 0);
+}
+
+TEST_CASE("test_co_frame[oversized]") {
+    using bop::job::JobSystem;
+
+    testing::FrameResource resource;
+
+    {
+        JobSystem pool(1, &resource);
+
+        size_t   result          = 0;
+        uint64_t num_allocations = 0;
+
+        testing::run_on_worker(pool, [&] {
+            // too large for any size class, these go straight to the memory resource
+            uint64_t before = resource.m_NumAllocations;
+
+            auto job = testing::count_bytes({});
+
+            num_allocations = resource.m_NumAllocations - before;
+            result          = job.get();
+        });
+
+        REQUIRE(result          == 8192);
+        REQUIRE(num_allocations == 1);
+    }
+
+    REQUIRE(resource.m_NumOutstanding == 0);
+}
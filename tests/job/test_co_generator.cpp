@@ -2,7 +2,13 @@
 #include <memory>
 #include <array>
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
 
+#include "../../src/job/co_chunked_generator.h"
 #include "../../src/job/co_generator.h"
 
 #include <catch2/catch.hpp>
@@ -36,3 +42,99 @@ TEST_CASE("test_generator[iota]") {
 TEST_CASE("test_generator[range]") {
     REQUIRE(testing::test_generator_range_sum() == (5 + 6 + 7 + 8 + 9)); // == 35
 }
+
+TEST_CASE("test_generator[chunked]") {
+    std::array<int, 7> buffer;
+
+    // element-wise
+    std::vector<int> values;
+
+    for (int x : bop::job::iota(20, std::span(buffer)))
+        values.push_back(x);
+
+    REQUIRE(values.size() == 20);
+
+    for (int i = 0; i < 20; ++i)
+        REQUIRE(values[i] == i);
+
+    // per chunk; all but the last one fill the buffer
+    std::vector<size_t> sizes;
+
+    auto gen = bop::job::range(5, 40, 2, std::span(buffer));
+
+    for (const auto& chunk : gen.chunks())
+        sizes.push_back(chunk.size());
+
+    REQUIRE(sizes == std::vector<size_t>{ 7, 7, 4 });
+
+    // nothing to produce
+    int count = 0;
+
+    for (int x : bop::job::iota(0, std::span(buffer)))
+        count += x + 1;
+
+    REQUIRE(count == 0);
+
+    REQUIRE_THROWS_AS(bop::job::iota(5, std::span<int>()).begin(), std::invalid_argument);
+}
+
+TEST_CASE("test_generator[chunked_overhead]", "[.benchmark]") {
+    using Clock = std::chrono::steady_clock;
+
+    // (opaque to the optimizer, so the plain loop isn't folded into a constant)
+    volatile uint32_t num_elements = 1'000'000;
+
+    uint32_t n = num_elements;
+
+    // (timed by hand, with the same checksum for each variant)
+    auto measure = [n](const char* name, auto&& fn) {
+        auto     start = Clock::now();
+        uint64_t sum   = fn();
+        double   ns    = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        REQUIRE(sum == uint64_t(n) * (n - 1) / 2);
+
+        WARN(name << ": " << (ns / n) << " ns per element");
+    };
+
+    measure("plain loop", [n] {
+        uint64_t sum = 0;
+
+        for (uint32_t i = 0; i < n; ++i)
+            sum += i;
+
+        return sum;
+    });
+
+    measure("generator", [n] {
+        uint64_t sum = 0;
+
+        for (uint32_t x : bop::job::iota(n))
+            sum += x;
+
+        return sum;
+    });
+
+    std::vector<uint32_t> buffer(1024);
+
+    measure("chunked generator", [&] {
+        uint64_t sum = 0;
+
+        for (uint32_t x : bop::job::iota(n, std::span(buffer)))
+            sum += x;
+
+        return sum;
+    });
+
+    measure("chunked generator (per span)", [&] {
+        uint64_t sum = 0;
+
+        auto gen = bop::job::iota(n, std::span(buffer));
+
+        for (const auto& chunk : gen.chunks())
+            for (uint32_t x : chunk)
+                sum += x;
+
+        return sum;
+    });
+}
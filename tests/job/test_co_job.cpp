@@ -0,0 +1,111 @@
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "../../src/job/co_job.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    bop::job::CoJob<int> forty_two() {
+        co_return 42;
+    }
+
+    bop::job::CoJob<int> add_awaited(int x) {
+        int a = co_await forty_two();
+        int b = co_await forty_two();
+
+        co_return a + b + x;
+    }
+
+    // every level awaits the next one
+    bop::job::CoJob<int> count_down(int depth) {
+        if (depth == 0)
+            co_return 0;
+
+        co_return 1 + co_await count_down(depth - 1);
+    }
+
+    bop::job::CoJob<int> fail() {
+        throw std::runtime_error("failed");
+        co_return 0;
+    }
+
+    bop::job::CoJob<bool> catch_failure() {
+        try {
+            co_await fail();
+        }
+        catch (const std::runtime_error&) {
+            co_return true;
+        }
+
+        co_return false;
+    }
+
+    bop::job::CoJob<void> mark_worker(std::atomic<bool>& on_worker) {
+        on_worker = bop::job::JobSystem::get_current().is_worker();
+        co_return;
+    }
+
+    bop::job::CoJob<void> await_void(std::atomic<bool>& on_worker) {
+        co_await mark_worker(on_worker);
+    }
+}
+
+// (these run on the default pool)
+TEST_CASE("test_co_job[value]") {
+    REQUIRE(testing::forty_two().get() == 42);
+    REQUIRE(testing::add_awaited(1).get() == 85);
+}
+
+TEST_CASE("test_co_job[lazy]") {
+    std::atomic<bool> on_worker = false;
+
+    // nothing happens until the job is awaited
+    auto job = testing::await_void(on_worker);
+
+    std::this_thread::yield();
+    REQUIRE(!on_worker);
+
+    // ...and then it runs on the pool
+    job.get();
+    REQUIRE(on_worker);
+}
+
+TEST_CASE("test_co_job[deep_chain]") {
+    // completing the chain resumes each awaiter by symmetric transfer (the depth stays small enough
+    // for builds that don't turn that into tail calls, such as sanitized ones)
+    constexpr int k_Depth = 1'000;
+
+    REQUIRE(testing::count_down(k_Depth).get() == k_Depth);
+}
+
+TEST_CASE("test_co_job[deep_chain_stress]", "[.stress]") {
+    // this would overflow the stack if every level was a nested call, which is only guaranteed
+    // not to happen in optimized builds
+    constexpr int k_Depth = 100'000;
+
+    REQUIRE(testing::count_down(k_Depth).get() == k_Depth);
+}
+
+TEST_CASE("test_co_job[exception]") {
+    REQUIRE_THROWS_AS(testing::fail().get(), std::runtime_error);
+    REQUIRE(testing::catch_failure().get());
+}
+
+TEST_CASE("test_co_job[from_worker]") {
+    bop::job::JobSystem pool(1);
+
+    // a blocking get on the only worker keeps executing queued jobs, so this doesn't deadlock
+    std::atomic<int> result = 0;
+
+    pool.schedule([&] {
+        result = testing::add_awaited(2).get();
+    });
+
+    while (result == 0)
+        std::this_thread::yield();
+
+    REQUIRE(result == 86);
+}
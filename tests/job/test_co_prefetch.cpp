@@ -0,0 +1,181 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "../../src/job/co_prefetch.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using bop::job::Generator;
+
+    Generator<std::string> numbered(int n) {
+        for (int i = 0; i < n; ++i)
+            co_yield std::to_string(i);
+    }
+
+    Generator<int> throws_after(int n) {
+        for (int i = 0; i < n; ++i)
+            co_yield i;
+
+        throw std::runtime_error("throws_after");
+    }
+
+    struct CountDestroyed {
+        std::atomic<int>& m_Counter;
+
+        ~CountDestroyed() {
+            ++m_Counter;
+        }
+    };
+
+    Generator<int> forever(std::atomic<int>& destroyed) {
+        CountDestroyed guard{ destroyed };
+
+        for (int i = 0; ; ++i)
+            co_yield i;
+    }
+
+    // (stand-in for decoding/parsing)
+    uint64_t busy_work(uint64_t x) {
+        for (int i = 0; i < 2000; ++i)
+            x = x * 6364136223846793005ull + 1442695040888963407ull;
+
+        return x;
+    }
+
+    Generator<uint64_t> heavy(int n) {
+        for (int i = 0; i < n; ++i)
+            co_yield busy_work(i);
+    }
+
+    bool in_order(auto&& values, int n) {
+        int expected = 0;
+
+        for (auto& value : values)
+            if (value != std::to_string(expected++))
+                return false;
+
+        return expected == n;
+    }
+
+    // runs fn on a worker of the pool and waits for it
+    template <typename Fn>
+    void run_on_worker_of(bop::job::JobSystem& pool, Fn fn) {
+        std::atomic<bool> done = false;
+
+        pool.schedule([&] {
+            fn();
+            done = true;
+        });
+
+        while (!done)
+            std::this_thread::yield();
+    }
+}
+
+TEST_CASE("test_co_prefetch[values]") {
+    bop::job::JobSystem pool(2);
+
+    for (uint32_t depth : { 1u, 3u, 64u })
+        REQUIRE(testing::in_order(bop::job::prefetch(testing::numbered(1000), depth, pool), 1000));
+
+    REQUIRE(testing::in_order(bop::job::prefetch(testing::numbered(0), 4, pool), 0));
+}
+
+TEST_CASE("test_co_prefetch[exception]") {
+    bop::job::JobSystem pool(2);
+
+    int count = 0;
+
+    auto consume = [&] {
+        for (int x : bop::job::prefetch(testing::throws_after(10), 4, pool))
+            if (x == count)
+                ++count;
+    };
+
+    // the values before the exception are still delivered
+    REQUIRE_THROWS_AS(consume(), std::runtime_error);
+    REQUIRE(count == 10);
+}
+
+TEST_CASE("test_co_prefetch[early_exit]") {
+    bop::job::JobSystem pool(2);
+
+    std::atomic<int> destroyed = 0;
+
+    {
+        auto values = bop::job::prefetch(testing::forever(destroyed), 8, pool);
+
+        int count = 0;
+
+        for (int x : values) {
+            if (x != count)
+                break;
+
+            if (++count == 20)
+                break;
+        }
+
+        REQUIRE(count == 20);
+    }
+
+    // the producer stops at its next value and the generator goes away
+    while (destroyed == 0)
+        std::this_thread::yield();
+
+    REQUIRE(destroyed == 1);
+}
+
+TEST_CASE("test_co_prefetch[single_worker]") {
+    bop::job::JobSystem pool(1);
+
+    // the consumer keeps executing jobs (including the producer) while waiting
+    bool ok = false;
+
+    testing::run_on_worker_of(pool, [&] {
+        ok = testing::in_order(bop::job::prefetch(testing::numbered(500), 4), 500);
+    });
+
+    REQUIRE(ok);
+}
+
+TEST_CASE("test_co_prefetch[overlap]", "[.benchmark]") {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int k_N = 20'000;
+
+    // (timed by hand; every job is traced, so a full statistical benchmark would hoard trace entries)
+    auto consume = [](auto&& values) {
+        uint64_t sum = 0;
+
+        for (uint64_t x : values)
+            sum += testing::busy_work(x);
+
+        return sum;
+    };
+
+    auto start = Clock::now();
+
+    uint64_t serial = consume(testing::heavy(k_N));
+
+    double serial_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    bop::job::JobSystem pool(2);
+
+    start = Clock::now();
+
+    uint64_t prefetched = consume(bop::job::prefetch(testing::heavy(k_N), 64, pool));
+
+    double prefetch_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    REQUIRE(serial == prefetched);
+
+    WARN(
+        "serial: " << serial_ms << " ms, prefetched: " << prefetch_ms << " ms"
+        << " (speedup " << (serial_ms / prefetch_ms) << ")"
+    );
+}
@@ -0,0 +1,107 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../../src/job/co_job.h"
+#include "../../src/job/co_resume.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using bop::job::CoJob;
+    using bop::job::JobSystem;
+
+    // (stand-in for state that is owned by a single worker)
+    thread_local int l_WorkerLocal = 0;
+
+    // visits every worker in turn, touching its thread-local state, and records where it ended up
+    CoJob<std::vector<uint32_t>> visit_all() {
+        auto& pool = JobSystem::get_current();
+
+        std::vector<uint32_t> visited;
+
+        for (uint32_t i = 0; i < pool.get_num_threads(); ++i) {
+            co_await bop::job::resume_on(i);
+
+            ++l_WorkerLocal;
+            visited.push_back(pool.get_thread_index());
+        }
+
+        // and back to the first one
+        co_await bop::job::resume_on(0);
+        visited.push_back(pool.get_thread_index());
+
+        co_return visited;
+    }
+
+    CoJob<bool> still_on_worker() {
+        co_await bop::job::resume_on_any();
+
+        auto& pool = JobSystem::get_current();
+        bool  ok   = pool.is_worker();
+
+        co_await bop::job::yield_to_pool();
+
+        co_return ok && pool.is_worker();
+    }
+
+    // runs fn on a specific worker of the pool and waits for it
+    template <typename Fn>
+    void run_pinned(JobSystem& pool, uint32_t thread_index, Fn fn) {
+        std::atomic<bool> done = false;
+
+        pool.schedule(
+            [&] {
+                fn();
+                done = true;
+            },
+            nullptr,
+            thread_index
+        );
+
+        while (!done)
+            std::this_thread::yield();
+    }
+}
+
+TEST_CASE("test_co_resume[resume_on]") {
+    bop::job::JobSystem pool(4);
+
+    std::vector<uint32_t> visited;
+
+    testing::run_pinned(pool, 0, [&] { visited = testing::visit_all().get(); });
+
+    REQUIRE(visited == std::vector<uint32_t>{ 0, 1, 2, 3, 0 });
+}
+
+TEST_CASE("test_co_resume[ready]") {
+    bop::job::JobSystem pool(2);
+
+    bool same_thread  = false;
+    bool other_thread = true;
+    bool any_worker   = false;
+    bool yield        = true;
+
+    // already on the target thread, so there is no need to suspend
+    testing::run_pinned(pool, 1, [&] {
+        same_thread  = bop::job::resume_on(1).await_ready();
+        other_thread = bop::job::resume_on(0).await_ready();
+        any_worker   = bop::job::resume_on_any().await_ready();
+        yield        = bop::job::yield_to_pool().await_ready();
+    });
+
+    REQUIRE(same_thread);
+    REQUIRE_FALSE(other_thread);
+    REQUIRE(any_worker);
+    REQUIRE_FALSE(yield);
+
+    // (this thread is not a worker)
+    REQUIRE_FALSE(bop::job::resume_on(0).await_ready());
+    REQUIRE_FALSE(bop::job::resume_on_any().await_ready());
+}
+
+TEST_CASE("test_co_resume[any]") {
+    // (runs on the default pool)
+    REQUIRE(testing::still_on_worker().get());
+}
@@ -0,0 +1,222 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../../src/job/co_resume.h"
+#include "../../src/job/co_sync.h"
+#include "../../src/job/co_when.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using bop::job::CoJob;
+
+    struct Guarded {
+        bop::job::AsyncMutex m_Mutex;
+        int                  m_Value   = 0; // (not atomic on purpose)
+        std::atomic<int>     m_Holders = 0;
+        std::atomic<int>     m_Overlap = 0;
+    };
+
+    CoJob<void> add_locked(Guarded& g, int n) {
+        for (int i = 0; i < n; ++i) {
+            auto lock = co_await g.m_Mutex.scoped_lock();
+
+            if (++g.m_Holders > 1)
+                ++g.m_Overlap;
+
+            int value = g.m_Value;
+
+            // (give others a chance to run into the locked mutex)
+            if (i % 8 == 0)
+                co_await bop::job::yield_to_pool();
+
+            g.m_Value = value + 1;
+
+            --g.m_Holders;
+        }
+    }
+
+    CoJob<void> contend(Guarded& g, int num_jobs, int n) {
+        std::vector<CoJob<void>> jobs;
+
+        for (int i = 0; i < num_jobs; ++i)
+            jobs.push_back(add_locked(g, n));
+
+        co_await bop::job::when_all(std::move(jobs));
+    }
+
+    struct Limited {
+        bop::job::AsyncSemaphore m_Semaphore;
+        std::atomic<int>         m_Active    = 0;
+        std::atomic<int>         m_MaxActive = 0;
+        std::atomic<int>         m_Done      = 0;
+
+        explicit Limited(uint32_t num_permits):
+            m_Semaphore(num_permits)
+        {
+        }
+    };
+
+    CoJob<void> use_permit(Limited& l) {
+        co_await l.m_Semaphore.acquire();
+
+        int active = ++l.m_Active;
+
+        for (int max = l.m_MaxActive; active > max; )
+            if (l.m_MaxActive.compare_exchange_weak(max, active))
+                break;
+
+        co_await bop::job::yield_to_pool();
+
+        --l.m_Active;
+        ++l.m_Done;
+
+        l.m_Semaphore.release();
+    }
+
+    CoJob<void> limit(Limited& l, int num_jobs) {
+        std::vector<CoJob<void>> jobs;
+
+        for (int i = 0; i < num_jobs; ++i)
+            jobs.push_back(use_permit(l));
+
+        co_await bop::job::when_all(std::move(jobs));
+    }
+
+    CoJob<void> wait_for(const bop::job::AsyncEvent& event, std::atomic<int>& passed) {
+        co_await event.wait();
+        ++passed;
+    }
+
+    CoJob<void> wait_all(const bop::job::AsyncEvent& event, std::atomic<int>& passed, int n) {
+        std::vector<CoJob<void>> waiters;
+
+        for (int i = 0; i < n; ++i)
+            waiters.push_back(wait_for(event, passed));
+
+        co_await bop::job::when_all(std::move(waiters));
+    }
+
+    CoJob<int> count_down_all(int n) {
+        bop::job::AsyncLatch latch(n);
+
+        std::atomic<int> done = 0;
+
+        for (int i = 0; i < n; ++i)
+            bop::schedule([&] {
+                ++done;
+                latch.count_down();
+            });
+
+        co_await latch.wait();
+
+        co_return done.load();
+    }
+
+    // runs fn on a worker of the pool and waits for it
+    template <typename Fn>
+    void run_in_pool(bop::job::JobSystem& pool, Fn fn) {
+        std::atomic<bool> done = false;
+
+        pool.schedule([&] {
+            fn();
+            done = true;
+        });
+
+        while (!done)
+            std::this_thread::yield();
+    }
+}
+
+TEST_CASE("test_co_sync[mutex]") {
+    for (uint32_t num_threads : { 1u, 4u }) {
+        bop::job::JobSystem pool(num_threads);
+
+        testing::Guarded g;
+
+        testing::run_in_pool(pool, [&] { testing::contend(g, 8, 500).get(); });
+
+        REQUIRE(g.m_Value == 8 * 500);
+        REQUIRE(g.m_Overlap == 0);
+    }
+
+    // uncontended
+    bop::job::AsyncMutex mutex;
+
+    REQUIRE(mutex.try_lock());
+    REQUIRE(!mutex.try_lock());
+
+    mutex.unlock();
+
+    REQUIRE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST_CASE("test_co_sync[semaphore]") {
+    bop::job::JobSystem pool(4);
+
+    testing::Limited l(3);
+
+    testing::run_in_pool(pool, [&] { testing::limit(l, 32).get(); });
+
+    REQUIRE(l.m_Done == 32);
+    REQUIRE(l.m_MaxActive <= 3);
+    REQUIRE(l.m_Semaphore.get_num_permits() == 3);
+
+    REQUIRE(l.m_Semaphore.try_acquire());
+    REQUIRE(l.m_Semaphore.try_acquire());
+    REQUIRE(l.m_Semaphore.try_acquire());
+    REQUIRE(!l.m_Semaphore.try_acquire());
+
+    l.m_Semaphore.release(3);
+
+    REQUIRE(l.m_Semaphore.get_num_permits() == 3);
+}
+
+TEST_CASE("test_co_sync[event]") {
+    bop::job::JobSystem pool(2);
+
+    bop::job::AsyncEvent event;
+
+    REQUIRE(!event.is_set());
+
+    std::atomic<int> passed = 0;
+
+    // the waiters suspend instead of occupying the workers
+    std::atomic<bool> finished = false;
+
+    pool.schedule([&] {
+        testing::wait_all(event, passed, 10).get();
+        finished = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    REQUIRE(passed == 0);
+
+    event.set();
+
+    while (!finished)
+        std::this_thread::yield();
+
+    REQUIRE(passed == 10);
+    REQUIRE(event.is_set());
+
+    // passes right through while set
+    testing::run_in_pool(pool, [&] { testing::wait_for(event, passed).get(); });
+    REQUIRE(passed == 11);
+
+    event.reset();
+    REQUIRE(!event.is_set());
+}
+
+TEST_CASE("test_co_sync[latch]") {
+    // (runs on the default pool)
+    REQUIRE(testing::count_down_all(100).get() == 100);
+
+    bop::job::AsyncLatch latch(0);
+    REQUIRE(latch.is_ready());
+}
@@ -0,0 +1,236 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src/job/co_when.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using bop::job::CoJob;
+
+    CoJob<int> value_of(int x) {
+        co_return x;
+    }
+
+    CoJob<std::string> text_of(int x) {
+        co_return std::to_string(x);
+    }
+
+    CoJob<void> increment(std::atomic<int>& counter) {
+        ++counter;
+        co_return;
+    }
+
+    CoJob<int> fail_with(int x) {
+        throw std::runtime_error(std::to_string(x));
+        co_return x;
+    }
+
+    CoJob<uint64_t> fib(int n) {
+        if (n < 2)
+            co_return n;
+
+        auto [a, b] = co_await bop::job::when_all(fib(n - 1), fib(n - 2));
+
+        co_return a + b;
+    }
+
+    uint64_t fib_serial(int n) {
+        return (n < 2) ? n : fib_serial(n - 1) + fib_serial(n - 2);
+    }
+
+    CoJob<std::tuple<int, std::string, std::monostate>> mixed(std::atomic<int>& counter) {
+        co_return co_await bop::job::when_all(value_of(1), text_of(2), increment(counter));
+    }
+
+    CoJob<int> sum_range(int n) {
+        std::vector<CoJob<int>> jobs;
+
+        for (int i = 0; i < n; ++i)
+            jobs.push_back(value_of(i));
+
+        auto values = co_await bop::job::when_all(std::move(jobs));
+
+        int result = 0;
+
+        for (size_t i = 0; i < values.size(); ++i)
+            if (values[i] == static_cast<int>(i)) // (in order)
+                result += values[i];
+
+        co_return result;
+    }
+
+    CoJob<void> increment_all(std::atomic<int>& counter, int n) {
+        std::vector<CoJob<void>> jobs;
+
+        for (int i = 0; i < n; ++i)
+            jobs.push_back(increment(counter));
+
+        co_await bop::job::when_all(std::move(jobs));
+    }
+
+    CoJob<bool> first_failure_wins() {
+        try {
+            co_await bop::job::when_all(value_of(0), fail_with(1), fail_with(2));
+        }
+        catch (const std::runtime_error& ex) {
+            co_return std::string(ex.what()) == "1";
+        }
+
+        co_return false;
+    }
+
+    CoJob<bool> any_of(int n) {
+        std::vector<CoJob<int>> jobs;
+
+        for (int i = 0; i < n; ++i)
+            jobs.push_back(value_of(10 * i));
+
+        auto [index, value] = co_await bop::job::when_any(std::move(jobs));
+
+        co_return (index < static_cast<size_t>(n)) && (value == 10 * static_cast<int>(index));
+    }
+
+    CoJob<bool> any_failure() {
+        std::vector<CoJob<int>> jobs;
+        jobs.push_back(fail_with(3));
+
+        try {
+            co_await bop::job::when_any(std::move(jobs));
+        }
+        catch (const std::runtime_error&) {
+            co_return true;
+        }
+
+        co_return false;
+    }
+
+    CoJob<void> any_stragglers(std::atomic<int>& counter, int n) {
+        std::vector<CoJob<void>> jobs;
+
+        for (int i = 0; i < n; ++i)
+            jobs.push_back(increment(counter));
+
+        co_await bop::job::when_any(std::move(jobs));
+    }
+
+    // runs fn on a worker of the pool and waits for it
+    template <typename Fn>
+    void run_on(bop::job::JobSystem& pool, Fn fn) {
+        std::atomic<bool> done = false;
+
+        pool.schedule([&] {
+            fn();
+            done = true;
+        });
+
+        while (!done)
+            std::this_thread::yield();
+    }
+}
+
+// (these run on the default pool)
+TEST_CASE("test_co_when[all]") {
+    std::atomic<int> counter = 0;
+
+    auto [a, b, c] = testing::mixed(counter).get();
+
+    REQUIRE(a == 1);
+    REQUIRE(b == "2");
+    REQUIRE(counter == 1);
+
+    REQUIRE(testing::sum_range(100).get() == 99 * 100 / 2);
+
+    testing::increment_all(counter, 100).get();
+    REQUIRE(counter == 101);
+}
+
+TEST_CASE("test_co_when[all_exception]") {
+    REQUIRE(testing::first_failure_wins().get());
+}
+
+TEST_CASE("test_co_when[any]") {
+    REQUIRE(testing::any_of(1).get());
+    REQUIRE(testing::any_of(20).get());
+    REQUIRE(testing::any_failure().get());
+
+    // the other jobs still run to completion
+    std::atomic<int> counter = 0;
+
+    testing::any_stragglers(counter, 50).get();
+
+    while (counter < 50)
+        std::this_thread::yield();
+
+    REQUIRE(counter == 50);
+}
+
+TEST_CASE("test_co_when[unawaited]") {
+    std::atomic<int> counter = 0;
+
+    // dropping the combinators without awaiting them never starts the jobs
+    {
+        auto all = bop::job::when_all(testing::increment(counter), testing::increment(counter));
+
+        std::vector<testing::CoJob<void>> jobs;
+        jobs.push_back(testing::increment(counter));
+
+        auto any = bop::job::when_any(std::move(jobs));
+    }
+
+    REQUIRE(counter == 0);
+    REQUIRE_THROWS_AS(bop::job::when_any(std::vector<testing::CoJob<int>>{}), std::invalid_argument);
+}
+
+TEST_CASE("test_co_when[fib]") {
+    bop::job::JobSystem pool(2);
+
+    uint64_t result = 0;
+
+    testing::run_on(pool, [&] { result = testing::fib(20).get(); });
+
+    REQUIRE(result == testing::fib_serial(20));
+}
+
+TEST_CASE("test_co_when[fib_scaling]", "[.benchmark]") {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int      k_N      = 22;
+    constexpr uint32_t k_Rounds = 3;
+
+    // (timed by hand; every job is traced, so a full statistical benchmark would hoard trace entries)
+    double single = 0;
+
+    for (uint32_t num_threads : { 1u, 2u, 4u, 8u }) {
+        bop::job::JobSystem pool(num_threads);
+
+        double   best   = 0;
+        uint64_t result = 0;
+
+        for (uint32_t round = 0; round < k_Rounds; ++round) {
+            auto start = Clock::now();
+
+            testing::run_on(pool, [&] { result = testing::fib(k_N).get(); });
+
+            double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            if ((round == 0) || (elapsed < best))
+                best = elapsed;
+        }
+
+        if (num_threads == 1)
+            single = best;
+
+        REQUIRE(result == testing::fib_serial(k_N));
+
+        WARN(
+            "fib(" << k_N << ") on " << num_threads << " workers: " << best << " ms"
+            << " (speedup " << (single / best) << ")"
+        );
+    }
+}
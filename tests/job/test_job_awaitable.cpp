@@ -0,0 +1,93 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../../src/job/co_job.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    // schedules a group of jobs under a single awaitable parent
+    bop::job::CoJob<int> fan_out(int num_jobs) {
+        std::atomic<int> count = 0;
+
+        auto group = bop::schedule_awaitable([] {});
+
+        for (int i = 0; i < num_jobs; ++i)
+            bop::schedule([&] { ++count; }, &group.get_job());
+
+        co_await group;
+
+        co_return count.load();
+    }
+
+    bop::job::CoJob<bool> await_completed() {
+        std::atomic<uint32_t> pending = 1;
+
+        auto job = bop::schedule_awaitable([&] { pending = 0; });
+
+        // (workers keep executing other jobs while waiting)
+        bop::job::JobSystem::get_current().wait(pending);
+
+        // the job is held, so it's still there to be awaited
+        co_await job;
+
+        co_return pending == 0;
+    }
+
+    bop::job::CoJob<std::vector<int>> await_chain() {
+        std::vector<int> order;
+
+        co_await bop::schedule_awaitable([&] { order.push_back(1); })
+            .then([&] { order.push_back(2); })
+            .then([&] { order.push_back(3); });
+
+        co_return order;
+    }
+}
+
+// (these run on the default pool)
+TEST_CASE("test_job_awaitable[fan_out]") {
+    REQUIRE(testing::fan_out(100).get() == 100);
+}
+
+TEST_CASE("test_job_awaitable[completed]") {
+    REQUIRE(testing::await_completed().get());
+}
+
+TEST_CASE("test_job_awaitable[then]") {
+    REQUIRE(testing::await_chain().get() == std::vector<int>{ 1, 2, 3 });
+}
+
+TEST_CASE("test_job_awaitable[single_worker]") {
+    bop::job::JobSystem pool(1);
+
+    // the coroutine suspends instead of occupying the only worker, so the jobs it waits for can run
+    std::atomic<int> result = 0;
+
+    pool.schedule([&] {
+        result = testing::fan_out(50).get();
+    });
+
+    while (result == 0)
+        std::this_thread::yield();
+
+    REQUIRE(result == 50);
+}
+
+TEST_CASE("test_job_awaitable[dropped]") {
+    bop::job::JobSystem pool(2);
+
+    std::atomic<int> count = 0;
+
+    // without awaiting, the hold is released right away and the job completes as usual
+    {
+        auto job = pool.schedule_awaitable([&] { ++count; });
+    }
+
+    while (count == 0)
+        std::this_thread::yield();
+
+    REQUIRE(count == 1);
+}
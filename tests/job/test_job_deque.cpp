@@ -0,0 +1,254 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../../src/job/job.h"
+#include "../../src/job/job_queue.h"
+#include "../../src/job/job_deque.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using bop::job::Job;
+    using bop::job::JobDeque;
+    using bop::job::JobQueue;
+
+    // the deque is non-owning, so any stable set of Job objects will do
+    struct JobPool {
+        explicit JobPool(size_t n):
+            m_Jobs(std::make_unique<Job[]>(n)),
+            m_Size(n)
+        {}
+
+        Job*   operator[](size_t i) { return &m_Jobs[i]; }
+        size_t index_of(Job* j)     { return static_cast<size_t>(j - m_Jobs.get()); }
+
+        std::unique_ptr<Job[]> m_Jobs;
+        size_t                 m_Size;
+    };
+
+    // owner pushes/pops while several thieves steal; every job should be taken exactly once
+    bool stress_owner_and_thieves(
+        uint32_t num_jobs,
+        uint32_t num_thieves
+    ) {
+        JobPool  pool(num_jobs);
+        JobDeque dq(16); // small on purpose, this forces a couple of grow() calls
+
+        auto taken = std::make_unique<std::atomic<uint32_t>[]>(num_jobs);
+        for (uint32_t i = 0; i < num_jobs; ++i)
+            taken[i] = 0;
+
+        std::atomic<uint32_t> num_taken = 0;
+        std::atomic<bool>     done      = false;
+
+        auto take = [&](Job* j) {
+            taken[pool.index_of(j)].fetch_add(1);
+            num_taken.fetch_add(1);
+        };
+
+        std::vector<std::thread> thieves;
+        for (uint32_t i = 0; i < num_thieves; ++i)
+            thieves.emplace_back([&] {
+                while (!done)
+                    if (Job* j = dq.steal())
+                        take(j);
+                    else
+                        std::this_thread::yield();
+            });
+
+        // owner: push a bunch, pop a few, repeat
+        for (uint32_t i = 0; i < num_jobs; ++i) {
+            dq.push(pool[i]);
+
+            if ((i % 3) == 0)
+                if (Job* j = dq.pop())
+                    take(j);
+        }
+
+        while (Job* j = dq.pop())
+            take(j);
+
+        // thieves may still be holding on to the last couple of jobs
+        while (num_taken < num_jobs)
+            std::this_thread::yield();
+
+        done = true;
+        for (auto& t : thieves)
+            t.join();
+
+        for (uint32_t i = 0; i < num_jobs; ++i)
+            if (taken[i] != 1)
+                return false;
+
+        return dq.empty();
+    }
+
+    // one producer feeding a number of consumers, with either queue type
+    template <typename Q, typename PushFn, typename TakeFn>
+    void contended_transfer(
+        Q&       queue,
+        JobPool& pool,
+        uint32_t num_consumers,
+        PushFn   push,
+        TakeFn   take
+    ) {
+        std::atomic<uint32_t> remaining = static_cast<uint32_t>(pool.m_Size);
+
+        std::vector<std::thread> consumers;
+        for (uint32_t i = 0; i < num_consumers; ++i)
+            consumers.emplace_back([&] {
+                while (remaining > 0)
+                    if (take(queue))
+                        remaining.fetch_sub(1);
+            });
+
+        for (size_t i = 0; i < pool.m_Size; ++i) {
+            push(queue, pool[i]);
+
+            if (take(queue))
+                remaining.fetch_sub(1);
+        }
+
+        while (remaining > 0)
+            if (take(queue))
+                remaining.fetch_sub(1);
+
+        for (auto& t : consumers)
+            t.join();
+    }
+}
+
+TEST_CASE("test_job_deque[lifo_fifo]") {
+    testing::JobPool   pool(4);
+    bop::job::JobDeque dq;
+
+    REQUIRE(dq.empty());
+    REQUIRE(dq.pop()   == nullptr);
+    REQUIRE(dq.steal() == nullptr);
+
+    for (size_t i = 0; i < 4; ++i)
+        dq.push(pool[i]);
+
+    REQUIRE(dq.size() == 4);
+
+    // owner takes from the bottom, thieves from the top
+    REQUIRE(dq.pop()   == pool[3]);
+    REQUIRE(dq.steal() == pool[0]);
+    REQUIRE(dq.pop()   == pool[2]);
+    REQUIRE(dq.pop()   == pool[1]);
+    REQUIRE(dq.pop()   == nullptr);
+    REQUIRE(dq.empty());
+}
+
+TEST_CASE("test_job_deque[grow]") {
+    constexpr uint32_t k_NumJobs = 1000;
+
+    testing::JobPool   pool(k_NumJobs);
+    bop::job::JobDeque dq(4);
+
+    for (size_t i = 0; i < k_NumJobs; ++i)
+        dq.push(pool[i]);
+
+    REQUIRE(dq.size() == k_NumJobs);
+
+    for (size_t i = 0; i < k_NumJobs / 2; ++i)
+        REQUIRE(dq.steal() == pool[i]);
+
+    for (size_t i = k_NumJobs; i > k_NumJobs / 2; --i)
+        REQUIRE(dq.pop() == pool[i - 1]);
+
+    REQUIRE(dq.empty());
+}
+
+TEST_CASE("test_job_deque[steal_half]") {
+    testing::JobPool   pool(10);
+    bop::job::JobDeque victim;
+    bop::job::JobDeque thief;
+
+    bop::job::Job* first = nullptr;
+
+    REQUIRE(victim.steal_half(thief, first) == 0);
+    REQUIRE(first == nullptr);
+
+    for (size_t i = 0; i < 10; ++i)
+        victim.push(pool[i]);
+
+    // the oldest half goes to the thief, the first of those is handed out directly
+    REQUIRE(victim.steal_half(thief, first) == 5);
+    REQUIRE(first == pool[0]);
+    REQUIRE(victim.size() == 5);
+    REQUIRE(thief.size()  == 4);
+
+    for (size_t i = 4; i > 0; --i)
+        REQUIRE(thief.pop() == pool[i]);
+
+    // a single remaining job can be stolen as well; the count may be limited
+    REQUIRE(victim.steal_half(thief, first, 1) == 1);
+    REQUIRE(first == pool[5]);
+    REQUIRE(thief.empty());
+
+    REQUIRE(victim.steal_half(thief, first) == 2);
+    REQUIRE(victim.steal_half(thief, first) == 1);
+    REQUIRE(victim.steal_half(thief, first) == 1);
+    REQUIRE(victim.empty());
+}
+
+TEST_CASE("test_job_deque[stress]") {
+    REQUIRE(testing::stress_owner_and_thieves(100'000, 1));
+    REQUIRE(testing::stress_owner_and_thieves(100'000, 3));
+    REQUIRE(testing::stress_owner_and_thieves(100'000, 7));
+}
+
+TEST_CASE("test_job_deque[throughput]", "[.benchmark]") {
+    constexpr uint32_t k_NumJobs = 10'000;
+
+    testing::JobPool pool(k_NumJobs);
+
+    BENCHMARK("JobQueue push/pop (owner only)") {
+        bop::job::JobQueue q;
+
+        for (size_t i = 0; i < k_NumJobs; ++i)
+            q.push(pool[i]);
+
+        while (q.pop());
+    };
+
+    BENCHMARK("JobDeque push/pop (owner only)") {
+        bop::job::JobDeque dq;
+
+        for (size_t i = 0; i < k_NumJobs; ++i)
+            dq.push(pool[i]);
+
+        while (dq.pop());
+    };
+
+    BENCHMARK("JobQueue contended (1 producer, 3 consumers)") {
+        bop::job::JobQueue q;
+
+        testing::contended_transfer(
+            q, pool, 3,
+            [](bop::job::JobQueue& q, bop::job::Job* j) { q.push(j); },
+            [](bop::job::JobQueue& q) { return q.pop() != nullptr; }
+        );
+    };
+
+    BENCHMARK("JobDeque contended (1 owner, 3 thieves)") {
+        bop::job::JobDeque dq;
+
+        // the owner pops, everyone else steals
+        auto owner = std::this_thread::get_id();
+
+        testing::contended_transfer(
+            dq, pool, 3,
+            [](bop::job::JobDeque& dq, bop::job::Job* j) { dq.push(j); },
+            [owner](bop::job::JobDeque& dq) {
+                if (std::this_thread::get_id() == owner)
+                    return dq.pop() != nullptr;
+                else
+                    return dq.steal() != nullptr;
+            }
+        );
+    };
+}
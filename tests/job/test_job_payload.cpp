@@ -0,0 +1,298 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "../../src/job/co_generator.h"
+#include "../../src/job/co_job.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    // heap allocations made by the calling thread (counted by the replaced global operator new below)
+    thread_local uint64_t l_NumHeapAllocations = 0;
+
+    // forwards to new/delete, counting allocations from any thread
+    class CountingResource:
+        public std::pmr::memory_resource
+    {
+    public:
+        std::atomic<uint64_t> m_NumAllocations = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            ++m_NumAllocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    struct AllocationCount {
+        uint64_t m_Heap     = 0; // global new on the scheduling thread
+        uint64_t m_Resource = 0; // the pool's memory resource (any thread)
+    };
+
+    // schedules a batch from within a worker, twice; the second batch can be served from recycled jobs.
+    // Returns the allocations that were made while scheduling the second batch
+    template <typename MakeFn>
+    AllocationCount count_schedule_allocations(
+        uint32_t num_jobs,
+        MakeFn   make_work
+    ) {
+        CountingResource resource;
+        AllocationCount  result;
+
+        std::atomic<uint32_t> done = 0;
+
+        {
+            bop::job::JobSystem pool(1, &resource);
+
+            for (uint32_t round = 0; round < 2; ++round) {
+                uint32_t expected = done + num_jobs + 1;
+
+                pool.schedule([&] {
+                    uint64_t heap_before     = l_NumHeapAllocations;
+                    uint64_t resource_before = resource.m_NumAllocations;
+
+                    for (uint32_t i = 0; i < num_jobs; ++i)
+                        pool.schedule(make_work(done, i));
+
+                    result.m_Heap     = l_NumHeapAllocations     - heap_before;
+                    result.m_Resource = resource.m_NumAllocations - resource_before;
+
+                    ++done;
+                });
+
+                while (done < expected)
+                    std::this_thread::yield();
+            }
+        }
+
+        return result;
+    }
+
+    bop::job::CoJob<int> twice(int x) {
+        co_return 2 * x;
+    }
+
+    int sum_iota(int n) {
+        int result = 0;
+
+        for (int x : bop::job::iota(n))
+            result += x;
+
+        return result;
+    }
+}
+
+// count every heap allocation in this test executable (only the counter is thread local). All forms
+// are replaced, so whatever is allocated is released by the matching function (see tests/CMakeLists.txt)
+void* operator new(std::size_t size) {
+    ++testing::l_NumHeapAllocations;
+
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    ++testing::l_NumHeapAllocations;
+
+    std::size_t align   = static_cast<std::size_t>(alignment);
+    std::size_t rounded = (size + align - 1) / align * align;
+
+    if (void* p = std::aligned_alloc(align, rounded ? rounded : align))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ++testing::l_NumHeapAllocations;
+
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    ++testing::l_NumHeapAllocations;
+
+    std::size_t align   = static_cast<std::size_t>(alignment);
+    std::size_t rounded = (size + align - 1) / align * align;
+
+    return std::aligned_alloc(align, rounded ? rounded : align);
+}
+
+void* operator new[](std::size_t size)                                                        { return operator new(size); }
+void* operator new[](std::size_t size, std::align_val_t alignment)                            { return operator new(size, alignment); }
+void* operator new[](std::size_t size, const std::nothrow_t& tag)                    noexcept { return operator new(size, tag); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept { return operator new(size, alignment, tag); }
+
+void operator delete(void* p)                                         noexcept { std::free(p); }
+void operator delete(void* p, std::size_t)                            noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t)                       noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t)          noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&)                  noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete[](void* p)                                         noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t)                            noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t)                       noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t)          noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&)                  noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+TEST_CASE("test_job_payload[layout]") {
+    static_assert(sizeof(bop::job::Job)  == 128);
+    static_assert(alignof(bop::job::Job) == 64);
+
+    // a couple of references and some values, which is what most jobs capture
+    std::atomic<uint32_t> done  = 0;
+    uint32_t              index = 0;
+    float                 scale = 0.5f;
+    const float*          data  = &scale;
+
+    auto typical = [&done, index, scale, data] { done += static_cast<uint32_t>(data[0] * scale) + index; };
+
+    static_assert(bop::job::Job::Work::fits_inline<decltype(typical)>());
+}
+
+TEST_CASE("test_job_payload[no_allocations]") {
+    constexpr uint32_t k_NumJobs = 256;
+
+    // typical captures are stored inside of the recycled job, no allocations at all
+    auto small = testing::count_schedule_allocations(k_NumJobs, [](std::atomic<uint32_t>& done, uint32_t i) {
+        return [&done, i, scale = 2.0f] {
+            if (i * scale >= 0)
+                ++done;
+        };
+    });
+
+    REQUIRE(small.m_Heap     == 0);
+    REQUIRE(small.m_Resource == 0);
+
+    // larger ones are spilled to the memory resource of the pool, never straight to the heap
+    auto large = testing::count_schedule_allocations(k_NumJobs, [](std::atomic<uint32_t>& done, uint32_t i) {
+        std::array<uint32_t, 32> payload;
+        payload.fill(i);
+
+        return [&done, payload] {
+            if (payload.front() == payload.back())
+                ++done;
+        };
+    });
+
+    REQUIRE(large.m_Resource == k_NumJobs);
+    REQUIRE(large.m_Heap     == large.m_Resource); // (the counting resource forwards to new/delete)
+}
+
+TEST_CASE("test_job_payload[schedule]", "[.benchmark]") {
+    constexpr uint32_t k_NumJobs = 1'000;
+
+    bop::job::JobSystem pool(1);
+
+    std::atomic<uint32_t> done = 0;
+
+    BENCHMARK("schedule 1000 typical lambdas from a worker") {
+        uint32_t expected = done + k_NumJobs + 1;
+
+        pool.schedule([&] {
+            for (uint32_t i = 0; i < k_NumJobs; ++i)
+                pool.schedule([&done, i, scale = 2.0f] {
+                    if (i * scale >= 0)
+                        ++done;
+                });
+
+            ++done;
+        });
+
+        while (done < expected)
+            std::this_thread::yield();
+    };
+
+    auto allocations = testing::count_schedule_allocations(k_NumJobs, [](std::atomic<uint32_t>& done, uint32_t i) {
+        return [&done, i, scale = 2.0f] {
+            if (i * scale >= 0)
+                ++done;
+        };
+    });
+
+    // (reported with the benchmark results)
+    WARN("heap allocations per schedule: " << double(allocations.m_Heap) / k_NumJobs);
+    CHECK(allocations.m_Heap == 0);
+}
+
+TEST_CASE("test_job_payload[co_frame]", "[.benchmark]") {
+    using bop::job::JobSystem;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int k_NumCoroutines = 1'000'000;
+
+    testing::CountingResource resource;
+    JobSystem                 pool(1, &resource);
+
+    // jobs are created and destroyed without running them, generators run to completion
+    // (returns a summary, reporting is left to the main thread)
+    auto measure = [&](const char* name, auto&& create_one) {
+        create_one(0); // warm up
+
+        uint64_t heap_before     = testing::l_NumHeapAllocations;
+        uint64_t resource_before = resource.m_NumAllocations;
+        int64_t  total           = 0;
+
+        auto start = Clock::now();
+
+        for (int i = 0; i < k_NumCoroutines; ++i)
+            total += create_one(i);
+
+        auto     elapsed              = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        uint64_t heap_allocations     = testing::l_NumHeapAllocations - heap_before;
+        uint64_t resource_allocations = resource.m_NumAllocations     - resource_before;
+
+        std::ostringstream summary;
+
+        summary
+            << name << ": " << (elapsed / k_NumCoroutines) << " ns per coroutine, "
+            << heap_allocations     << " heap allocations, "
+            << resource_allocations << " resource allocations"
+            << " (" << total << ")";
+
+        return summary.str();
+    };
+
+    std::string co_job_worker;
+    std::string generator_worker;
+
+    std::atomic<bool> done = false;
+
+    // on a worker, frames come from its own cache
+    pool.schedule([&] {
+        co_job_worker    = measure("co_job (worker)",    [](int i) { auto job = testing::twice(i); return i; });
+        generator_worker = measure("generator (worker)", [](int i) { return testing::sum_iota(i % 4); });
+
+        done = true;
+    });
+
+    while (!done)
+        std::this_thread::yield();
+
+    WARN(co_job_worker);
+    WARN(generator_worker);
+
+    // on any other thread, from the global heap
+    WARN(measure("co_job (external)",    [](int i) { auto job = testing::twice(i); return i; }));
+    WARN(measure("generator (external)", [](int i) { return testing::sum_iota(i % 4); }));
+}
@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../../src/job/job_system.h"
+#include "../../src/util/platform.h"
+
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+    #include <sched.h>
+    #include <time.h>
+#endif
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using bop::job::JobSystem;
+
+    // the first cpu this process may run on (cpu 0 may be excluded by a cpuset or container)
+    uint32_t first_allowed_cpu() {
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+            for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &allowed))
+                    return cpu;
+#endif
+
+        return 0;
+    }
+
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+    // spent by the calling thread
+    std::chrono::nanoseconds thread_cpu_time() {
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+        return std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec);
+    }
+#endif
+
+    void wait_for(const std::atomic<uint32_t>& counter, uint32_t expected) {
+        while (counter < expected)
+            std::this_thread::yield();
+    }
+
+    // schedules a number of jobs, each checks that it runs on a worker of the given pool
+    uint32_t count_foreign_executions(JobSystem& pool, uint32_t num_jobs) {
+        std::atomic<uint32_t> done    = 0;
+        std::atomic<uint32_t> foreign = 0;
+
+        for (uint32_t i = 0; i < num_jobs; ++i)
+            pool.schedule([&] {
+                if (
+                    (&JobSystem::get_current() != &pool) ||
+                    (pool.get_thread_index() >= pool.get_num_threads())
+                )
+                    ++foreign;
+
+                ++done;
+            });
+
+        wait_for(done, num_jobs);
+
+        return foreign;
+    }
+}
+
+TEST_CASE("test_job_pools[coexist]") {
+    using bop::job::JobSystem;
+
+    JobSystem latency(1);
+    JobSystem batch(3);
+
+    REQUIRE(latency.get_num_threads() == 1);
+    REQUIRE(batch.get_num_threads()   == 3);
+
+    REQUIRE(!latency.is_worker());
+    REQUIRE(!batch.is_worker());
+
+    REQUIRE(testing::count_foreign_executions(latency, 200) == 0);
+    REQUIRE(testing::count_foreign_executions(batch,   200) == 0);
+
+    // from within a pool, the convenience functions stay in that pool
+    std::atomic<uint32_t> done   = 0;
+    std::atomic<bool>     nested = false;
+
+    batch.schedule([&] {
+        bop::schedule([&] {
+            nested = batch.is_worker();
+            ++done;
+        });
+    });
+
+    testing::wait_for(done, 1);
+    REQUIRE(nested);
+
+    // both pools may run a parallel loop at the same time
+    std::atomic<uint64_t> sum_a = 0;
+    std::atomic<uint64_t> sum_b = 0;
+
+    std::thread other([&] {
+        latency.parallel_for(0u, 1000u, [&](uint32_t i) { sum_a += i; });
+    });
+
+    batch.parallel_for(0u, 1000u, [&](uint32_t i) { sum_b += i; });
+    other.join();
+
+    REQUIRE(sum_a == 1000 * 999 / 2);
+    REQUIRE(sum_b == 1000 * 999 / 2);
+}
+
+TEST_CASE("test_job_pools[bounded]") {
+    using bop::job::JobSystem;
+
+    JobSystem pool(1, std::pmr::new_delete_resource(), 2);
+
+    REQUIRE(pool.get_queue_capacity() == 2);
+
+    std::atomic<bool>     started = false;
+    std::atomic<bool>     go      = false;
+    std::atomic<uint32_t> done    = 0;
+
+    // keep the only worker busy
+    pool.schedule([&] {
+        started = true;
+
+        while (!go)
+            std::this_thread::yield();
+    });
+
+    while (!started)
+        std::this_thread::yield();
+
+    auto work = [&] { ++done; };
+
+    REQUIRE(pool.try_schedule(work) != nullptr);
+    REQUIRE(pool.try_schedule(work) != nullptr);
+    REQUIRE(pool.try_schedule(work) == nullptr); // full
+
+    go = true;
+    testing::wait_for(done, 2);
+
+    REQUIRE(done == 2);
+}
+
+TEST_CASE("test_job_pools[teardown]") {
+    using bop::job::JobSystem;
+    using namespace std::chrono_literals;
+
+    std::atomic<uint32_t> done = 0;
+
+    // destroying a pool with queued work should neither hang nor crash
+    {
+        JobSystem pool(2);
+
+        for (uint32_t i = 0; i < 100; ++i)
+            pool.schedule([&] {
+                std::this_thread::sleep_for(1ms);
+                ++done;
+            });
+    }
+
+    REQUIRE(done <= 100);
+
+    // and a new pool can be set up afterwards
+    JobSystem pool(2);
+
+    REQUIRE(testing::count_foreign_executions(pool, 10) == 0);
+}
+
+TEST_CASE("test_job_pools[placement]") {
+    using bop::job::JobSystem;
+    using bop::job::e_Placement;
+
+    // without a thread count, a pinned pool gets a worker per selected cpu
+    uint32_t target = testing::first_allowed_cpu();
+
+    JobSystem pinned(std::nullopt, std::pmr::new_delete_resource(), std::nullopt, e_Placement::explicit_list, { target });
+
+    REQUIRE(pinned.get_num_threads()   == 1);
+    REQUIRE(pinned.get_placement()     == e_Placement::explicit_list);
+    REQUIRE(pinned.get_worker_cpu(0)   == target);
+
+    std::atomic<uint32_t> done = 0;
+    std::atomic<int>      cpu  = -1;
+
+    pinned.schedule([&] {
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+        cpu = sched_getcpu();
+#else
+        cpu = static_cast<int>(target);
+#endif
+        ++done;
+    });
+
+    testing::wait_for(done, 1);
+    REQUIRE(cpu == static_cast<int>(target));
+
+    JobSystem compact(std::nullopt, std::pmr::new_delete_resource(), std::nullopt, e_Placement::compact);
+    JobSystem unpinned(2);
+
+    REQUIRE(compact.get_num_threads() == bop::util::CpuTopology::detect().get_num_cpus());
+    REQUIRE(compact.get_worker_cpu(0).has_value());
+    REQUIRE(!unpinned.get_worker_cpu(0).has_value());
+
+    REQUIRE(testing::count_foreign_executions(compact, 100) == 0);
+}
+
+TEST_CASE("test_job_pools[wakeup]") {
+    using bop::job::JobSystem;
+    using namespace std::chrono;
+    using namespace std::chrono_literals;
+
+    JobSystem pool(2);
+
+    // parked workers should be woken up right away, not after some timeout
+    constexpr uint32_t k_NumRounds = 10;
+
+    std::atomic<uint32_t> done    = 0;
+    nanoseconds           waiting = 0ns;
+
+    for (uint32_t i = 0; i < k_NumRounds; ++i) {
+        std::this_thread::sleep_for(20ms); // (long enough for the workers to park)
+
+        auto start = steady_clock::now();
+
+        pool.schedule([&] { ++done; });
+        testing::wait_for(done, i + 1);
+
+        waiting += steady_clock::now() - start;
+    }
+
+    REQUIRE(waiting < k_NumRounds * 50ms);
+
+    // jobs for a specific worker end up on that worker
+    std::atomic<uint32_t> executed_by = 0;
+
+    pool.schedule(
+        [&] {
+            executed_by = pool.get_thread_index();
+            ++done;
+        },
+        nullptr, 
+        1 // thread index
+    );
+
+    testing::wait_for(done, k_NumRounds + 1);
+    REQUIRE(executed_by == 1);
+}
+
+TEST_CASE("test_job_pools[steal_stats]") {
+    using bop::job::JobSystem;
+
+    constexpr uint32_t k_NumJobs = 64;
+
+    JobSystem pool(2);
+
+    // a worker fills its own deque and then refuses to help, so the other one has to steal everything
+    std::atomic<uint32_t> done  = 0;
+    std::atomic<uint32_t> owner = 0;
+
+    pool.schedule([&] {
+        owner = pool.get_thread_index();
+
+        for (uint32_t i = 0; i < k_NumJobs; ++i)
+            pool.schedule([&] { ++done; });
+
+        testing::wait_for(done, k_NumJobs);
+    });
+
+    testing::wait_for(done, k_NumJobs);
+
+    auto stats = pool.get_steal_stats(1 - owner);
+
+    REQUIRE(stats.m_JobsMoved == k_NumJobs);
+    REQUIRE(stats.m_Successes >  0);
+    REQUIRE(stats.m_Successes <  stats.m_JobsMoved); // batches of more than a single job
+    REQUIRE(stats.m_Attempts  >= stats.m_Successes);
+
+    REQUIRE(pool.get_steal_stats(owner).m_JobsMoved == 0);
+}
+
+TEST_CASE("test_job_pools[nested_wait]") {
+    using bop::job::JobSystem;
+    using namespace std::chrono_literals;
+
+    // a single worker that waits on a job has to execute that job itself
+    JobSystem pool(1);
+
+    constexpr uint32_t k_Depth = 8;
+
+    std::atomic<uint32_t> deepest = 0;
+
+    auto nest = [&](auto& self, uint32_t depth) -> void {
+        deepest = std::max(deepest.load(), depth);
+
+        if (depth < k_Depth)
+            pool.schedule([&self, depth] { self(self, depth + 1); }).wait();
+    };
+
+    pool.schedule([&] { nest(nest, 1); }).wait();
+
+    REQUIRE(deepest == k_Depth);
+
+    // threads outside of the pool park until the job completes
+    std::atomic<bool> finished = false;
+
+    pool.schedule([&] {
+        std::this_thread::sleep_for(20ms);
+        finished = true;
+    }).wait();
+
+    REQUIRE(finished);
+
+    // a job that completed before it's waited for is still around, even while other jobs come and go
+    std::atomic<uint32_t> others = 0;
+
+    auto& early = pool.schedule([&] {
+        for (int i = 0; i < 100; ++i)
+            pool.schedule([&] { ++others; });
+    });
+
+    std::this_thread::sleep_for(5ms);
+
+    early.wait();
+    testing::wait_for(others, 100);
+
+    // the same goes for a held one
+    auto held = pool.schedule_awaitable([] {});
+
+    std::this_thread::sleep_for(5ms);
+
+    for (int i = 0; i < 100; ++i)
+        pool.schedule([&] { ++others; });
+
+    held.wait();
+    testing::wait_for(others, 200);
+
+#if BOP_PLATFORM == BOP_PLATFORM_LINUX
+    // a loop that is started outside of the pool parks as well, rather than using up a cpu meanwhile
+    auto before = testing::thread_cpu_time();
+
+    pool.parallel_for(0, 4, [](int) { std::this_thread::sleep_for(25ms); }, 1);
+
+    REQUIRE(testing::thread_cpu_time() - before < 20ms);
+#endif
+}
+
+TEST_CASE("test_job_pools[wakeup_latency]", "[.benchmark]") {
+    using bop::job::JobSystem;
+    using namespace std::chrono_literals;
+
+    JobSystem pool(2);
+
+    std::atomic<uint32_t> done = 0;
+
+    BENCHMARK("round trip, busy pool") {
+        uint32_t expected = done + 1;
+
+        pool.schedule([&] { ++done; });
+        testing::wait_for(done, expected);
+    };
+
+    BENCHMARK("round trip, parked pool") {
+        std::this_thread::sleep_for(5ms);
+
+        uint32_t expected = done + 1;
+
+        pool.schedule([&] { ++done; });
+        testing::wait_for(done, expected);
+    };
+}
+
+TEST_CASE("test_job_pools[configurations]", "[.benchmark]") {
+    using bop::job::JobSystem;
+
+    constexpr uint32_t k_NumItems = 100'000;
+
+    std::vector<float> data(k_NumItems, 1.0f);
+
+    auto work = [&](uint32_t i) { data[i] = data[i] * 0.5f + 1.0f; };
+
+    JobSystem single(1);
+    JobSystem wide;
+    JobSystem bounded(std::nullopt, std::pmr::new_delete_resource(), 64);
+    JobSystem scatter(std::nullopt, std::pmr::new_delete_resource(), std::nullopt, bop::job::e_Placement::scatter);
+
+    BENCHMARK("single worker") {
+        single.parallel_for(0u, k_NumItems, work);
+    };
+
+    BENCHMARK("hardware concurrency") {
+        wide.parallel_for(0u, k_NumItems, work);
+    };
+
+    BENCHMARK("hardware concurrency, bounded queues") {
+        bounded.parallel_for(0u, k_NumItems, work);
+    };
+
+    BENCHMARK("pinned, scatter") {
+        scatter.parallel_for(0u, k_NumItems, work);
+    };
+}
@@ -0,0 +1,227 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using bop::job::JobSystem;
+    using bop::job::e_Priority;
+
+    void wait_until(const std::atomic<uint32_t>& counter, uint32_t expected) {
+        while (counter < expected)
+            std::this_thread::yield();
+    }
+
+    // keeps a critical job in the queue until told to stop (or until the cap was reached)
+    void flood(
+        JobSystem&             pool,
+        std::atomic<bool>&     stop,
+        std::atomic<uint32_t>& count,
+        uint32_t               cap
+    ) {
+        if (stop || (++count >= cap))
+            return;
+
+        pool.schedule(
+            [&pool, &stop, &count, cap] { flood(pool, stop, count, cap); },
+            nullptr,
+            std::nullopt,
+            e_Priority::critical
+        );
+    }
+
+    // occupies a worker until 'go' is set; returns once the worker picked it up
+    void block_worker(
+        JobSystem&         pool,
+        std::atomic<bool>& go
+    ) {
+        std::atomic<bool> started = false;
+
+        pool.schedule([&] {
+            started = true;
+
+            while (!go)
+                std::this_thread::yield();
+        });
+
+        while (!started)
+            std::this_thread::yield();
+    }
+
+    double mean(const std::vector<uint32_t>& values) {
+        double sum = 0;
+
+        for (auto x : values)
+            sum += x;
+
+        return sum / values.size();
+    }
+}
+
+TEST_CASE("test_job_priority[order]") {
+    using bop::job::JobSystem;
+    using bop::job::e_Priority;
+
+    constexpr uint32_t k_NumPerClass = 10;
+
+    JobSystem pool(1);
+
+    // block the only worker while everything is queued up
+    std::atomic<bool>     go         = false;
+    std::atomic<uint32_t> done       = 0;
+    std::atomic<uint32_t> mismatches = 0;
+
+    testing::block_worker(pool, go);
+
+    std::vector<e_Priority> executed; // only touched by the worker
+
+    for (auto priority : { e_Priority::background, e_Priority::normal, e_Priority::critical })
+        for (uint32_t i = 0; i < k_NumPerClass; ++i)
+            pool.schedule(
+                [&, priority] {
+                    if (pool.current_priority() != priority)
+                        ++mismatches;
+
+                    executed.push_back(priority);
+                    ++done;
+                },
+                nullptr,
+                std::nullopt,
+                priority
+            );
+
+    go = true;
+    testing::wait_until(done, 3 * k_NumPerClass);
+
+    REQUIRE(mismatches == 0);
+
+    // aging may let a lower class go first now and then, so compare the average position
+    std::vector<uint32_t> positions[bop::job::k_NumPriorities];
+
+    for (uint32_t i = 0; i < executed.size(); ++i)
+        positions[static_cast<uint32_t>(executed[i])].push_back(i);
+
+    REQUIRE(testing::mean(positions[0]) < testing::mean(positions[1]));
+    REQUIRE(testing::mean(positions[1]) < testing::mean(positions[2]));
+}
+
+TEST_CASE("test_job_priority[aging]") {
+    using bop::job::JobSystem;
+    using bop::job::e_Priority;
+
+    constexpr uint32_t k_Cap = 100'000;
+
+    JobSystem pool(1);
+
+    std::atomic<bool>     go           = false;
+    std::atomic<bool>     stop         = false;
+    std::atomic<uint32_t> flood_count  = 0;
+    std::atomic<uint32_t> seen_by_bg   = 0;
+    std::atomic<uint32_t> done         = 0;
+
+    testing::block_worker(pool, go);
+
+    pool.schedule(
+        [&] {
+            seen_by_bg = flood_count.load();
+            stop       = true;
+            ++done;
+        },
+        nullptr,
+        std::nullopt,
+        e_Priority::background
+    );
+
+    pool.schedule(
+        [&] { testing::flood(pool, stop, flood_count, k_Cap); },
+        nullptr,
+        std::nullopt,
+        e_Priority::critical
+    );
+
+    go = true;
+    testing::wait_until(done, 1);
+
+    // the background job must get a turn while there is still critical work queued up
+    REQUIRE(seen_by_bg < k_Cap);
+}
+
+TEST_CASE("test_job_priority[then]") {
+    using bop::job::Job;
+    using bop::job::JobSystem;
+    using bop::job::e_Priority;
+
+    JobSystem pool(2);
+
+    std::atomic<bool>     go   = false;
+    std::atomic<uint32_t> done = 0;
+
+    e_Priority inherited  = e_Priority::normal;
+    e_Priority overridden = e_Priority::normal;
+
+    Job& first = pool.schedule(
+        [&] {
+            while (!go)
+                std::this_thread::yield();
+        },
+        nullptr,
+        std::nullopt,
+        e_Priority::background
+    );
+
+    first
+        .then([&] { inherited = pool.current_priority(); })
+        .then(
+            [&] {
+                overridden = pool.current_priority();
+                ++done;
+            },
+            std::nullopt,
+            e_Priority::critical
+        );
+
+    go = true;
+    testing::wait_until(done, 1);
+
+    REQUIRE(inherited  == e_Priority::background);
+    REQUIRE(overridden == e_Priority::critical);
+
+    // outside of a job there is no priority to speak of
+    REQUIRE(pool.current_priority() == e_Priority::normal);
+}
+
+TEST_CASE("test_job_priority[latency]", "[.benchmark]") {
+    using bop::job::JobSystem;
+    using bop::job::e_Priority;
+
+    constexpr uint32_t k_NumBackground = 1'000;
+
+    JobSystem pool(2);
+
+    std::atomic<uint32_t> done = 0;
+
+    auto busy = [] {
+        volatile uint32_t x = 0;
+
+        for (uint32_t i = 0; i < 1'000; ++i)
+            x = x + i;
+    };
+
+    // a single urgent job while the pool is saturated with background work
+    for (auto priority : { e_Priority::normal, e_Priority::critical })
+        BENCHMARK_ADVANCED(priority == e_Priority::critical ? "critical behind background" : "normal behind background")(Catch::Benchmark::Chronometer meter) {
+            for (uint32_t i = 0; i < k_NumBackground; ++i)
+                pool.schedule(busy, nullptr, std::nullopt, e_Priority::background);
+
+            uint32_t expected = done + 1;
+
+            meter.measure([&] {
+                pool.schedule([&] { ++done; }, nullptr, std::nullopt, priority);
+                testing::wait_until(done, expected);
+            });
+        };
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../../src/job/job_slab.h"
+#include "../../src/job/job_system.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using bop::job::JobSlab;
+
+    std::vector<void*> allocate_n(JobSlab& slab, uint32_t n) {
+        std::vector<void*> result;
+
+        for (uint32_t i = 0; i < n; ++i)
+            result.push_back(slab.allocate());
+
+        return result;
+    }
+}
+
+TEST_CASE("test_job_slab[local]") {
+    using bop::job::JobSlab;
+
+    bop::job::SlabFootprint footprint;
+    JobSlab                 slab(std::pmr::new_delete_resource(), &footprint);
+
+    auto jobs = testing::allocate_n(slab, 2 * JobSlab::k_SlotsPerChunk + 1);
+
+    REQUIRE(slab.get_num_chunks() == 3);
+    REQUIRE(slab.get_num_live()   == jobs.size());
+    REQUIRE(footprint.m_Current   == 3 * JobSlab::k_ChunkSize);
+
+    // every job is a separate, properly aligned slot of this slab
+    std::sort(jobs.begin(), jobs.end());
+
+    REQUIRE(std::adjacent_find(jobs.begin(), jobs.end()) == jobs.end());
+
+    for (void* job : jobs) {
+        REQUIRE(JobSlab::owner_of(job) == &slab);
+        REQUIRE((reinterpret_cast<uintptr_t>(job) % alignof(bop::job::Job)) == 0);
+    }
+
+    // freed jobs are handed out again before any new chunk is allocated
+    for (void* job : jobs)
+        slab.free_local(job);
+
+    REQUIRE(slab.get_num_live() == 0);
+
+    testing::allocate_n(slab, static_cast<uint32_t>(jobs.size()));
+
+    REQUIRE(slab.get_num_chunks() == 3);
+    REQUIRE(footprint.m_Peak      == 3 * JobSlab::k_ChunkSize);
+}
+
+TEST_CASE("test_job_slab[remote]") {
+    using bop::job::JobSlab;
+
+    constexpr uint32_t k_NumJobs = 1000;
+
+    JobSlab slab(std::pmr::new_delete_resource());
+
+    auto jobs = testing::allocate_n(slab, k_NumJobs);
+    auto num_chunks = slab.get_num_chunks();
+
+    // several threads hand back jobs at the same time
+    std::vector<std::thread> threads;
+
+    for (uint32_t t = 0; t < 4; ++t)
+        threads.emplace_back([&, t] {
+            for (uint32_t i = t; i < k_NumJobs; i += 4)
+                slab.free_remote(jobs[i]);
+        });
+
+    for (auto& t : threads)
+        t.join();
+
+    // until the owner collects them, they still count as live
+    REQUIRE(slab.get_num_live() == k_NumJobs);
+
+    testing::allocate_n(slab, k_NumJobs);
+
+    REQUIRE(slab.get_num_live()   == k_NumJobs);
+    REQUIRE(slab.get_num_chunks() == num_chunks);
+}
+
+TEST_CASE("test_job_slab[trim]") {
+    using bop::job::JobSlab;
+
+    bop::job::SlabFootprint footprint;
+    JobSlab                 slab(std::pmr::new_delete_resource(), &footprint);
+
+    auto jobs = testing::allocate_n(slab, 8 * JobSlab::k_SlotsPerChunk);
+
+    REQUIRE(slab.get_num_chunks() == 8);
+
+    // chunks that are in use stay
+    REQUIRE(slab.trim() == 0);
+
+    for (void* job : jobs)
+        slab.free_remote(job);
+
+    // the first trim still covers the demand that was seen since the previous one...
+    REQUIRE(slab.trim() == 0);
+    REQUIRE(slab.get_num_live() == 0);
+
+    // ...after that, only a spare chunk is kept
+    REQUIRE(slab.trim() == 8 - JobSlab::k_SpareChunks);
+    REQUIRE(slab.get_num_chunks() == JobSlab::k_SpareChunks);
+    REQUIRE(footprint.m_Current   == JobSlab::k_SpareChunks * JobSlab::k_ChunkSize);
+    REQUIRE(footprint.m_Peak      == 8 * JobSlab::k_ChunkSize);
+
+    // the remaining chunk is still perfectly usable
+    testing::allocate_n(slab, JobSlab::k_SlotsPerChunk);
+    REQUIRE(slab.get_num_chunks() == JobSlab::k_SpareChunks);
+}
+
+TEST_CASE("test_job_slab[producer_consumer]") {
+    using bop::job::JobSlab;
+    using bop::job::JobSystem;
+
+    constexpr uint32_t k_NumRounds    = 20;
+    constexpr uint32_t k_JobsPerRound = 2000;
+
+    JobSystem pool(2);
+
+    // jobs are allocated on this thread and completed by the workers; the memory should flow back
+    // instead of piling up on either side
+    std::atomic<uint32_t> done = 0;
+
+    for (uint32_t round = 0; round < k_NumRounds; ++round) {
+        for (uint32_t i = 0; i < k_JobsPerRound; ++i)
+            pool.schedule([&] { ++done; });
+
+        while (done < (round + 1) * k_JobsPerRound)
+            std::this_thread::yield();
+    }
+
+    auto usage = pool.get_job_memory_usage();
+
+    REQUIRE(usage.m_Current >  0);
+    REQUIRE(usage.m_Current <= usage.m_Peak);
+    REQUIRE(usage.m_Peak    <  4 * k_JobsPerRound * JobSlab::k_SlotSize);
+}
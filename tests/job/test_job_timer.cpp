@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../../src/job/co_job.h"
+#include "../../src/job/co_sleep.h"
+#include "../../src/job/co_when.h"
+#include "../../src/job/job_system.h"
+#include "../../src/job/job_timer.h"
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+    using namespace std::chrono_literals;
+
+    using bop::job::CoJob;
+    using bop::job::TimerWheel;
+
+    struct TickRecorder:
+        public bop::job::TimerNode
+    {
+        void expire() noexcept override {
+            m_Expired = true;
+        }
+
+        void discard() noexcept override {
+            m_Discarded = true;
+        }
+
+        bool m_Expired   = false;
+        bool m_Discarded = false;
+    };
+
+    // advances the wheel up to (and including) the given tick, returns the number of expired nodes
+    size_t advance_to(TimerWheel& wheel, TimerWheel::Timepoint start, uint64_t tick) {
+        size_t count = 0;
+
+        for (auto* node = wheel.advance(start + tick * TimerWheel::k_Resolution); node; ) {
+            auto* next = node->m_Next;
+
+            node->expire();
+            node = next;
+            ++count;
+        }
+
+        return count;
+    }
+
+    CoJob<TimerWheel::Duration> timed_sleep(TimerWheel::Duration delay) {
+        auto start = TimerWheel::Clock::now();
+
+        co_await bop::sleep_for(delay);
+
+        co_return TimerWheel::Clock::now() - start;
+    }
+
+    CoJob<int> sleep_many(int n) {
+        std::vector<CoJob<TimerWheel::Duration>> sleepers;
+
+        for (int i = 0; i < n; ++i)
+            sleepers.push_back(timed_sleep(std::chrono::milliseconds(1 + (i % 10) * 3)));
+
+        int on_time = 0;
+        int i       = 0;
+
+        for (auto elapsed : co_await bop::job::when_all(std::move(sleepers)))
+            if (elapsed >= std::chrono::milliseconds(1 + (i++ % 10) * 3))
+                ++on_time;
+
+        co_return on_time;
+    }
+
+    template <typename Predicate>
+    bool wait_until_true(Predicate pred, TimerWheel::Duration timeout = 5s) {
+        auto deadline = TimerWheel::Clock::now() + timeout;
+
+        while (!pred())
+            if (TimerWheel::Clock::now() > deadline)
+                return false;
+            else
+                std::this_thread::sleep_for(1ms);
+
+        return true;
+    }
+}
+
+TEST_CASE("test_job_timer[wheel]") {
+    using testing::TimerWheel;
+
+    TimerWheel::Timepoint start;
+    TimerWheel            wheel(start);
+
+    // level 0, block boundaries, higher levels and the overflow list
+    std::vector<uint64_t> ticks = { 1, 2, 63, 64, 65, 127, 4095, 4096, 4097, 300'000, 16'777'216, 20'000'000 };
+
+    std::vector<testing::TickRecorder> nodes(ticks.size());
+
+    for (size_t i = 0; i < ticks.size(); ++i)
+        REQUIRE(wheel.add(&nodes[i], start + ticks[i] * TimerWheel::k_Resolution) == ticks[i]);
+
+    REQUIRE(!wheel.empty());
+    REQUIRE(wheel.next_expiry() == 1);
+
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        // nothing expires early, and each node expires right at its tick
+        testing::advance_to(wheel, start, ticks[i] - 1);
+        REQUIRE(!nodes[i].m_Expired);
+
+        REQUIRE(testing::advance_to(wheel, start, ticks[i]) == 1);
+        REQUIRE(nodes[i].m_Expired);
+    }
+
+    REQUIRE(wheel.empty());
+    REQUIRE(wheel.next_expiry() == TimerWheel::k_Never);
+
+    // deadlines are rounded up to whole ticks, overdue ones expire on the next one
+    testing::TickRecorder late;
+    testing::TickRecorder partial;
+
+    REQUIRE(wheel.add(&late,    start) == 20'000'001);
+    REQUIRE(wheel.add(&partial, start + 20'000'010 * TimerWheel::k_Resolution + std::chrono::microseconds(1)) == 20'000'011);
+
+    REQUIRE(testing::advance_to(wheel, start, 20'000'010) == 1);
+    REQUIRE(late.m_Expired);
+    REQUIRE(wheel.next_expiry() == 20'000'011);
+
+    wheel.clear();
+
+    REQUIRE(partial.m_Discarded);
+    REQUIRE(!partial.m_Expired);
+    REQUIRE(wheel.empty());
+}
+
+TEST_CASE("test_job_timer[after]") {
+    using namespace std::chrono_literals;
+    using testing::TimerWheel;
+
+    bop::job::JobSystem pool(2);
+
+    std::mutex            lock;
+    std::vector<int>      order;
+    std::atomic<uint32_t> done = 0;
+
+    auto start = TimerWheel::Clock::now();
+
+    TimerWheel::Duration elapsed[3];
+
+    for (int i : { 2, 0, 1 })
+        pool.schedule_after(5ms + i * 20ms, [&, i] {
+            elapsed[i] = TimerWheel::Clock::now() - start;
+
+            {
+                std::scoped_lock guard(lock);
+                order.push_back(i);
+            }
+
+            ++done;
+        });
+
+    REQUIRE(testing::wait_until_true([&] { return done == 3; }));
+
+    REQUIRE(order == std::vector<int>{ 0, 1, 2 });
+
+    for (int i = 0; i < 3; ++i)
+        REQUIRE(elapsed[i] >= 5ms + i * 20ms);
+
+    // the pool is destroyed with a delayed job still pending (which is released without running)
+    bool ran = false;
+
+    pool.schedule_after(1h, [&] { ran = true; });
+
+    REQUIRE(!ran);
+}
+
+TEST_CASE("test_job_timer[every]") {
+    using namespace std::chrono_literals;
+
+    std::atomic<int> stopping = 0;
+    std::atomic<int> forever  = 0;
+
+    {
+        bop::job::JobSystem pool(2);
+
+        // stops itself after five runs
+        pool.schedule_every(2ms, [&] { return ++stopping < 5; });
+
+        // runs until the pool is destroyed
+        pool.schedule_every(1ms, [&] { ++forever; });
+
+        REQUIRE(testing::wait_until_true([&] { return (stopping == 5) && (forever >= 10); }));
+
+        std::this_thread::sleep_for(20ms);
+
+        REQUIRE(stopping == 5);
+    }
+
+    int final_count = forever;
+
+    std::this_thread::sleep_for(5ms);
+
+    REQUIRE(forever == final_count);
+}
+
+TEST_CASE("test_job_timer[sleep_for]") {
+    using namespace std::chrono_literals;
+
+    // the sleepers don't occupy the only worker, which is waiting for them meanwhile
+    for (uint32_t num_threads : { 1u, 4u }) {
+        bop::job::JobSystem pool(num_threads);
+
+        std::atomic<int> on_time = -1;
+
+        pool.schedule([&] { on_time = testing::sleep_many(100).get(); });
+
+        REQUIRE(testing::wait_until_true([&] { return on_time >= 0; }));
+        REQUIRE(on_time == 100);
+
+        // a single sleeper on an otherwise idle pool (only the watching worker wakes up for it)
+        std::atomic<int64_t> elapsed_us = -1;
+
+        pool.schedule([&] {
+            elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(testing::timed_sleep(30ms).get()).count();
+        });
+
+        REQUIRE(testing::wait_until_true([&] { return elapsed_us >= 0; }));
+        REQUIRE(elapsed_us >= 30'000);
+    }
+}
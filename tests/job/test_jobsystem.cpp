@@ -1,20 +1,19 @@
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <optional>
+#include <stdexcept>
 
 #include "../../src/job/job_system.h"
 
 #include <catch2/catch.hpp>
 
 namespace testing {
-    // because of the statics and one-time initialization, we're kind of limited
-    // in setup/teardown of the scheduler. Hence, we only have a single file
-    // with a single scheduler configuration that is tested.
-    //
-    // We could possibly adress that, but it would mean getting rid of all static
-    // variables in the scheduler, and re-expressing shared queue access between 
-    // worker threads by going via some kind of parent object. 
-    // 
-    // It's probably going to be trickier than the current setup.
+    // these all go through the bop:: convenience functions, so they use the default
+    // pool (see test_job_pools.cpp for explicitly constructed pools)
 
     std::atomic<uint32_t> g_Total;
 
@@ -42,9 +41,176 @@ namespace testing {
 
         return g_Total;
     }
+
+    uint32_t test_batch(uint32_t num_jobs) {
+        g_Total = 0;
+
+        std::atomic<bool> go = false;
+
+        // keep the parent busy until the entire batch was submitted
+        auto& parent = bop::schedule([&] {
+            while (!go)
+                std::this_thread::yield();
+        });
+
+        std::vector<std::function<void()>> batch(num_jobs, [] { ++g_Total; });
+
+        uint32_t num_scheduled = bop::schedule_batch(batch, &parent);
+
+        go = true;
+        parent.wait(); // waits for the children as well
+
+        return (num_scheduled == num_jobs) ? 
+            g_Total.load() : 
+            0;
+    }
+
+    // every index should be visited exactly once
+    bool test_parallel_for(
+        uint32_t                num_items, 
+        std::optional<uint32_t> grain_size = std::nullopt
+    ) {
+        std::vector<std::atomic<uint32_t>> visited(num_items);
+
+        bop::parallel_for(
+            0u, 
+            num_items, 
+            [&](uint32_t i) { ++visited[i]; },
+            grain_size
+        );
+
+        for (const auto& x : visited)
+            if (x != 1)
+                return false;
+
+        return true;
+    }
+
+    // parallel_for from within a job (so from a worker thread), with nested loops
+    uint64_t test_nested_parallel_for(uint32_t outer, uint32_t inner) {
+        std::atomic<uint64_t> sum = 0;
+
+        auto& job = bop::schedule([&] {
+            bop::parallel_for(0u, outer, [&](uint32_t) {
+                bop::parallel_for(0u, inner, [&](uint32_t j) { 
+                    sum += j; 
+                });
+            });
+        });
+
+        job.wait();
+
+        return sum;
+    }
+
+    // the full range of a narrow type, split across many workers (on the calling thread, not a worker)
+    template <typename I>
+    bool test_narrow_parallel_for(bop::job::JobSystem& pool) {
+        constexpr I k_First = std::numeric_limits<I>::min();
+        constexpr I k_Last  = std::numeric_limits<I>::max();
+
+        std::vector<std::atomic<uint32_t>> visited(static_cast<size_t>(k_Last - k_First));
+
+        pool.parallel_for(k_First, k_Last, [&](I i) { ++visited[static_cast<size_t>(i - k_First)]; });
+
+        for (const auto& x : visited)
+            if (x != 1)
+                return false;
+
+        return true;
+    }
+
+    void wait_for_total(uint32_t expected) {
+        while (g_Total < expected)
+            std::this_thread::yield();
+    }
 }
 
 TEST_CASE("test_scheduler[single_job]") {
     REQUIRE(testing::test_single_job() == 2222);
     REQUIRE(testing::test_basic_continuation() == 4444);
-}
\ No newline at end of file
+}
+
+TEST_CASE("test_scheduler[batch]") {
+    REQUIRE(testing::test_batch(1)   == 1);
+    REQUIRE(testing::test_batch(500) == 500);
+}
+
+TEST_CASE("test_scheduler[parallel_for]") {
+    REQUIRE(testing::test_parallel_for(0));
+    REQUIRE(testing::test_parallel_for(1));
+    REQUIRE(testing::test_parallel_for(10'000));
+    REQUIRE(testing::test_parallel_for(10'000, 1));      // finest possible grain
+    REQUIRE(testing::test_parallel_for(10'000, 50'000)); // a single chunk
+
+    REQUIRE(testing::test_nested_parallel_for(64, 100) == 64 * (100 * 99 / 2));
+
+    // (the default grain size is derived from the number of workers, which exceeds these types)
+    {
+        bop::job::JobSystem pool(16);
+
+        REQUIRE(testing::test_narrow_parallel_for<uint8_t>(pool));
+        REQUIRE(testing::test_narrow_parallel_for<int8_t>(pool));
+        REQUIRE(testing::test_narrow_parallel_for<int16_t>(pool));
+    }
+
+    // the first exception is rethrown on the calling thread, after all chunks are done
+    REQUIRE_THROWS_AS(
+        bop::parallel_for(0, 1000, [](int i) {
+            if (i == 500)
+                throw std::runtime_error("boom");
+        }),
+        std::runtime_error
+    );
+}
+
+TEST_CASE("test_scheduler[batch_throughput]", "[.benchmark]") {
+    constexpr uint32_t k_NumJobs = 1000;
+
+    auto work = [] { ++testing::g_Total; };
+
+    BENCHMARK("schedule() per job") {
+        testing::g_Total = 0;
+
+        for (uint32_t i = 0; i < k_NumJobs; ++i)
+            bop::schedule(work);
+
+        testing::wait_for_total(k_NumJobs);
+    };
+
+    BENCHMARK("schedule_batch()") {
+        testing::g_Total = 0;
+
+        bop::schedule_batch(std::views::iota(0u, k_NumJobs) | std::views::transform([&](uint32_t) { return work; }));
+
+        testing::wait_for_total(k_NumJobs);
+    };
+}
+
+TEST_CASE("test_scheduler[parallel_for_throughput]", "[.benchmark]") {
+    constexpr uint32_t k_NumItems = 100'000;
+
+    std::vector<float> data(k_NumItems, 1.0f);
+
+    auto work = [&](uint32_t i) { data[i] = data[i] * 0.5f + 1.0f; };
+
+    BENCHMARK("schedule() per element") {
+        testing::g_Total = 0;
+
+        for (uint32_t i = 0; i < k_NumItems; ++i)
+            bop::schedule([&, i] { 
+                work(i); 
+                ++testing::g_Total; 
+            });
+
+        testing::wait_for_total(k_NumItems);
+    };
+
+    BENCHMARK("parallel_for()") {
+        bop::parallel_for(0u, k_NumItems, work);
+    };
+
+    BENCHMARK("parallel_for(), grain size 1") {
+        bop::parallel_for(0u, k_NumItems, work, 1u);
+    };
+}
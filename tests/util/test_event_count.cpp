@@ -0,0 +1,127 @@
+#include "../../src/util/event_count.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+	// consumers park until the shared counter has something for them
+	uint32_t event_count_consume(
+		uint32_t num_consumers,
+		uint32_t num_items
+	) {
+		bop::util::EventCount event;
+
+		std::atomic<uint32_t> available = 0;
+		std::atomic<uint32_t> consumed  = 0;
+		std::atomic<bool>     done      = false;
+
+		auto try_take = [&] {
+			uint32_t x = available.load();
+
+			while (x > 0)
+				if (available.compare_exchange_weak(x, x - 1))
+					return true;
+
+			return false;
+		};
+
+		std::vector<std::thread> consumers;
+
+		for (uint32_t i = 0; i < num_consumers; ++i)
+			consumers.emplace_back([&] {
+				while (true) {
+					if (try_take()) {
+						++consumed;
+						continue;
+					}
+
+					if (done)
+						return;
+
+					// a lost wakeup would leave items behind and hang the test
+					auto key = event.prepare_wait();
+
+					if (done || (available > 0))
+						event.cancel_wait();
+					else
+						event.wait(key);
+				}
+			});
+
+		for (uint32_t i = 0; i < num_items; ++i) {
+			++available;
+			event.notify_one();
+		}
+
+		while (consumed < num_items)
+			std::this_thread::yield();
+
+		done = true;
+		event.notify_all();
+
+		for (auto& t : consumers)
+			t.join();
+
+		return consumed;
+	}
+}
+
+TEST_CASE("test_event_count[basic]") {
+	bop::util::EventCount event;
+
+	// notifying without waiters is fine
+	event.notify_one();
+	event.notify_all();
+	REQUIRE(event.get_num_waiters() == 0);
+
+	// a notification between prepare and wait is not lost
+	auto key = event.prepare_wait();
+	REQUIRE(event.get_num_waiters() == 1);
+
+	std::thread([&] { event.notify_one(); }).join();
+
+	event.wait(key); // returns right away
+	REQUIRE(event.get_num_waiters() == 0);
+
+	// cancelling
+	event.prepare_wait();
+	event.cancel_wait();
+	REQUIRE(event.get_num_waiters() == 0);
+}
+
+TEST_CASE("test_event_count[timeout]") {
+	using namespace std::chrono_literals;
+	using Clock = std::chrono::steady_clock;
+
+	bop::util::EventCount event;
+
+	// nobody notifies
+	auto start = Clock::now();
+	auto key   = event.prepare_wait();
+
+	REQUIRE(!event.wait_until(key, start + 10ms));
+	REQUIRE(Clock::now() - start >= 10ms);
+	REQUIRE(event.get_num_waiters() == 0);
+
+	// notified well before the deadline
+	key = event.prepare_wait();
+
+	std::thread notifier([&] {
+		std::this_thread::sleep_for(5ms);
+		event.notify_one();
+	});
+
+	REQUIRE(event.wait_until(key, Clock::now() + 10s));
+	REQUIRE(event.get_num_waiters() == 0);
+
+	notifier.join();
+}
+
+TEST_CASE("test_event_count[stress]") {
+	REQUIRE(testing::event_count_consume(1, 10'000) == 10'000);
+	REQUIRE(testing::event_count_consume(4, 10'000) == 10'000);
+}
@@ -0,0 +1,102 @@
+#include "../../src/util/inline_function.h"
+
+#include <array>
+#include <memory>
+#include <memory_resource>
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+	// forwards to new/delete, keeping track of what is outstanding
+	class TrackingResource:
+		public std::pmr::memory_resource
+	{
+	public:
+		uint32_t m_NumAllocations   = 0;
+		uint32_t m_NumOutstanding   = 0;
+		size_t   m_LastSize         = 0;
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override {
+			++m_NumAllocations;
+			++m_NumOutstanding;
+			m_LastSize = bytes;
+
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+			--m_NumOutstanding;
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+			return this == &other;
+		}
+	};
+}
+
+TEST_CASE("test_inline_function[inline]") {
+	using Fn = bop::util::InlineFunction<int(int)>;
+
+	static_assert(sizeof(Fn) == 64);
+
+	testing::TrackingResource resource;
+
+	int  offset = 3;
+	Fn   fn([offset](int x) { return x + offset; }, &resource);
+
+	REQUIRE(fn);
+	REQUIRE(fn(4) == 7);
+	REQUIRE(resource.m_NumAllocations == 0);
+
+	// move-only captures are fine
+	Fn owner([p = std::make_unique<int>(5)](int x) { return x * *p; });
+
+	REQUIRE(owner(2) == 10);
+
+	Fn moved = std::move(owner);
+
+	REQUIRE(!owner);
+	REQUIRE(moved(3) == 15);
+
+	moved = nullptr;
+	REQUIRE(!moved);
+	REQUIRE_THROWS(moved(1));
+}
+
+TEST_CASE("test_inline_function[spill]") {
+	using Fn = bop::util::InlineFunction<int()>;
+
+	std::array<int, 64> big;
+	big.fill(1);
+
+	auto sum = [big] {
+		int result = 0;
+
+		for (int x : big)
+			result += x;
+
+		return result;
+	};
+
+	static_assert(!Fn::fits_inline<decltype(sum)>());
+
+	testing::TrackingResource resource;
+
+	{
+		Fn fn(sum, &resource);
+
+		REQUIRE(fn() == 64);
+		REQUIRE(resource.m_NumAllocations == 1);
+		REQUIRE(resource.m_LastSize       == 256); // rounded up to a power of two
+
+		// moving only moves the pointer
+		Fn moved = std::move(fn);
+
+		REQUIRE(moved() == 64);
+		REQUIRE(resource.m_NumAllocations == 1);
+	}
+
+	REQUIRE(resource.m_NumOutstanding == 0);
+}
@@ -0,0 +1,92 @@
+#include "../../src/util/mpmc_ring.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+	// every producer pushes [0, num_items), consumers sum whatever they pop
+	uint64_t mpmc_sum(
+		uint32_t num_producers,
+		uint32_t num_consumers,
+		uint32_t num_items
+	) {
+		bop::util::MpmcRing<uint32_t> ring(64);
+
+		std::atomic<uint64_t> sum       = 0;
+		std::atomic<uint32_t> remaining = num_producers * num_items;
+
+		std::vector<std::thread> threads;
+
+		for (uint32_t i = 0; i < num_producers; ++i)
+			threads.emplace_back([&] {
+				for (uint32_t x = 0; x < num_items; ++x)
+					while (!ring.try_push(x))
+						std::this_thread::yield(); // full
+			});
+
+		for (uint32_t i = 0; i < num_consumers; ++i)
+			threads.emplace_back([&] {
+				uint32_t x;
+
+				while (remaining > 0)
+					if (ring.try_pop(x)) {
+						sum += x;
+						remaining.fetch_sub(1);
+					}
+					else
+						std::this_thread::yield();
+			});
+
+		for (auto& t : threads)
+			t.join();
+
+		return sum;
+	}
+}
+
+TEST_CASE("test_mpmc_ring[bounded]") {
+	bop::util::MpmcRing<int> ring(5); // rounded up to 8
+
+	REQUIRE(ring.capacity() == 8);
+	REQUIRE(ring.empty());
+
+	for (int i = 0; i < 8; ++i)
+		REQUIRE(ring.try_push(i));
+
+	REQUIRE(!ring.try_push(8)); // full is reported, not grown
+	REQUIRE(ring.size() == 8);
+
+	int x = -1;
+	for (int i = 0; i < 8; ++i) {
+		REQUIRE(ring.try_pop(x));
+		REQUIRE(x == i); // FIFO
+	}
+
+	REQUIRE(!ring.try_pop(x));
+	REQUIRE(ring.empty());
+}
+
+TEST_CASE("test_mpmc_ring[non_trivial]") {
+	bop::util::MpmcRing<std::string> ring(4);
+
+	REQUIRE(ring.try_push(std::string("hello")));
+	REQUIRE(ring.try_push("world"));
+
+	std::string s;
+	REQUIRE(ring.try_pop(s));
+	REQUIRE(s == "hello");
+
+	// the remaining entry is cleaned up by the destructor
+}
+
+TEST_CASE("test_mpmc_ring[stress]") {
+	constexpr uint32_t k_NumItems = 20'000;
+	constexpr uint64_t k_Expected = uint64_t(k_NumItems) * (k_NumItems - 1) / 2;
+
+	REQUIRE(testing::mpmc_sum(1, 1, k_NumItems) == k_Expected);
+	REQUIRE(testing::mpmc_sum(4, 4, k_NumItems) == 4 * k_Expected);
+}
@@ -0,0 +1,85 @@
+#include "../../src/util/spsc_ring.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("test_spsc_ring[bounded]") {
+	bop::util::SpscRing<int> ring(5); // exact, unlike MpmcRing
+
+	REQUIRE(ring.capacity() == 5);
+	REQUIRE(ring.empty());
+
+	// go around a few times, so the positions wrap over the (8) slots
+	for (int lap = 0; lap < 3; ++lap) {
+		for (int i = 0; i < 5; ++i)
+			REQUIRE(ring.try_push(i));
+
+		REQUIRE(!ring.try_push(5));
+		REQUIRE(ring.full());
+		REQUIRE(ring.size() == 5);
+
+		int x = -1;
+		for (int i = 0; i < 5; ++i) {
+			REQUIRE(ring.try_pop(x));
+			REQUIRE(x == i); // FIFO
+		}
+
+		REQUIRE(!ring.try_pop(x));
+		REQUIRE(ring.front() == nullptr);
+		REQUIRE(ring.empty());
+	}
+}
+
+TEST_CASE("test_spsc_ring[move_only]") {
+	bop::util::SpscRing<std::unique_ptr<std::string>> ring(2);
+
+	auto value = std::make_unique<std::string>("hello");
+
+	REQUIRE(ring.try_push(std::move(value)));
+	REQUIRE(ring.try_push(std::make_unique<std::string>("world")));
+
+	// a failed push leaves the value alone
+	auto extra = std::make_unique<std::string>("extra");
+	REQUIRE(!ring.try_push(std::move(extra)));
+	REQUIRE(extra);
+
+	REQUIRE(ring.front() != nullptr);
+	REQUIRE(**ring.front() == "hello");
+	ring.pop();
+
+	// the remaining entry is cleaned up by the destructor
+}
+
+TEST_CASE("test_spsc_ring[stress]") {
+	constexpr uint32_t k_NumItems = 100'000;
+
+	bop::util::SpscRing<uint32_t> ring(16);
+
+	std::thread producer([&] {
+		for (uint32_t x = 0; x < k_NumItems; ++x)
+			while (!ring.try_push(x))
+				std::this_thread::yield(); // full
+	});
+
+	// every item arrives exactly once, in order
+	uint32_t expected = 0;
+	bool     in_order = true;
+
+	while (expected < k_NumItems) {
+		if (uint32_t* x = ring.front()) {
+			in_order = in_order && (*x == expected);
+			ring.pop();
+			++expected;
+		}
+		else
+			std::this_thread::yield();
+	}
+
+	producer.join();
+
+	REQUIRE(in_order);
+	REQUIRE(ring.empty());
+}
@@ -0,0 +1,104 @@
+#include "../../src/util/topology.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace testing {
+	namespace fs = std::filesystem;
+
+	void write_file(const fs::path& p, const std::string& content) {
+		fs::create_directories(p.parent_path());
+		std::ofstream(p) << content << "\n";
+	}
+
+	// 2 packages (also numa nodes) with 2 cores each, 2 SMT threads per core and a shared L3 per package
+	// numbered like linux does; cpu 0-3 are the first threads of every core, cpu 4-7 their siblings
+	fs::path make_fake_sysfs() {
+		fs::path root = fs::temp_directory_path() / "bop_test_topology";
+		fs::remove_all(root);
+
+		write_file(root / "cpu" / "online", "0-7");
+
+		for (uint32_t cpu = 0; cpu < 8; ++cpu) {
+			uint32_t package = (cpu % 4) / 2;
+			uint32_t core    = cpu % 2;
+
+			fs::path dir = root / "cpu" / ("cpu" + std::to_string(cpu));
+
+			write_file(dir / "topology" / "physical_package_id", std::to_string(package));
+			write_file(dir / "topology" / "core_id",             std::to_string(core));
+
+			// L1 instruction + data, shared by the SMT siblings
+			std::string siblings = std::to_string(cpu % 4) + "," + std::to_string(cpu % 4 + 4);
+
+			write_file(dir / "cache" / "index0" / "level",           "1");
+			write_file(dir / "cache" / "index0" / "type",            "Data");
+			write_file(dir / "cache" / "index0" / "shared_cpu_list", siblings);
+			write_file(dir / "cache" / "index1" / "level",           "1");
+			write_file(dir / "cache" / "index1" / "type",            "Instruction");
+			write_file(dir / "cache" / "index1" / "shared_cpu_list", siblings);
+
+			write_file(dir / "cache" / "index3" / "level",           "3");
+			write_file(dir / "cache" / "index3" / "type",            "Unified");
+			write_file(dir / "cache" / "index3" / "shared_cpu_list", package == 0 ? "0-1,4-5" : "2-3,6-7");
+		}
+
+		write_file(root / "node" / "node0" / "cpulist", "0-1,4-5");
+		write_file(root / "node" / "node1" / "cpulist", "2-3,6-7");
+
+		return root;
+	}
+}
+
+TEST_CASE("test_topology[cpu_list]") {
+	using bop::util::parse_cpu_list;
+	using list = std::vector<uint32_t>;
+
+	REQUIRE(parse_cpu_list("0")              == list{ 0 });
+	REQUIRE(parse_cpu_list("0-3,8,10-11\n")  == list{ 0, 1, 2, 3, 8, 10, 11 });
+	REQUIRE(parse_cpu_list("")               == list{});
+	REQUIRE(parse_cpu_list("garbage,2")      == list{ 2 });
+}
+
+TEST_CASE("test_topology[sysfs]") {
+	using list = std::vector<uint32_t>;
+
+	auto root     = testing::make_fake_sysfs();
+	auto topology = bop::util::CpuTopology::detect(root);
+
+	REQUIRE(topology.get_num_cpus()         == 8);
+	REQUIRE(topology.get_num_cores()        == 4);
+	REQUIRE(topology.get_num_packages()     == 2);
+	REQUIRE(topology.get_num_cache_groups() == 2);
+	REQUIRE(topology.get_num_numa_nodes()   == 2);
+
+	REQUIRE(topology.get_smt_siblings(0) == list{ 0, 4 });
+	REQUIRE(topology.get_smt_siblings(7) == list{ 3, 7 });
+
+	REQUIRE(topology.compact_order()       == list{ 0, 4, 1, 5, 2, 6, 3, 7 });
+	REQUIRE(topology.scatter_order()       == list{ 0, 2, 1, 3, 4, 6, 5, 7 });
+	REQUIRE(topology.physical_core_order() == list{ 0, 1, 2, 3 });
+
+	std::filesystem::remove_all(root);
+}
+
+TEST_CASE("test_topology[fallback]") {
+	// without sysfs every logical processor is a separate core
+	auto topology = bop::util::CpuTopology::detect("this/path/does/not/exist");
+
+	REQUIRE(topology.get_num_cpus() >= 1);
+	REQUIRE(topology.get_num_cores() == topology.get_num_cpus());
+	REQUIRE(topology.get_num_cache_groups() == 1);
+	REQUIRE(topology.physical_core_order() == topology.compact_order());
+
+	// the actual machine should at least be consistent
+	auto actual = bop::util::CpuTopology::detect();
+
+	REQUIRE(actual.get_num_cpus() >= actual.get_num_cores());
+	REQUIRE(actual.compact_order().size() == actual.get_num_cpus());
+	REQUIRE(actual.scatter_order().size() == actual.get_num_cpus());
+}